@@ -1,14 +1,36 @@
 #include "SGCinematicsSubsystem.h"
+#include "SGNarrativeDatabase.h"
 #include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
+
+#include "UObject/StrongObjectPtr.h"
 
 void USGCinematicsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
-	Reload();
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (Settings && Settings->bLoadAsync)
+	{
+		ReloadAsync();
+	}
+	else
+	{
+		Reload();
+	}
 }
 
 void USGCinematicsSubsystem::Reload()
 {
+	++LoadRequest;
+	bReady = false;
+
+	if (UseDatabase())
+	{
+		FinishLoad();
+		return;
+	}
+
 	ShotlistTable = nullptr;
 	ShotsByScene.Reset();
 
@@ -19,6 +41,98 @@ void USGCinematicsSubsystem::Reload()
 	}
 
 	BuildIndex();
+	FinishLoad();
+}
+
+void USGCinematicsSubsystem::ReloadAsync()
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		Reload();
+		return;
+	}
+
+	const uint32 Request = ++LoadRequest;
+	bReady = false;
+	if (UseDatabase())
+	{
+		// Nothing to index: the database is read in place.
+		FinishLoad();
+		return;
+	}
+
+	TWeakObjectPtr<USGCinematicsSubsystem> WeakThis(this);
+
+	FSGNarrativeAsync::LoadTable(Settings->CinematicsShotlistTable, [WeakThis, Request](UDataTable* Table)
+	{
+		if (!WeakThis.IsValid() || WeakThis->LoadRequest != Request)
+		{
+			return;
+		}
+
+		// Rows are copied on the game thread: the table can be edited or reimported while the worker indexes.
+		TArray<FSGCinematicShotRow> RowCopies = FSGNarrativeAsync::CopyRows<FSGCinematicShotRow>(Table, TEXT("USGCinematicsSubsystem::ReloadAsync"));
+
+		TSharedRef<TMap<FString, TArray<FSGCinematicShotRow>>> Shots = MakeShared<TMap<FString, TArray<FSGCinematicShotRow>>>();
+		TStrongObjectPtr<UDataTable> Pinned(Table);
+
+		FSGNarrativeAsync::Run(
+			[Shots, RowCopies = MoveTemp(RowCopies)]() mutable
+			{
+				BuildIndexFromRows(MoveTemp(RowCopies), *Shots);
+			},
+			[WeakThis, Request, Shots, Pinned = MoveTemp(Pinned)]()
+			{
+				USGCinematicsSubsystem* This = WeakThis.Get();
+				if (!This || This->LoadRequest != Request)
+				{
+					return;
+				}
+
+				This->ShotlistTable = Pinned.Get();
+				This->ShotsByScene = MoveTemp(*Shots);
+				This->FinishLoad();
+			});
+	});
+}
+
+bool USGCinematicsSubsystem::UseDatabase()
+{
+	Database = FSGNarrativeDatabase::GetProjectDatabase();
+	if (!Database.IsValid() || !Database->GetTable(ESGNarrativeDbSection::CinematicShotTable).IsValid())
+	{
+		Database.Reset();
+		return false;
+	}
+
+	ShotlistTable = nullptr;
+	ShotsByScene.Reset();
+	return true;
+}
+
+void USGCinematicsSubsystem::ReloadFromTable(UDataTable* Table)
+{
+	++LoadRequest;
+	bReady = false;
+
+	Database.Reset();
+	ShotlistTable = Table;
+	BuildIndex();
+	FinishLoad();
+}
+
+void USGCinematicsSubsystem::FinishLoad()
+{
+	SIZE_T IndexSize = ShotsByScene.GetAllocatedSize();
+	for (const auto& Pair : ShotsByScene)
+	{
+		IndexSize += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+	}
+	SET_MEMORY_STAT(STAT_SGNarrative_CinematicsIndexMemory, IndexSize);
+
+	bReady = true;
+	OnReady.Broadcast();
 }
 
 void USGCinematicsSubsystem::BuildIndex()
@@ -30,21 +144,21 @@ void USGCinematicsSubsystem::BuildIndex()
 		return;
 	}
 
-	static const FString Context = TEXT("USGCinematicsSubsystem::BuildIndex");
-	TArray<FSGCinematicShotRow*> AllRows;
-	ShotlistTable->GetAllRows(Context, AllRows);
+	BuildIndexFromRows(FSGNarrativeAsync::CopyRows<FSGCinematicShotRow>(ShotlistTable, TEXT("USGCinematicsSubsystem::BuildIndex")), ShotsByScene);
+}
 
-	for (const FSGCinematicShotRow* Row : AllRows)
-	{
-		if (!Row) continue;
+void USGCinematicsSubsystem::BuildIndexFromRows(TArray<FSGCinematicShotRow>&& AllRows, TMap<FString, TArray<FSGCinematicShotRow>>& OutShots)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
 
-		const FString Key = Row->questline + TEXT("|") + Row->scene_id;
-		TArray<FSGCinematicShotRow>& Bucket = ShotsByScene.FindOrAdd(Key);
-		Bucket.Add(*Row);
+	for (FSGCinematicShotRow& Row : AllRows)
+	{
+		TArray<FSGCinematicShotRow>& Bucket = OutShots.FindOrAdd(MakeSceneKey(Row.questline, Row.scene_id));
+		Bucket.Add(MoveTemp(Row));
 	}
 
 	// Sort shots by shot number per scene.
-	for (auto& Pair : ShotsByScene)
+	for (auto& Pair : OutShots)
 	{
 		Pair.Value.Sort([](const FSGCinematicShotRow& A, const FSGCinematicShotRow& B)
 		{
@@ -55,9 +169,24 @@ void USGCinematicsSubsystem::BuildIndex()
 
 bool USGCinematicsSubsystem::GetShotsForScene(const FString& Questline, const FString& SceneId, TArray<FSGCinematicShotRow>& OutShots) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_CinematicsLookup);
+
 	OutShots.Reset();
 
-	const FString Key = Questline + TEXT("|") + SceneId;
+	const FString Key = MakeSceneKey(Questline, SceneId);
+
+	if (Database.IsValid())
+	{
+		const FSGNarrativeDbTable& Shots = Database->GetTable(ESGNarrativeDbSection::CinematicShotTable);
+		const FSGRowRange Range = Shots.Find(FStringView(Key));
+		OutShots.SetNum(Range.Num);
+		for (int32 Idx = 0; Idx < Range.Num; ++Idx)
+		{
+			Shots.ReadRow(Range.Start + Idx, OutShots[Idx]);
+		}
+		return OutShots.Num() > 0;
+	}
+
 	if (const TArray<FSGCinematicShotRow>* Found = ShotsByScene.Find(Key))
 	{
 		OutShots = *Found;
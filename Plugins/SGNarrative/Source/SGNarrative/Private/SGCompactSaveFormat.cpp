@@ -0,0 +1,409 @@
+#include "SGCompactSaveFormat.h"
+#include "SGNarrativeLog.h"
+
+#include "Serialization/CustomVersion.h"
+
+const FGuid FSGSaveGameVersion::GUID(0x5C3A91E2, 0x4B7D4F08, 0x9E61A2D3, 0x17F04C85);
+
+static FCustomVersionRegistration GRegisterSGSaveGameVersion(FSGSaveGameVersion::GUID, FSGSaveGameVersion::LatestVersion, TEXT("SGSaveGameVer"));
+
+namespace
+{
+	uint32 ZigZag(int32 Value)
+	{
+		return ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	}
+
+	int32 UnZigZag(uint32 Value)
+	{
+		return (int32)(Value >> 1) ^ -(int32)(Value & 1);
+	}
+
+	/** Sorted, de-duplicated names of one save; a name is written as its index + 1 (0 == None). */
+	struct FSymbolTable
+	{
+		TArray<FName> Names;
+		TMap<FName, int32> Indices;
+
+		void Add(FName Name)
+		{
+			if (!Name.IsNone())
+			{
+				Names.Add(Name);
+			}
+		}
+
+		void Finish()
+		{
+			Names.Sort(FNameLexicalLess());
+			for (int32 Idx = Names.Num() - 1; Idx > 0; --Idx)
+			{
+				if (Names[Idx] == Names[Idx - 1])
+				{
+					Names.RemoveAt(Idx, EAllowShrinking::No);
+				}
+			}
+
+			Indices.Reserve(Names.Num());
+			for (int32 Idx = 0; Idx < Names.Num(); ++Idx)
+			{
+				Indices.Add(Names[Idx], Idx);
+			}
+		}
+
+		uint32 Find(FName Name) const
+		{
+			return Name.IsNone() ? 0u : (uint32)Indices.FindChecked(Name) + 1;
+		}
+	};
+
+	/** Read side: symbols plus bounds checking. */
+	struct FSymbolReader
+	{
+		FArchive& Ar;
+		TArray<FName> Names;
+
+		FName Read()
+		{
+			return Resolve(FSGCompactSaveFormat::ReadVarUInt(Ar));
+		}
+
+		FName Resolve(uint64 Symbol)
+		{
+			if (Symbol == 0)
+			{
+				return NAME_None;
+			}
+			if (Symbol > (uint64)Names.Num())
+			{
+				Ar.SetError();
+				return NAME_None;
+			}
+			return Names[(int32)Symbol - 1];
+		}
+	};
+
+	/** Element count, rejected if it cannot fit in what is left of the archive (one byte per element at least). */
+	bool ReadCount(FArchive& Ar, int32& OutCount)
+	{
+		const uint64 Count = FSGCompactSaveFormat::ReadVarUInt(Ar);
+		const int64 Remaining = Ar.TotalSize() > 0 ? Ar.TotalSize() - Ar.Tell() : MAX_int32;
+		if (Ar.IsError() || Count > (uint64)FMath::Max<int64>(Remaining, 0) || Count > (uint64)MAX_int32)
+		{
+			Ar.SetError();
+			OutCount = 0;
+			return false;
+		}
+
+		OutCount = (int32)Count;
+		return true;
+	}
+}
+
+void FSGCompactSaveFormat::WriteVarUInt(FArchive& Ar, uint64 Value)
+{
+	uint8 Bytes[10];
+	int32 Num = 0;
+	do
+	{
+		Bytes[Num] = (uint8)(Value & 0x7F);
+		Value >>= 7;
+		if (Value != 0)
+		{
+			Bytes[Num] |= 0x80;
+		}
+		++Num;
+	}
+	while (Value != 0);
+
+	Ar.Serialize(Bytes, Num);
+}
+
+uint64 FSGCompactSaveFormat::ReadVarUInt(FArchive& Ar)
+{
+	uint64 Value = 0;
+	for (int32 Shift = 0; Shift < 64; Shift += 7)
+	{
+		uint8 Byte = 0;
+		Ar.Serialize(&Byte, 1);
+		if (Ar.IsError())
+		{
+			return 0;
+		}
+
+		Value |= (uint64)(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			return Value;
+		}
+	}
+
+	// More than 10 bytes: not a varint we wrote.
+	Ar.SetError();
+	return 0;
+}
+
+void FSGCompactSaveFormat::WriteVarInt(FArchive& Ar, int32 Value)
+{
+	WriteVarUInt(Ar, ZigZag(Value));
+}
+
+int32 FSGCompactSaveFormat::ReadVarInt(FArchive& Ar)
+{
+	return UnZigZag((uint32)ReadVarUInt(Ar));
+}
+
+void FSGCompactSaveFormat::Write(FArchive& Ar, const FSGCompactSaveData& Data)
+{
+	check(Ar.IsSaving());
+
+	TArray<FName> Flags;
+	Data.StoryState->GetAllFlags(Flags);
+
+	TMap<FName, int32> Ints;
+	Data.StoryState->GetAllInts(Ints);
+
+	// 1) Symbol table: every name in the save, once.
+	FSymbolTable Symbols;
+	for (const FName& Flag : Flags)
+	{
+		Symbols.Add(Flag);
+	}
+	for (const TPair<FName, int32>& Pair : Ints)
+	{
+		Symbols.Add(Pair.Key);
+	}
+	for (const FSGStoryJournalEntry& Entry : Data.Journal->Entries)
+	{
+		Symbols.Add(Entry.RowId);
+		Symbols.Add(Entry.OptionKey);
+		for (const FName& Flag : Entry.FlagsAdded)
+		{
+			Symbols.Add(Flag);
+		}
+		for (const FSGStoryIntDelta& Delta : Entry.Ints)
+		{
+			Symbols.Add(Delta.Key);
+		}
+	}
+	for (const TPair<FName, FSGQuestProgress>& Pair : *Data.QuestProgress)
+	{
+		Symbols.Add(Pair.Key);
+		Symbols.Add(Pair.Value.quest_code);
+	}
+	Symbols.Add(*Data.CurrentDialogueId);
+	Symbols.Finish();
+
+	WriteVarUInt(Ar, Symbols.Names.Num());
+	for (const FName& Name : Symbols.Names)
+	{
+		const FTCHARToUTF8 Utf8(*Name.ToString());
+		WriteVarUInt(Ar, Utf8.Length());
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+
+	// 2) Story state: flags as gaps between sorted symbols, ints as (gap, value).
+	TArray<uint32> FlagSymbols;
+	FlagSymbols.Reserve(Flags.Num());
+	for (const FName& Flag : Flags)
+	{
+		FlagSymbols.Add(Symbols.Find(Flag));
+	}
+	FlagSymbols.Sort();
+
+	WriteVarUInt(Ar, FlagSymbols.Num());
+	uint32 Previous = 0;
+	for (const uint32 Symbol : FlagSymbols)
+	{
+		WriteVarUInt(Ar, Symbol - Previous);
+		Previous = Symbol;
+	}
+
+	TArray<TPair<uint32, int32>> IntSymbols;
+	IntSymbols.Reserve(Ints.Num());
+	for (const TPair<FName, int32>& Pair : Ints)
+	{
+		IntSymbols.Emplace(Symbols.Find(Pair.Key), Pair.Value);
+	}
+	IntSymbols.Sort([](const TPair<uint32, int32>& A, const TPair<uint32, int32>& B) { return A.Key < B.Key; });
+
+	WriteVarUInt(Ar, IntSymbols.Num());
+	Previous = 0;
+	for (const TPair<uint32, int32>& Pair : IntSymbols)
+	{
+		WriteVarUInt(Ar, Pair.Key - Previous);
+		WriteVarInt(Ar, Pair.Value);
+		Previous = Pair.Key;
+	}
+
+	// 3) Journal: int writes as (symbol << 1 | was set, old value, new - old).
+	WriteVarInt(Ar, Data.Journal->BasePosition);
+	WriteVarUInt(Ar, Data.Journal->Entries.Num());
+	for (const FSGStoryJournalEntry& Entry : Data.Journal->Entries)
+	{
+		WriteVarUInt(Ar, Symbols.Find(Entry.RowId));
+		WriteVarUInt(Ar, Symbols.Find(Entry.OptionKey));
+
+		WriteVarUInt(Ar, Entry.FlagsAdded.Num());
+		for (const FName& Flag : Entry.FlagsAdded)
+		{
+			WriteVarUInt(Ar, Symbols.Find(Flag));
+		}
+
+		WriteVarUInt(Ar, Entry.Ints.Num());
+		for (const FSGStoryIntDelta& Delta : Entry.Ints)
+		{
+			WriteVarUInt(Ar, ((uint64)Symbols.Find(Delta.Key) << 1) | (Delta.bWasSet ? 1 : 0));
+			WriteVarInt(Ar, Delta.OldValue);
+			WriteVarInt(Ar, (int32)((uint32)Delta.NewValue - (uint32)Delta.OldValue));
+		}
+	}
+
+	// 4) Quest progress by key; quest_code is almost always the key itself (written as 0).
+	TArray<TPair<uint32, const FSGQuestProgress*>> Quests;
+	Quests.Reserve(Data.QuestProgress->Num());
+	for (const TPair<FName, FSGQuestProgress>& Pair : *Data.QuestProgress)
+	{
+		Quests.Emplace(Symbols.Find(Pair.Key), &Pair.Value);
+	}
+	Quests.Sort([](const TPair<uint32, const FSGQuestProgress*>& A, const TPair<uint32, const FSGQuestProgress*>& B) { return A.Key < B.Key; });
+
+	WriteVarUInt(Ar, Quests.Num());
+	Previous = 0;
+	for (const TPair<uint32, const FSGQuestProgress*>& Pair : Quests)
+	{
+		const FSGQuestProgress& Progress = *Pair.Value;
+		const uint32 CodeSymbol = Symbols.Find(Progress.quest_code);
+
+		WriteVarUInt(Ar, Pair.Key - Previous);
+		WriteVarUInt(Ar, CodeSymbol == Pair.Key ? 0 : (uint64)CodeSymbol + 1);
+		WriteVarInt(Ar, Progress.branch_index);
+		WriteVarUInt(Ar, ((uint64)ZigZag(Progress.objective_index) << 1) | (Progress.bCompleted ? 1 : 0));
+		Previous = Pair.Key;
+	}
+
+	WriteVarUInt(Ar, Symbols.Find(*Data.CurrentDialogueId));
+}
+
+bool FSGCompactSaveFormat::Read(FArchive& Ar, const FSGCompactSaveData& Data)
+{
+	check(Ar.IsLoading());
+
+	// 1) Symbol table.
+	FSymbolReader Symbols{ Ar };
+	int32 NumSymbols = 0;
+	if (!ReadCount(Ar, NumSymbols))
+	{
+		return false;
+	}
+
+	Symbols.Names.Reserve(NumSymbols);
+	TArray<ANSICHAR> Utf8;
+	for (int32 Idx = 0; Idx < NumSymbols; ++Idx)
+	{
+		int32 Len = 0;
+		if (!ReadCount(Ar, Len))
+		{
+			return false;
+		}
+
+		Utf8.SetNumUninitialized(Len);
+		Ar.Serialize(Utf8.GetData(), Len);
+		Symbols.Names.Add(FName(FUTF8ToTCHAR(Utf8.GetData(), Len)));
+	}
+
+	// 2) Story state.
+	FSGStoryState& State = *Data.StoryState;
+	State = FSGStoryState();
+
+	int32 Num = 0;
+	ReadCount(Ar, Num);
+	uint64 Symbol = 0;
+	for (int32 Idx = 0; Idx < Num && !Ar.IsError(); ++Idx)
+	{
+		Symbol += ReadVarUInt(Ar);
+		State.AddFlag(Symbols.Resolve(Symbol));
+	}
+
+	ReadCount(Ar, Num);
+	Symbol = 0;
+	for (int32 Idx = 0; Idx < Num && !Ar.IsError(); ++Idx)
+	{
+		Symbol += ReadVarUInt(Ar);
+		const FName Key = Symbols.Resolve(Symbol);
+		State.SetInt(Key, ReadVarInt(Ar));
+	}
+
+	// Per-key changes mean nothing against a replaced state (as in FSGStoryState::Serialize).
+	State.Changes.Reset();
+	State.Changes.bAll = true;
+
+	// 3) Journal.
+	FSGStoryJournal& Journal = *Data.Journal;
+	Journal = FSGStoryJournal();
+	Journal.BasePosition = ReadVarInt(Ar);
+
+	ReadCount(Ar, Num);
+	Journal.Entries.SetNum(Num);
+	for (FSGStoryJournalEntry& Entry : Journal.Entries)
+	{
+		Entry.RowId = Symbols.Read();
+		Entry.OptionKey = Symbols.Read();
+
+		int32 NumFlags = 0;
+		ReadCount(Ar, NumFlags);
+		Entry.FlagsAdded.SetNum(NumFlags);
+		for (FName& Flag : Entry.FlagsAdded)
+		{
+			Flag = Symbols.Read();
+		}
+
+		int32 NumInts = 0;
+		ReadCount(Ar, NumInts);
+		Entry.Ints.SetNum(NumInts);
+		for (FSGStoryIntDelta& Delta : Entry.Ints)
+		{
+			const uint64 KeyAndSet = ReadVarUInt(Ar);
+			Delta.Key = Symbols.Resolve(KeyAndSet >> 1);
+			Delta.bWasSet = (KeyAndSet & 1) != 0;
+			Delta.OldValue = ReadVarInt(Ar);
+			Delta.NewValue = (int32)((uint32)Delta.OldValue + (uint32)ReadVarInt(Ar));
+		}
+
+		if (Ar.IsError())
+		{
+			break;
+		}
+	}
+
+	// 4) Quest progress.
+	TMap<FName, FSGQuestProgress>& Quests = *Data.QuestProgress;
+	Quests.Reset();
+
+	ReadCount(Ar, Num);
+	Quests.Reserve(Num);
+	Symbol = 0;
+	for (int32 Idx = 0; Idx < Num && !Ar.IsError(); ++Idx)
+	{
+		Symbol += ReadVarUInt(Ar);
+		const FName Key = Symbols.Resolve(Symbol);
+
+		FSGQuestProgress& Progress = Quests.Add(Key);
+		const uint64 Code = ReadVarUInt(Ar);
+		Progress.quest_code = Code == 0 ? Key : Symbols.Resolve(Code - 1);
+		Progress.branch_index = ReadVarInt(Ar);
+
+		const uint64 ObjectiveAndCompleted = ReadVarUInt(Ar);
+		Progress.objective_index = UnZigZag((uint32)(ObjectiveAndCompleted >> 1));
+		Progress.bCompleted = (ObjectiveAndCompleted & 1) != 0;
+	}
+
+	*Data.CurrentDialogueId = Symbols.Read();
+
+	if (Ar.IsError())
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("Compact save data is malformed; narrative state was not restored."));
+		return false;
+	}
+	return true;
+}
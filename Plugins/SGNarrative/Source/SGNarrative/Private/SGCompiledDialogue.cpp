@@ -0,0 +1,1321 @@
+#include "SGCompiledDialogue.h"
+#include "SGNarrativeDatabase.h"
+#include "SGStateKeyRegistry.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeStats.h"
+
+#include "Algo/BinarySearch.h"
+#include "Dom/JsonObject.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	FThreadSafeCounter GCompiledDialogueSerial;
+
+	bool SameText(const FString& Text, FSGNarrativeString Pooled)
+	{
+		return FStringView(Text).Equals(Pooled.View(), ESearchCase::CaseSensitive);
+	}
+
+	int32 ReadInt(const FSGStoryState& State, const FSGPredicateInstr& Instr)
+	{
+		return Instr.Slot != INDEX_NONE ? State.GetIntSlot(Instr.Slot) : State.GetInt(Instr.Key, 0);
+	}
+
+	/**
+	 * Effect target reads for the journal: by slot when compiled with one, so no registry lookup. The
+	 * name containers are probed only while non-empty (a key written before it was registered).
+	 */
+	bool HasEffectFlag(const FSGStoryState& State, const FSGEffectInstr& Instr)
+	{
+		if (Instr.Slot == INDEX_NONE)
+		{
+			return State.HasFlag(Instr.Key);
+		}
+		return State.HasFlagSlot(Instr.Slot) || (State.Flags.Num() > 0 && State.Flags.Contains(Instr.Key));
+	}
+
+	bool FindEffectInt(const FSGStoryState& State, const FSGEffectInstr& Instr, int32& OutValue)
+	{
+		if (Instr.Slot == INDEX_NONE)
+		{
+			return State.FindInt(Instr.Key, OutValue);
+		}
+
+		if (State.HasIntSlot(Instr.Slot))
+		{
+			OutValue = State.GetIntSlot(Instr.Slot);
+			return true;
+		}
+
+		const int32* Loose = State.Ints.Num() > 0 ? State.Ints.Find(Instr.Key) : nullptr;
+		if (Loose)
+		{
+			OutValue = *Loose;
+			return true;
+		}
+		return false;
+	}
+
+	/** Text fields shared by FSGDialogueDecisionRow and its pooled form. */
+	struct FPooledField
+	{
+		FString FSGDialogueDecisionRow::* Source;
+		FSGNarrativeString FSGDialogueRowData::* Pooled;
+	};
+
+	const FPooledField GPooledFields[] =
+	{
+		{ &FSGDialogueDecisionRow::quest, &FSGDialogueRowData::quest },
+		{ &FSGDialogueDecisionRow::hub, &FSGDialogueRowData::hub },
+		{ &FSGDialogueDecisionRow::type, &FSGDialogueRowData::type },
+		{ &FSGDialogueDecisionRow::speaker, &FSGDialogueRowData::speaker },
+		{ &FSGDialogueDecisionRow::title, &FSGDialogueRowData::title },
+		{ &FSGDialogueDecisionRow::emotion, &FSGDialogueRowData::emotion },
+		{ &FSGDialogueDecisionRow::anim, &FSGDialogueRowData::anim },
+		{ &FSGDialogueDecisionRow::line_or_prompt, &FSGDialogueRowData::line_or_prompt },
+		{ &FSGDialogueDecisionRow::option_key, &FSGDialogueRowData::option_key },
+		{ &FSGDialogueDecisionRow::option_text, &FSGDialogueRowData::option_text },
+		{ &FSGDialogueDecisionRow::checks, &FSGDialogueRowData::checks },
+		{ &FSGDialogueDecisionRow::conditions, &FSGDialogueRowData::conditions },
+		{ &FSGDialogueDecisionRow::set_flags, &FSGDialogueRowData::set_flags },
+		{ &FSGDialogueDecisionRow::grants, &FSGDialogueRowData::grants },
+	};
+}
+
+void FSGDialogueRowData::Intern(const FSGDialogueDecisionRow& Source)
+{
+	FSGNarrativeStringPool& Pool = FSGNarrativeStringPool::Get();
+
+	id = Source.id;
+	next = Source.next;
+	for (const FPooledField& Field : GPooledFields)
+	{
+		this->*Field.Pooled = Pool.Intern(Source.*Field.Source);
+	}
+}
+
+void FSGDialogueRowData::Materialize(FSGDialogueDecisionRow& Out) const
+{
+	const FSGNarrativeStringPool& Pool = FSGNarrativeStringPool::Get();
+
+	Out.id = id;
+	Out.next = next;
+	for (const FPooledField& Field : GPooledFields)
+	{
+		Out.*Field.Source = FString(Pool.Resolve(this->*Field.Pooled));
+	}
+}
+
+FSGCompiledDialogue::FSGCompiledDialogue()
+{
+	Reset();
+}
+
+void FSGCompiledDialogue::Reset()
+{
+	Rows.Reset();
+	Programs.Reset();
+	RowTypes.Reset();
+	RowNodes.Reset();
+	RowNextNodes.Reset();
+	NodeByName.Reset();
+	NodeIds.Reset();
+	NodeRows.Reset();
+	NodePrimarySlot.Reset();
+	NodeOptions.Reset();
+	OptionSlots.Reset();
+	FlagReaders.Reset();
+	IntReaders.Reset();
+	ReaderSlots.Reset();
+	for (TMap<FSGNarrativeString, FSGRowRange>& Index : FieldRows)
+	{
+		Index.Reset();
+	}
+	FieldSlots.Reset();
+	Diagnostics.Reset();
+	Predicates.Reset();
+	PredicatesByHash.Reset();
+	PredicateVersions.Reset();
+	PredicateResults.Reset();
+	Instrs.Reset();
+	Effects.Reset();
+	MaskWords.Reset();
+
+	// Serial 0 is reserved for "never compiled".
+	Serial = (uint32)GCompiledDialogueSerial.Increment();
+}
+
+SIZE_T FSGCompiledDialogue::GetAllocatedSize() const
+{
+	SIZE_T Size = 0;
+	Size += Rows.GetAllocatedSize();
+	Size += Programs.GetAllocatedSize();
+	Size += RowTypes.GetAllocatedSize();
+	Size += RowNodes.GetAllocatedSize();
+	Size += RowNextNodes.GetAllocatedSize();
+	Size += NodeByName.GetAllocatedSize();
+	Size += NodeIds.GetAllocatedSize();
+	Size += NodeRows.GetAllocatedSize();
+	Size += NodePrimarySlot.GetAllocatedSize();
+	Size += NodeOptions.GetAllocatedSize();
+	Size += OptionSlots.GetAllocatedSize();
+	Size += FlagReaders.GetAllocatedSize();
+	Size += IntReaders.GetAllocatedSize();
+	Size += ReaderSlots.GetAllocatedSize();
+	for (const TMap<FSGNarrativeString, FSGRowRange>& Index : FieldRows)
+	{
+		Size += Index.GetAllocatedSize();
+	}
+	Size += FieldSlots.GetAllocatedSize();
+	Size += Predicates.GetAllocatedSize();
+	Size += Instrs.GetAllocatedSize();
+	Size += Effects.GetAllocatedSize();
+	Size += MaskWords.GetAllocatedSize();
+	Size += PredicateVersions.GetAllocatedSize();
+	Size += PredicateResults.GetAllocatedSize();
+	return Size;
+}
+
+void FSGCompiledDialogue::Build(const TArray<FSGDialogueDecisionRow*>& SourceRows)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
+
+	Reset();
+
+	// Group by id first (TMap keeps first-seen order), then lay rows out contiguously.
+	TMap<FName, TArray<const FSGDialogueDecisionRow*>> Groups;
+	for (const FSGDialogueDecisionRow* Row : SourceRows)
+	{
+		if (Row)
+		{
+			Groups.FindOrAdd(Row->id).Add(Row);
+		}
+	}
+
+	Rows.Reserve(SourceRows.Num());
+	Programs.Reserve(SourceRows.Num());
+	RowTypes.Reserve(SourceRows.Num());
+	RowNodes.Reserve(SourceRows.Num());
+	NodeByName.Reserve(Groups.Num());
+	NodeIds.Reserve(Groups.Num());
+	NodeRows.Reserve(Groups.Num());
+
+	for (const auto& Pair : Groups)
+	{
+		const int32 Node = NodeIds.Add(Pair.Key);
+		NodeByName.Add(Pair.Key, Node);
+
+		FSGRowRange& Range = NodeRows.AddDefaulted_GetRef();
+		Range.Start = Rows.Num();
+		Range.Num = Pair.Value.Num();
+
+		for (const FSGDialogueDecisionRow* Row : Pair.Value)
+		{
+			Rows.AddDefaulted_GetRef().Intern(*Row);
+			RowTypes.Add(ParseRowType(Row->type));
+			RowNodes.Add(Node);
+			CompileRow(Rows.Num() - 1, *Row);
+		}
+	}
+
+	FinishBuild();
+}
+
+void FSGCompiledDialogue::FinishBuild()
+{
+	LinkGraph();
+	IndexReaders();
+	IndexFields();
+
+	PredicatesByHash.Empty();
+	PredicateVersions.SetNumZeroed(Predicates.Num());
+	PredicateResults.Init(false, Predicates.Num());
+
+	UE_LOG(LogSGNarrative, Verbose, TEXT("Dialogue compile: %d rows share %d distinct predicates."), Rows.Num(), Predicates.Num());
+}
+
+void FSGCompiledDialogue::LinkGraph()
+{
+	RowNextNodes.SetNumUninitialized(Rows.Num());
+	for (int32 Slot = 0; Slot < Rows.Num(); ++Slot)
+	{
+		const FName Next = Rows[Slot].next;
+		RowNextNodes[Slot] = Next.IsNone() ? INDEX_NONE : FindNode(Next);
+
+		if (!Next.IsNone() && RowNextNodes[Slot] == INDEX_NONE)
+		{
+			Diagnostics.Add(FString::Printf(TEXT("Row id=%s points to missing next=%s"),
+				*Rows[Slot].id.ToString(), *Next.ToString()));
+		}
+	}
+
+	NodePrimarySlot.SetNumUninitialized(NodeIds.Num());
+	NodeOptions.SetNum(NodeIds.Num());
+	OptionSlots.Reserve(Rows.Num());
+
+	for (int32 Node = 0; Node < NodeIds.Num(); ++Node)
+	{
+		const FSGRowRange& Range = NodeRows[Node];
+		bool bHasDecision = false;
+
+		NodePrimarySlot[Node] = INDEX_NONE;
+		NodeOptions[Node].Start = OptionSlots.Num();
+
+		for (int32 Slot = Range.Start; Slot < Range.Start + Range.Num; ++Slot)
+		{
+			const ESGDialogueRowType Type = RowTypes[Slot];
+			if (Type == ESGDialogueRowType::DecisionOption)
+			{
+				OptionSlots.Add(Slot);
+				continue;
+			}
+
+			bHasDecision |= (Type == ESGDialogueRowType::Decision);
+			if (NodePrimarySlot[Node] == INDEX_NONE)
+			{
+				NodePrimarySlot[Node] = Slot;
+			}
+		}
+
+		NodeOptions[Node].Num = OptionSlots.Num() - NodeOptions[Node].Start;
+
+		// Prefer a non-option row for the "node"; fall back to the first row.
+		if (NodePrimarySlot[Node] == INDEX_NONE)
+		{
+			NodePrimarySlot[Node] = Range.Start;
+		}
+
+		if (bHasDecision && NodeOptions[Node].Num == 0)
+		{
+			Diagnostics.Add(FString::Printf(TEXT("Decision id=%s has no DECISION_OPTION rows"), *NodeIds[Node].ToString()));
+		}
+	}
+
+	for (const FString& Diagnostic : Diagnostics)
+	{
+		UE_LOG(LogSGNarrative, Warning, TEXT("Dialogue compile: %s"), *Diagnostic);
+	}
+}
+
+void FSGCompiledDialogue::IndexReaders()
+{
+	// 1) (key slot, row slot) pairs: flags from the folded masks, ints from the checks.
+	TArray<FIntPoint> FlagPairs;
+	TArray<FIntPoint> IntPairs;
+
+	// A tag condition reads every flag under its tag, as far as the registry knows them now.
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	auto AddTagReaders = [&Registry, &FlagPairs](const FGameplayTag& Tag, int32 RowSlot)
+	{
+		if (!Tag.IsValid())
+		{
+			return;
+		}
+
+		for (int32 FlagSlot = 0; FlagSlot < Registry.NumFlags(); ++FlagSlot)
+		{
+			if (Registry.GetFlagTag(FlagSlot).MatchesTag(Tag))
+			{
+				FlagPairs.Emplace(FlagSlot, RowSlot);
+			}
+		}
+	};
+
+	for (int32 Slot = 0; Slot < Programs.Num(); ++Slot)
+	{
+		const FSGCompiledRow& Row = Programs[Slot];
+		if (Row.Condition != INDEX_NONE)
+		{
+			const FSGCompiledPredicate& Condition = Predicates[Row.Condition];
+			for (int32 Word = 0; Word < Condition.MaskWords; ++Word)
+			{
+				uint32 Bits = MaskWords[Condition.MaskStart + Word] | MaskWords[Condition.MaskStart + Condition.MaskWords + Word];
+				while (Bits != 0)
+				{
+					FlagPairs.Emplace(Word * 32 + FMath::CountTrailingZeros(Bits), Slot);
+					Bits &= Bits - 1;
+				}
+			}
+
+			for (int32 Idx = Condition.InstrStart; Idx < Condition.InstrStart + Condition.InstrNum; ++Idx)
+			{
+				if (IsFlagTagOp(Instrs[Idx].Op))
+				{
+					AddTagReaders(Instrs[Idx].Tag, Slot);
+				}
+			}
+		}
+
+		if (Row.Check != INDEX_NONE)
+		{
+			const FSGCompiledPredicate& Check = Predicates[Row.Check];
+			for (int32 Idx = Check.InstrStart; Idx < Check.InstrStart + Check.InstrNum; ++Idx)
+			{
+				if (Instrs[Idx].Slot != INDEX_NONE)
+				{
+					IntPairs.Emplace(Instrs[Idx].Slot, Slot);
+				}
+			}
+		}
+	}
+
+	// 2) Sort by key and lay each key's rows out contiguously, dropping repeats.
+	auto Build = [this](TArray<FIntPoint>& Pairs, TArray<FSGRowRange>& OutReaders)
+	{
+		Pairs.Sort([](const FIntPoint& A, const FIntPoint& B)
+		{
+			return A.X != B.X ? A.X < B.X : A.Y < B.Y;
+		});
+
+		OutReaders.SetNum(Pairs.Num() > 0 ? Pairs.Last().X + 1 : 0);
+		for (int32 Idx = 0; Idx < Pairs.Num(); ++Idx)
+		{
+			if (Idx > 0 && Pairs[Idx] == Pairs[Idx - 1])
+			{
+				continue;
+			}
+
+			FSGRowRange& Range = OutReaders[Pairs[Idx].X];
+			if (Range.Num == 0)
+			{
+				Range.Start = ReaderSlots.Num();
+			}
+			ReaderSlots.Add(Pairs[Idx].Y);
+			++Range.Num;
+		}
+	};
+
+	ReaderSlots.Reserve(FlagPairs.Num() + IntPairs.Num());
+	Build(FlagPairs, FlagReaders);
+	Build(IntPairs, IntReaders);
+}
+
+void FSGCompiledDialogue::IndexFields()
+{
+	FieldSlots.SetNumUninitialized(Rows.Num() * (int32)ESGDialogueRowField::Num);
+	int32 Next = 0;
+
+	for (int32 FieldIdx = 0; FieldIdx < (int32)ESGDialogueRowField::Num; ++FieldIdx)
+	{
+		const ESGDialogueRowField Field = (ESGDialogueRowField)FieldIdx;
+		TMap<FSGNarrativeString, FSGRowRange>& Index = FieldRows[FieldIdx];
+
+		// 1) Count rows per value.
+		for (const FSGDialogueRowData& Row : Rows)
+		{
+			++Index.FindOrAdd(GetField(Row, Field)).Num;
+		}
+
+		// 2) Give each value a contiguous range, then fill it in slot order so lists come out sorted.
+		for (TPair<FSGNarrativeString, FSGRowRange>& Pair : Index)
+		{
+			Pair.Value.Start = Next;
+			Next += Pair.Value.Num;
+			Pair.Value.Num = 0;
+		}
+
+		for (int32 Slot = 0; Slot < Rows.Num(); ++Slot)
+		{
+			FSGRowRange& Range = Index.FindChecked(GetField(Rows[Slot], Field));
+			FieldSlots[Range.Start + Range.Num++] = Slot;
+		}
+	}
+}
+
+FSGNarrativeString FSGCompiledDialogue::GetField(const FSGDialogueRowData& Row, ESGDialogueRowField Field)
+{
+	switch (Field)
+	{
+	case ESGDialogueRowField::Quest: return Row.quest;
+	case ESGDialogueRowField::Hub: return Row.hub;
+	case ESGDialogueRowField::Speaker: return Row.speaker;
+	default: return FSGNarrativeString();
+	}
+}
+
+TConstArrayView<int32> FSGCompiledDialogue::GetRowsWhere(ESGDialogueRowField Field, FSGNarrativeString Value) const
+{
+	if ((int32)Field >= (int32)ESGDialogueRowField::Num)
+	{
+		return TConstArrayView<int32>();
+	}
+
+	const FSGRowRange* Range = FieldRows[(int32)Field].Find(Value);
+	return Range ? TConstArrayView<int32>(FieldSlots.GetData() + Range->Start, Range->Num) : TConstArrayView<int32>();
+}
+
+void FSGCompiledDialogue::Query(const FSGDialogueQuery& InQuery, TArray<int32>& OutSlots) const
+{
+	OutSlots.Reset();
+
+	if (InQuery.bMatchesNothing)
+	{
+		return;
+	}
+
+	if (InQuery.Terms.Num() == 0)
+	{
+		OutSlots.SetNumUninitialized(Rows.Num());
+		for (int32 Slot = 0; Slot < Rows.Num(); ++Slot)
+		{
+			OutSlots[Slot] = Slot;
+		}
+		return;
+	}
+
+	// 1) Shortest posting list first: it bounds the result, and every later pass only shrinks it.
+	TArray<TConstArrayView<int32>, TInlineAllocator<4>> Lists;
+	for (const FSGDialogueQuery::FTerm& Term : InQuery.Terms)
+	{
+		Lists.Add(GetRowsWhere(Term.Field, Term.Value));
+	}
+	Lists.Sort([](const TConstArrayView<int32>& A, const TConstArrayView<int32>& B)
+	{
+		return A.Num() < B.Num();
+	});
+
+	OutSlots.Append(Lists[0]);
+
+	// 2) Intersect in place. Binary search when the other list is much longer (a speaker within
+	// a large quest), otherwise a linear merge.
+	for (int32 ListIdx = 1; ListIdx < Lists.Num() && OutSlots.Num() > 0; ++ListIdx)
+	{
+		const TConstArrayView<int32> Other = Lists[ListIdx];
+		const bool bSearch = Other.Num() > OutSlots.Num() * 16;
+
+		int32 Kept = 0;
+		int32 OtherIdx = 0;
+		for (int32 Idx = 0; Idx < OutSlots.Num(); ++Idx)
+		{
+			const int32 Slot = OutSlots[Idx];
+			if (bSearch)
+			{
+				OtherIdx += Algo::LowerBound(Other.Slice(OtherIdx, Other.Num() - OtherIdx), Slot);
+			}
+			else
+			{
+				while (OtherIdx < Other.Num() && Other[OtherIdx] < Slot)
+				{
+					++OtherIdx;
+				}
+			}
+
+			if (OtherIdx == Other.Num())
+			{
+				break;
+			}
+			if (Other[OtherIdx] == Slot)
+			{
+				OutSlots[Kept++] = Slot;
+			}
+		}
+		OutSlots.SetNum(Kept, EAllowShrinking::No);
+	}
+}
+
+FSGDialogueQuery& FSGDialogueQuery::Where(ESGDialogueRowField Field, FStringView Value)
+{
+	const FSGNarrativeString Handle = FSGNarrativeStringPool::Get().Find(Value);
+	bMatchesNothing |= (Handle.IsEmpty() && !Value.IsEmpty());
+	return Where(Field, Handle);
+}
+
+FSGDialogueQuery& FSGDialogueQuery::Where(ESGDialogueRowField Field, FSGNarrativeString Value)
+{
+	FTerm& Term = Terms.AddDefaulted_GetRef();
+	Term.Field = Field;
+	Term.Value = Value;
+	return *this;
+}
+
+TConstArrayView<int32> FSGCompiledDialogue::GetReaders(const TArray<FSGRowRange>& Readers, int32 KeySlot) const
+{
+	if (!Readers.IsValidIndex(KeySlot))
+	{
+		return TConstArrayView<int32>();
+	}
+
+	const FSGRowRange& Range = Readers[KeySlot];
+	return TConstArrayView<int32>(ReaderSlots.GetData() + Range.Start, Range.Num);
+}
+
+TConstArrayView<FSGDialogueRowData> FSGCompiledDialogue::GetRows(FName Id) const
+{
+	const int32 Node = FindNode(Id);
+	return Node != INDEX_NONE ? GetNodeRows(Node) : TConstArrayView<FSGDialogueRowData>();
+}
+
+void FSGCompiledDialogue::MaterializeRow(int32 Slot, FSGDialogueDecisionRow& Out) const
+{
+	Rows[Slot].Materialize(Out);
+	Out.CompiledSlot = Slot;
+	Out.CompiledSerial = Serial;
+}
+
+int32 FSGCompiledDialogue::FindNode(FName Id) const
+{
+	const int32* Found = NodeByName.Find(Id);
+	return Found ? *Found : INDEX_NONE;
+}
+
+TConstArrayView<FSGDialogueRowData> FSGCompiledDialogue::GetNodeRows(int32 Node) const
+{
+	const FSGRowRange& Range = NodeRows[Node];
+	return TConstArrayView<FSGDialogueRowData>(Rows.GetData() + Range.Start, Range.Num);
+}
+
+TConstArrayView<int32> FSGCompiledDialogue::GetNodeOptionSlots(int32 Node) const
+{
+	const FSGRowRange& Range = NodeOptions[Node];
+	return TConstArrayView<int32>(OptionSlots.GetData() + Range.Start, Range.Num);
+}
+
+ESGDialogueRowType FSGCompiledDialogue::ParseRowType(const FString& Type)
+{
+	if (Type.Equals(TEXT("DECISION_OPTION"), ESearchCase::IgnoreCase))
+	{
+		return ESGDialogueRowType::DecisionOption;
+	}
+	if (Type.Equals(TEXT("DECISION"), ESearchCase::IgnoreCase))
+	{
+		return ESGDialogueRowType::Decision;
+	}
+	if (Type.Equals(TEXT("DIALOGUE"), ESearchCase::IgnoreCase))
+	{
+		return ESGDialogueRowType::Dialogue;
+	}
+	return ESGDialogueRowType::Unknown;
+}
+
+bool FSGCompiledDialogue::BuildFromDatabase(const FSGNarrativeDatabase& Database)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
+
+	const FSGNarrativeDbTable& Table = Database.GetTable(ESGNarrativeDbSection::DialogueTable);
+	if (!Table.IsValid())
+	{
+		return false;
+	}
+
+	Reset();
+
+	const TConstArrayView<FSGNarrativeDbProgram> DbPrograms = Database.GetDialoguePrograms();
+	const bool bHasPrograms = DbPrograms.Num() == Table.Num();
+
+	const int32 NumSource = Table.Num();
+	Rows.SetNum(NumSource);
+	Programs.Reserve(NumSource);
+	RowTypes.Reserve(NumSource);
+	RowNodes.Reserve(NumSource);
+
+	TArray<FSGPredicateInstr> Conditions;
+	TArray<FSGPredicateInstr> Checks;
+	TArray<FSGEffectInstr> RowEffects;
+
+	const TConstArrayView<FSGNarrativeDbInstr> DbInstrs = Database.GetDialogueInstrs();
+	const TConstArrayView<FSGNarrativeDbInstr> DbEffects = Database.GetDialogueEffects();
+
+	auto ReadPredicates = [&Database, &DbInstrs](uint32 Start, uint32 Num, TArray<FSGPredicateInstr>& Out)
+	{
+		Out.Reset();
+		for (uint32 Idx = Start; Idx < Start + Num; ++Idx)
+		{
+			const FSGNarrativeDbInstr& Source = DbInstrs[Idx];
+			if (Source.Op > (uint32)ESGPredicateOp::NotFlagTag)
+			{
+				continue;
+			}
+
+			FSGPredicateInstr& Instr = Out.AddDefaulted_GetRef();
+			Instr.Op = (ESGPredicateOp)Source.Op;
+			Instr.Operand = Source.Value;
+			Instr.Key = FName(Database.GetString(Source.Key));
+
+			const bool bFlag = Instr.Op == ESGPredicateOp::HasFlag || Instr.Op == ESGPredicateOp::NotFlag;
+			if (IsFlagTagOp(Instr.Op))
+			{
+				Instr.Tag = FGameplayTag::RequestGameplayTag(Instr.Key, false);
+			}
+			else
+			{
+				Instr.Slot = bFlag ? FSGStateKeyRegistry::Get().RegisterFlag(Instr.Key) : FSGStateKeyRegistry::Get().RegisterInt(Instr.Key);
+			}
+		}
+	};
+
+	// One scratch row: its strings are interned, then overwritten by the next row.
+	FSGDialogueDecisionRow Source;
+
+	for (int32 Slot = 0; Slot < NumSource; ++Slot)
+	{
+		FSGDialogueRowData& Row = Rows[Slot];
+		Table.ReadRow(Slot, Source);
+		Row.Intern(Source);
+
+		// The cook lays rows out grouped by id, so a node is a run of equal ids.
+		if (Slot == 0 || Row.id != Rows[Slot - 1].id)
+		{
+			const int32 Node = NodeIds.Add(Row.id);
+			NodeByName.Add(Row.id, Node);
+			NodeRows.AddDefaulted_GetRef().Start = Slot;
+		}
+		NodeRows.Last().Num++;
+
+		RowTypes.Add(ParseRowType(Source.type));
+		RowNodes.Add(NodeIds.Num() - 1);
+
+		if (!bHasPrograms)
+		{
+			CompileRow(Slot, Source);
+			continue;
+		}
+
+		// Programs were compiled by the cook; only the registry slots are resolved here.
+		const FSGNarrativeDbProgram& Program = DbPrograms[Slot];
+		ReadPredicates(Program.ConditionStart, Program.ConditionNum, Conditions);
+		ReadPredicates(Program.CheckStart, Program.CheckNum, Checks);
+
+		RowEffects.Reset();
+		for (uint32 Idx = Program.EffectStart; Idx < Program.EffectStart + Program.EffectNum; ++Idx)
+		{
+			const FSGNarrativeDbInstr& Source = DbEffects[Idx];
+			if (Source.Op > (uint32)ESGEffectOp::AddInt)
+			{
+				continue;
+			}
+
+			FSGEffectInstr& Instr = RowEffects.AddDefaulted_GetRef();
+			Instr.Op = (ESGEffectOp)Source.Op;
+			Instr.Delta = Source.Value;
+			Instr.Key = FName(Database.GetString(Source.Key));
+			Instr.Slot = Instr.Op == ESGEffectOp::AddFlag ? FSGStateKeyRegistry::Get().RegisterFlag(Instr.Key) : FSGStateKeyRegistry::Get().RegisterInt(Instr.Key);
+		}
+
+		EmitRow(Slot, Conditions, Checks, RowEffects);
+	}
+
+	FinishBuild();
+	return true;
+}
+
+void FSGCompiledDialogue::CompileRowSource(const FSGDialogueDecisionRow& Row, TArray<FSGPredicateInstr>& OutConditions, TArray<FSGPredicateInstr>& OutChecks, TArray<FSGEffectInstr>& OutEffects)
+{
+	OutConditions.Reset();
+	OutChecks.Reset();
+	OutEffects.Reset();
+
+	TArray<FString> Parts;
+	ParseStringArrayJson(Row.conditions, Parts);
+	for (const FString& Raw : Parts)
+	{
+		FSGPredicateInstr Instr;
+		if (CompileCondition(Raw, Instr))
+		{
+			OutConditions.Add(Instr);
+		}
+	}
+
+	ParseStringArrayJson(Row.checks, Parts);
+	for (const FString& Expr : Parts)
+	{
+		FSGPredicateInstr Instr;
+		if (CompileCheck(Expr, Instr))
+		{
+			OutChecks.Add(Instr);
+		}
+	}
+
+	CompileEffects(Row, OutEffects);
+}
+
+void FSGCompiledDialogue::CompileRow(int32 Slot, const FSGDialogueDecisionRow& Source)
+{
+	TArray<FSGPredicateInstr> Conditions;
+	TArray<FSGPredicateInstr> Checks;
+	TArray<FSGEffectInstr> RowEffects;
+	CompileRowSource(Source, Conditions, Checks, RowEffects);
+
+	EmitRow(Slot, Conditions, Checks, RowEffects);
+}
+
+void FSGCompiledDialogue::EmitRow(int32 Slot, TConstArrayView<FSGPredicateInstr> Conditions, TConstArrayView<FSGPredicateInstr> Checks, TConstArrayView<FSGEffectInstr> RowEffects)
+{
+	FSGCompiledRow& Compiled = Programs.AddDefaulted_GetRef();
+	check(Programs.Num() == Slot + 1);
+
+	TArray<uint32, TInlineAllocator<4>> Required;
+	TArray<uint32, TInlineAllocator<4>> Forbidden;
+	TArray<FSGPredicateInstr, TInlineAllocator<4>> Unfolded;
+
+	for (const FSGPredicateInstr& Instr : Conditions)
+	{
+		if (IsFlagTagOp(Instr.Op) && !Instr.Tag.IsValid())
+		{
+			Diagnostics.Add(FString::Printf(TEXT("Row id=%s condition on undeclared gameplay tag %s (%s always)"),
+				*Rows[Slot].id.ToString(), *Instr.Key.ToString(), Instr.Op == ESGPredicateOp::HasFlagTag ? TEXT("false") : TEXT("true")));
+		}
+
+		if (Instr.Slot == INDEX_NONE)
+		{
+			Unfolded.Add(Instr);
+			continue;
+		}
+
+		const int32 Word = Instr.Slot >> 5;
+		if (Word >= Required.Num())
+		{
+			Required.AddZeroed(Word + 1 - Required.Num());
+			Forbidden.AddZeroed(Word + 1 - Forbidden.Num());
+		}
+
+		TArray<uint32, TInlineAllocator<4>>& Mask = (Instr.Op == ESGPredicateOp::NotFlag) ? Forbidden : Required;
+		Mask[Word] |= 1u << (Instr.Slot & 31);
+	}
+
+	Compiled.Condition = AddPredicate(Required, Forbidden, Unfolded);
+	Compiled.Check = AddPredicate(TConstArrayView<uint32>(), TConstArrayView<uint32>(), Checks);
+
+	Compiled.EffectStart = Effects.Num();
+	Effects.Append(RowEffects.GetData(), RowEffects.Num());
+	Compiled.EffectNum = Effects.Num() - Compiled.EffectStart;
+}
+
+int32 FSGCompiledDialogue::AddPredicate(TConstArrayView<uint32> Required, TConstArrayView<uint32> Forbidden, TConstArrayView<FSGPredicateInstr> PredicateInstrs)
+{
+	if (Required.Num() == 0 && PredicateInstrs.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// 1) Content hash: masks, then each instruction (keys by their FName hash).
+	uint32 Hash = FCrc::MemCrc32(Required.GetData(), Required.Num() * sizeof(uint32));
+	Hash = FCrc::MemCrc32(Forbidden.GetData(), Forbidden.Num() * sizeof(uint32), Hash);
+	for (const FSGPredicateInstr& Instr : PredicateInstrs)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Instr.Key), HashCombine((uint32)Instr.Op, (uint32)Instr.Operand)));
+	}
+
+	// 2) Reuse an identical predicate.
+	TArray<int32, TInlineAllocator<4>> Candidates;
+	PredicatesByHash.MultiFind(Hash, Candidates);
+	for (const int32 Candidate : Candidates)
+	{
+		const FSGCompiledPredicate& Existing = Predicates[Candidate];
+		if (Existing.MaskWords != Required.Num() || Existing.InstrNum != PredicateInstrs.Num())
+		{
+			continue;
+		}
+
+		const uint32* Masks = MaskWords.GetData() + Existing.MaskStart;
+		if (FMemory::Memcmp(Masks, Required.GetData(), Required.Num() * sizeof(uint32)) != 0
+			|| FMemory::Memcmp(Masks + Existing.MaskWords, Forbidden.GetData(), Forbidden.Num() * sizeof(uint32)) != 0)
+		{
+			continue;
+		}
+
+		bool bSame = true;
+		for (int32 Idx = 0; Idx < PredicateInstrs.Num() && bSame; ++Idx)
+		{
+			bSame = Instrs[Existing.InstrStart + Idx] == PredicateInstrs[Idx];
+		}
+
+		if (bSame)
+		{
+			return Candidate;
+		}
+	}
+
+	// 3) New predicate.
+	FSGCompiledPredicate& Predicate = Predicates.AddDefaulted_GetRef();
+	Predicate.MaskStart = MaskWords.Num();
+	Predicate.MaskWords = Required.Num();
+	MaskWords.Append(Required.GetData(), Required.Num());
+	MaskWords.Append(Forbidden.GetData(), Forbidden.Num());
+
+	Predicate.InstrStart = Instrs.Num();
+	Predicate.InstrNum = PredicateInstrs.Num();
+	Instrs.Append(PredicateInstrs.GetData(), PredicateInstrs.Num());
+
+	const int32 Index = Predicates.Num() - 1;
+	PredicatesByHash.Add(Hash, Index);
+	return Index;
+}
+
+int32 FSGCompiledDialogue::ResolveSlot(const FSGDialogueDecisionRow& Row) const
+{
+	if (Row.CompiledSerial != Serial || !Rows.IsValidIndex(Row.CompiledSlot))
+	{
+		return INDEX_NONE;
+	}
+
+	// The stamp is copied with the struct, so an edited copy would still carry it: only use the
+	// program while the row is still the one it was compiled from.
+	const FSGDialogueRowData& Source = Rows[Row.CompiledSlot];
+	if (Source.id != Row.id
+		|| !SameText(Row.conditions, Source.conditions)
+		|| !SameText(Row.checks, Source.checks)
+		|| !SameText(Row.set_flags, Source.set_flags)
+		|| !SameText(Row.grants, Source.grants))
+	{
+		return INDEX_NONE;
+	}
+	return Row.CompiledSlot;
+}
+
+bool FSGCompiledDialogue::EvalConditions(int32 Slot, const FSGStoryState& State) const
+{
+	return EvalPredicate(Programs[Slot].Condition, State);
+}
+
+bool FSGCompiledDialogue::EvalChecks(int32 Slot, const FSGStoryState& State) const
+{
+	return EvalPredicate(Programs[Slot].Check, State);
+}
+
+bool FSGCompiledDialogue::EvalPredicate(int32 Index, const FSGStoryState& State) const
+{
+	if (Index == INDEX_NONE)
+	{
+		return true;
+	}
+
+	// The cache is shared by every caller of this index, so only the game thread uses it.
+	const uint64 Version = State.GetCacheVersion();
+	const bool bCache = Version != 0 && IsInGameThread();
+	if (bCache && PredicateVersions[Index] == Version)
+	{
+		return PredicateResults[Index];
+	}
+
+	const FSGCompiledPredicate& Predicate = Predicates[Index];
+
+	bool bResult = true;
+	if (Predicate.MaskWords > 0)
+	{
+		const uint32* Required = MaskWords.GetData() + Predicate.MaskStart;
+		bResult = State.MatchesFlagMasks(Required, Required + Predicate.MaskWords, Predicate.MaskWords);
+	}
+	bResult = bResult && EvalRange(Predicate.InstrStart, Predicate.InstrNum, State);
+
+	if (bCache)
+	{
+		PredicateVersions[Index] = Version;
+		PredicateResults[Index] = bResult;
+	}
+	return bResult;
+}
+
+void FSGCompiledDialogue::ApplyEffects(int32 Slot, FSGStoryState& State) const
+{
+	const FSGCompiledRow& Row = Programs[Slot];
+	for (int32 Idx = Row.EffectStart; Idx < Row.EffectStart + Row.EffectNum; ++Idx)
+	{
+		ApplyInstr(Effects[Idx], State);
+	}
+}
+
+void FSGCompiledDialogue::ApplyEffects(int32 Slot, FSGStoryState& State, FSGStoryJournalEntry& OutEntry) const
+{
+	const FSGDialogueRowData& Source = Rows[Slot];
+	OutEntry.RowId = Source.id;
+	OutEntry.OptionKey = Source.option_key.IsEmpty() ? NAME_None : FName(Source.option_key.View());
+
+	const FSGCompiledRow& Row = Programs[Slot];
+	for (int32 Idx = Row.EffectStart; Idx < Row.EffectStart + Row.EffectNum; ++Idx)
+	{
+		ApplyInstr(Effects[Idx], State, OutEntry);
+	}
+}
+
+bool FSGCompiledDialogue::EvalRange(int32 Start, int32 Num, const FSGStoryState& State) const
+{
+	for (int32 Idx = Start; Idx < Start + Num; ++Idx)
+	{
+		if (!EvalInstr(Instrs[Idx], State))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FSGCompiledDialogue::EvalConditionsUncompiled(const FSGDialogueDecisionRow& Row, const FSGStoryState& State)
+{
+	TArray<FString> Conds;
+	ParseStringArrayJson(Row.conditions, Conds);
+
+	for (const FString& Raw : Conds)
+	{
+		FSGPredicateInstr Instr;
+		if (CompileCondition(Raw, Instr) && !EvalInstr(Instr, State))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FSGCompiledDialogue::EvalChecksUncompiled(const FSGDialogueDecisionRow& Row, const FSGStoryState& State)
+{
+	TArray<FString> Checks;
+	ParseStringArrayJson(Row.checks, Checks);
+
+	for (const FString& Expr : Checks)
+	{
+		FSGPredicateInstr Instr;
+		if (CompileCheck(Expr, Instr) && !EvalInstr(Instr, State))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FSGCompiledDialogue::ApplyEffectsUncompiled(const FSGDialogueDecisionRow& Row, FSGStoryState& State)
+{
+	TArray<FSGEffectInstr> RowEffects;
+	CompileEffects(Row, RowEffects);
+
+	for (const FSGEffectInstr& Instr : RowEffects)
+	{
+		ApplyInstr(Instr, State);
+	}
+}
+
+bool FSGCompiledDialogue::EvalInstr(const FSGPredicateInstr& Instr, const FSGStoryState& State)
+{
+	switch (Instr.Op)
+	{
+	case ESGPredicateOp::HasFlag:			return State.HasFlag(Instr.Key);
+	case ESGPredicateOp::NotFlag:			return !State.HasFlag(Instr.Key);
+	case ESGPredicateOp::IntGreaterEqual:	return ReadInt(State, Instr) >= Instr.Operand;
+	case ESGPredicateOp::IntLessEqual:		return ReadInt(State, Instr) <= Instr.Operand;
+	case ESGPredicateOp::IntEqual:			return ReadInt(State, Instr) == Instr.Operand;
+	case ESGPredicateOp::IntNotEqual:		return ReadInt(State, Instr) != Instr.Operand;
+	case ESGPredicateOp::IntGreater:		return ReadInt(State, Instr) > Instr.Operand;
+	case ESGPredicateOp::IntLess:			return ReadInt(State, Instr) < Instr.Operand;
+	case ESGPredicateOp::HasFlagTag:		return State.HasFlagTag(Instr.Tag);
+	case ESGPredicateOp::NotFlagTag:		return !State.HasFlagTag(Instr.Tag);
+	}
+	return true;
+}
+
+void FSGCompiledDialogue::ApplyInstr(const FSGEffectInstr& Instr, FSGStoryState& State)
+{
+	switch (Instr.Op)
+	{
+	case ESGEffectOp::AddFlag:
+		if (Instr.Slot != INDEX_NONE)
+		{
+			State.AddFlagSlot(Instr.Slot);
+		}
+		else
+		{
+			State.AddFlag(Instr.Key);
+		}
+		break;
+	case ESGEffectOp::AddInt:
+		if (Instr.Slot != INDEX_NONE)
+		{
+			State.AddIntSlot(Instr.Slot, Instr.Delta);
+		}
+		else
+		{
+			State.AddInt(Instr.Key, Instr.Delta);
+		}
+		break;
+	}
+}
+
+void FSGCompiledDialogue::ApplyInstr(const FSGEffectInstr& Instr, FSGStoryState& State, FSGStoryJournalEntry& OutEntry)
+{
+	switch (Instr.Op)
+	{
+	case ESGEffectOp::AddFlag:
+	{
+		const bool bWasSet = HasEffectFlag(State, Instr);
+		ApplyInstr(Instr, State);
+		if (!bWasSet)
+		{
+			OutEntry.FlagsAdded.Add(Instr.Key);
+		}
+		break;
+	}
+	case ESGEffectOp::AddInt:
+	{
+		FSGStoryIntDelta& Delta = OutEntry.Ints.AddDefaulted_GetRef();
+		Delta.Key = Instr.Key;
+		Delta.bWasSet = FindEffectInt(State, Instr, Delta.OldValue);
+		ApplyInstr(Instr, State);
+		FindEffectInt(State, Instr, Delta.NewValue);
+		break;
+	}
+	}
+}
+
+bool FSGCompiledDialogue::CompileCondition(const FString& Raw, FSGPredicateInstr& Out)
+{
+	const FString Trim = Raw.TrimStartAndEnd();
+	if (Trim.IsEmpty())
+	{
+		return false;
+	}
+
+	const bool bNegated = Trim.StartsWith(TEXT("!"));
+
+	// "ga.*": any flag under SG.Flag.ga, matched through the gameplay tag hierarchy; no single slot.
+	// The tag is resolved here, once; an undeclared one stays invalid and EmitRow reports it.
+	if (Trim.EndsWith(TEXT(".*")))
+	{
+		const FStringView Prefix = FStringView(Trim).Mid(bNegated ? 1 : 0).LeftChop(2);
+		Out.Op = bNegated ? ESGPredicateOp::NotFlagTag : ESGPredicateOp::HasFlagTag;
+		Out.Key = FSGStateKeyRegistry::MakeFlagTagName(Prefix);
+		Out.Tag = FGameplayTag::RequestGameplayTag(Out.Key, false);
+		Out.Slot = INDEX_NONE;
+		Out.Operand = 0;
+		return true;
+	}
+
+	Out.Op = bNegated ? ESGPredicateOp::NotFlag : ESGPredicateOp::HasFlag;
+	Out.Key = FName(*(bNegated ? Trim.Mid(1) : Trim));
+	Out.Slot = FSGStateKeyRegistry::Get().RegisterFlag(Out.Key);
+	Out.Operand = 0;
+	return true;
+}
+
+bool FSGCompiledDialogue::CompileCheck(const FString& Expr, FSGPredicateInstr& Out)
+{
+	struct FOpToken
+	{
+		const TCHAR* Text;
+		ESGPredicateOp Op;
+	};
+
+	// Order matters: two-character operators must win over their one-character prefixes.
+	static const FOpToken Tokens[] =
+	{
+		{ TEXT(">="), ESGPredicateOp::IntGreaterEqual },
+		{ TEXT("<="), ESGPredicateOp::IntLessEqual },
+		{ TEXT("=="), ESGPredicateOp::IntEqual },
+		{ TEXT("!="), ESGPredicateOp::IntNotEqual },
+		{ TEXT(">"), ESGPredicateOp::IntGreater },
+		{ TEXT("<"), ESGPredicateOp::IntLess },
+	};
+
+	const FString E = Expr.TrimStartAndEnd();
+	for (const FOpToken& Token : Tokens)
+	{
+		const int32 Idx = E.Find(Token.Text);
+		if (Idx == INDEX_NONE)
+		{
+			continue;
+		}
+
+		Out.Op = Token.Op;
+		Out.Key = FName(*E.Left(Idx).TrimStartAndEnd());
+		Out.Slot = FSGStateKeyRegistry::Get().RegisterInt(Out.Key);
+		Out.Operand = ParseDelta(E.Mid(Idx + FCString::Strlen(Token.Text)));
+		return true;
+	}
+
+	// Unknown expression; be permissive by default.
+	return false;
+}
+
+void FSGCompiledDialogue::CompileEffects(const FSGDialogueDecisionRow& Row, TArray<FSGEffectInstr>& Out)
+{
+	auto EmitFlag = [&Out](const FString& Flag)
+	{
+		FSGEffectInstr& Instr = Out.AddDefaulted_GetRef();
+		Instr.Op = ESGEffectOp::AddFlag;
+		Instr.Key = FName(*Flag);
+		Instr.Slot = FSGStateKeyRegistry::Get().RegisterFlag(Instr.Key);
+	};
+
+	// Zero deltas are kept where the grant names the key: applying still creates it in Ints.
+	auto EmitInt = [&Out](const FString& Key, int32 Delta)
+	{
+		FSGEffectInstr& Instr = Out.AddDefaulted_GetRef();
+		Instr.Op = ESGEffectOp::AddInt;
+		Instr.Key = FName(*Key);
+		Instr.Slot = FSGStateKeyRegistry::Get().RegisterInt(Instr.Key);
+		Instr.Delta = Delta;
+	};
+
+	// 1) Set flags
+	{
+		TArray<FString> Flags;
+		ParseStringArrayJson(Row.set_flags, Flags);
+		for (const FString& F : Flags)
+		{
+			const FString Trim = F.TrimStartAndEnd();
+			if (!Trim.IsEmpty())
+			{
+				EmitFlag(Trim);
+			}
+		}
+	}
+
+	// 2) Grants JSON object
+	const FString GrantsTrim = Row.grants.TrimStartAndEnd();
+	if (GrantsTrim.IsEmpty() || GrantsTrim == TEXT("{}"))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> RootObj;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(GrantsTrim);
+	if (!FJsonSerializer::Deserialize(Reader, RootObj) || !RootObj.IsValid())
+	{
+		// If parsing fails, we intentionally do nothing.
+		return;
+	}
+
+	auto CompileDeltaObject = [&](const TCHAR* FieldName)
+	{
+		const TSharedPtr<FJsonObject>* ObjPtr = nullptr;
+		if (RootObj->TryGetObjectField(FieldName, ObjPtr) && ObjPtr && ObjPtr->IsValid())
+		{
+			for (const auto& Pair : (*ObjPtr)->Values)
+			{
+				const FString DeltaStr = Pair.Value.IsValid() ? Pair.Value->AsString() : TEXT("0");
+				EmitInt(Pair.Key, ParseDelta(DeltaStr));
+			}
+		}
+	};
+
+	CompileDeltaObject(TEXT("rep"));
+	CompileDeltaObject(TEXT("trust"));
+
+	// xp: number or string
+	if (const TSharedPtr<FJsonValue> V = RootObj->TryGetField(TEXT("xp")))
+	{
+		int32 XpDelta = 0;
+		if (V->Type == EJson::Number)
+		{
+			XpDelta = (int32)V->AsNumber();
+		}
+		else if (V->Type == EJson::String)
+		{
+			XpDelta = ParseDelta(V->AsString());
+		}
+
+		if (XpDelta != 0)
+		{
+			EmitInt(TEXT("xp"), XpDelta);
+		}
+	}
+
+	// item: string or array. We store as counter ints: item_<name> += 1
+	if (const TSharedPtr<FJsonValue> V = RootObj->TryGetField(TEXT("item")))
+	{
+		auto CompileItemCounter = [&](const FString& ItemName)
+		{
+			const FString TrimItem = ItemName.TrimStartAndEnd();
+			if (!TrimItem.IsEmpty())
+			{
+				EmitInt(FString::Printf(TEXT("item_%s"), *TrimItem), 1);
+			}
+		};
+
+		if (V->Type == EJson::String)
+		{
+			CompileItemCounter(V->AsString());
+		}
+		else if (V->Type == EJson::Array)
+		{
+			for (const TSharedPtr<FJsonValue>& Elem : V->AsArray())
+			{
+				if (Elem.IsValid())
+				{
+					CompileItemCounter(Elem->AsString());
+				}
+			}
+		}
+	}
+
+	// Any other numeric top-level keys: mirror into Ints.
+	for (const auto& Pair : RootObj->Values)
+	{
+		const FString& Key = Pair.Key;
+		if (Key == TEXT("rep") || Key == TEXT("trust") || Key == TEXT("xp") || Key == TEXT("item"))
+		{
+			continue;
+		}
+
+		const TSharedPtr<FJsonValue>& V = Pair.Value;
+		if (!V.IsValid()) continue;
+
+		if (V->Type == EJson::Number)
+		{
+			EmitInt(Key, (int32)V->AsNumber());
+		}
+		else if (V->Type == EJson::String)
+		{
+			const int32 Delta = ParseDelta(V->AsString());
+			if (Delta != 0)
+			{
+				EmitInt(Key, Delta);
+			}
+		}
+	}
+}
+
+void FSGCompiledDialogue::ParseStringArrayJson(const FString& JsonLikeArray, TArray<FString>& Out)
+{
+	Out.Reset();
+
+	const FString Trim = JsonLikeArray.TrimStartAndEnd();
+	if (Trim.IsEmpty() || Trim == TEXT("[]"))
+	{
+		return;
+	}
+
+	// First try: strict JSON parse
+	{
+		TSharedPtr<FJsonValue> RootValue;
+		const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Trim);
+		if (FJsonSerializer::Deserialize(Reader, RootValue) && RootValue.IsValid())
+		{
+			const TArray<TSharedPtr<FJsonValue>>* Arr = nullptr;
+			if (RootValue->TryGetArray(Arr) && Arr)
+			{
+				for (const TSharedPtr<FJsonValue>& V : *Arr)
+				{
+					if (V.IsValid())
+					{
+						Out.Add(V->AsString());
+					}
+				}
+				return;
+			}
+		}
+	}
+
+	// Fallback: naive split for mildly broken arrays
+	FString Inner = Trim;
+	Inner.RemoveFromStart(TEXT("["));
+	Inner.RemoveFromEnd(TEXT("]"));
+
+	TArray<FString> Parts;
+	Inner.ParseIntoArray(Parts, TEXT(","), true);
+	for (FString P : Parts)
+	{
+		P = P.TrimStartAndEnd();
+		P = P.Replace(TEXT("\""), TEXT(""));
+		if (!P.IsEmpty())
+		{
+			Out.Add(P);
+		}
+	}
+}
+
+int32 FSGCompiledDialogue::ParseDelta(const FString& DeltaStr)
+{
+	FString S = DeltaStr.TrimStartAndEnd();
+	S = S.Replace(TEXT("−"), TEXT("-")); // unicode minus
+	return FCString::Atoi(*S);
+}
@@ -1,20 +1,39 @@
 #include "SGDecisionPointSubsystem.h"
+#include "SGNarrativeDatabase.h"
 #include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
 
 #include "Dom/JsonObject.h"
-#include "Misc/FileHelper.h"
-#include "Misc/Paths.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
+#include "UObject/StrongObjectPtr.h"
 
 void USGDecisionPointSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
-	Reload();
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (Settings && Settings->bLoadAsync)
+	{
+		ReloadAsync();
+	}
+	else
+	{
+		Reload();
+	}
 }
 
 void USGDecisionPointSubsystem::Reload()
 {
+	++LoadRequest;
+	bReady = false;
+
+	if (UseDatabase())
+	{
+		FinishLoad();
+		return;
+	}
+
 	DecisionPointsTable = nullptr;
 	PromptById.Reset();
 	OptionsById.Reset();
@@ -30,69 +49,115 @@ void USGDecisionPointSubsystem::Reload()
 	// Fallback: if no DataTable is configured yet, we can still read the parsed JSON directly.
 	if (!DecisionPointsTable && Settings)
 	{
-		const FString RelPath = Settings->DecisionPointsJson.TrimStartAndEnd();
-		if (!RelPath.IsEmpty())
+		FIndex Index;
+		BuildIndexFromJson(Settings->DecisionPointsJson, Index);
+		PromptById = MoveTemp(Index.PromptById);
+		OptionsById = MoveTemp(Index.OptionsById);
+	}
+
+	FinishLoad();
+}
+
+void USGDecisionPointSubsystem::ReloadAsync()
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		Reload();
+		return;
+	}
+
+	const uint32 Request = ++LoadRequest;
+	bReady = false;
+	if (UseDatabase())
+	{
+		// Nothing to parse or index: the database is read in place.
+		FinishLoad();
+		return;
+	}
+
+	TWeakObjectPtr<USGDecisionPointSubsystem> WeakThis(this);
+	const FString JsonPath = Settings->DecisionPointsJson;
+
+	FSGNarrativeAsync::LoadTable(Settings->DecisionPointsTable, [WeakThis, Request, JsonPath](UDataTable* Table)
+	{
+		if (!WeakThis.IsValid() || WeakThis->LoadRequest != Request)
 		{
-			const FString AbsPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), RelPath));
-			FString Json;
-			if (FFileHelper::LoadFileToString(Json, *AbsPath))
+			return;
+		}
+
+		// Rows are copied on the game thread: the table can be edited or reimported while the worker indexes.
+		TArray<FSGDecisionPointRow> RowCopies = FSGNarrativeAsync::CopyRows<FSGDecisionPointRow>(Table, TEXT("USGDecisionPointSubsystem::ReloadAsync"));
+
+		TSharedRef<FIndex> Index = MakeShared<FIndex>();
+		TStrongObjectPtr<UDataTable> Pinned(Table);
+		const bool bFromJson = (Table == nullptr);
+
+		FSGNarrativeAsync::Run(
+			[Index, RowCopies = MoveTemp(RowCopies), JsonPath, bFromJson]() mutable
 			{
-				TSharedPtr<FJsonObject> Root;
-				const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
-				if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
+				if (bFromJson)
 				{
-					const TArray<TSharedPtr<FJsonValue>>* Dps = nullptr;
-					if (Root->TryGetArrayField(TEXT("decision_points"), Dps) && Dps)
-					{
-						for (const TSharedPtr<FJsonValue>& DpVal : *Dps)
-						{
-							const TSharedPtr<FJsonObject> DpObj = DpVal.IsValid() ? DpVal->AsObject() : nullptr;
-							if (!DpObj.IsValid()) continue;
-
-							const FString DpId = DpObj->GetStringField(TEXT("dp_id"));
-							if (DpId.IsEmpty()) continue;
-
-							FSGDecisionPointRow Prompt;
-							Prompt.act = DpObj->GetStringField(TEXT("act"));
-							Prompt.scene = DpObj->GetStringField(TEXT("scene"));
-							Prompt.dp_id = DpId;
-							Prompt.row_type = TEXT("PROMPT");
-							Prompt.prompt_text = DpObj->GetStringField(TEXT("title"));
-							PromptById.Add(DpId, Prompt);
-
-							const TArray<TSharedPtr<FJsonValue>>* Opts = nullptr;
-							if (DpObj->TryGetArrayField(TEXT("options"), Opts) && Opts)
-							{
-								TArray<FSGDecisionPointRow>& Bucket = OptionsById.FindOrAdd(DpId);
-								for (const TSharedPtr<FJsonValue>& OptVal : *Opts)
-								{
-									const TSharedPtr<FJsonObject> OptObj = OptVal.IsValid() ? OptVal->AsObject() : nullptr;
-									if (!OptObj.IsValid()) continue;
-
-									FSGDecisionPointRow Opt;
-									Opt.act = Prompt.act;
-									Opt.scene = Prompt.scene;
-									Opt.dp_id = DpId;
-									Opt.row_type = TEXT("OPTION");
-									Opt.prompt_text = Prompt.prompt_text;
-									Opt.option_key = OptObj->GetStringField(TEXT("key"));
-									Opt.option_text = OptObj->GetStringField(TEXT("text"));
-									Opt.immediate = OptObj->GetStringField(TEXT("immediate"));
-									Opt.long_term = OptObj->GetStringField(TEXT("long_term"));
-									Bucket.Add(Opt);
-								}
-
-								Bucket.Sort([](const FSGDecisionPointRow& A, const FSGDecisionPointRow& B)
-								{
-									return A.option_key < B.option_key;
-								});
-							}
-						}
-					}
+					BuildIndexFromJson(JsonPath, *Index);
 				}
-			}
-		}
+				else
+				{
+					BuildIndexFromRows(MoveTemp(RowCopies), *Index);
+				}
+			},
+			[WeakThis, Request, Index, Pinned = MoveTemp(Pinned)]()
+			{
+				USGDecisionPointSubsystem* This = WeakThis.Get();
+				if (!This || This->LoadRequest != Request)
+				{
+					return;
+				}
+
+				This->DecisionPointsTable = Pinned.Get();
+				This->PromptById = MoveTemp(Index->PromptById);
+				This->OptionsById = MoveTemp(Index->OptionsById);
+				This->FinishLoad();
+			});
+	});
+}
+
+bool USGDecisionPointSubsystem::UseDatabase()
+{
+	Database = FSGNarrativeDatabase::GetProjectDatabase();
+	if (!Database.IsValid() || !Database->GetTable(ESGNarrativeDbSection::DecisionPromptTable).IsValid())
+	{
+		Database.Reset();
+		return false;
 	}
+
+	DecisionPointsTable = nullptr;
+	PromptById.Reset();
+	OptionsById.Reset();
+	return true;
+}
+
+void USGDecisionPointSubsystem::ReloadFromTable(UDataTable* Table)
+{
+	++LoadRequest;
+	bReady = false;
+
+	Database.Reset();
+	DecisionPointsTable = Table;
+	BuildIndex();
+	FinishLoad();
+}
+
+void USGDecisionPointSubsystem::FinishLoad()
+{
+	SIZE_T IndexSize = PromptById.GetAllocatedSize() + OptionsById.GetAllocatedSize();
+	for (const auto& Pair : OptionsById)
+	{
+		IndexSize += Pair.Value.GetAllocatedSize();
+	}
+	SET_MEMORY_STAT(STAT_SGNarrative_DecisionPointsIndexMemory, IndexSize);
+
+	bReady = true;
+	OnReady.Broadcast();
 }
 
 void USGDecisionPointSubsystem::BuildIndex()
@@ -105,28 +170,32 @@ void USGDecisionPointSubsystem::BuildIndex()
 		return;
 	}
 
-	static const FString Context = TEXT("USGDecisionPointSubsystem::BuildIndex");
-	TArray<FSGDecisionPointRow*> AllRows;
-	DecisionPointsTable->GetAllRows(Context, AllRows);
+	FIndex Index;
+	BuildIndexFromRows(FSGNarrativeAsync::CopyRows<FSGDecisionPointRow>(DecisionPointsTable, TEXT("USGDecisionPointSubsystem::BuildIndex")), Index);
+	PromptById = MoveTemp(Index.PromptById);
+	OptionsById = MoveTemp(Index.OptionsById);
+}
 
-	for (const FSGDecisionPointRow* Row : AllRows)
-	{
-		if (!Row) continue;
+void USGDecisionPointSubsystem::BuildIndexFromRows(TArray<FSGDecisionPointRow>&& AllRows, FIndex& Out)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
 
-		const FString DpId = Row->dp_id;
+	for (FSGDecisionPointRow& Row : AllRows)
+	{
+		const FString DpId = Row.dp_id;
 		if (DpId.IsEmpty()) continue;
 
-		if (Row->row_type.Equals(TEXT("PROMPT"), ESearchCase::IgnoreCase))
+		if (Row.row_type.Equals(TEXT("PROMPT"), ESearchCase::IgnoreCase))
 		{
-			PromptById.Add(DpId, *Row);
+			Out.PromptById.Add(DpId, MoveTemp(Row));
 		}
-		else if (Row->row_type.Equals(TEXT("OPTION"), ESearchCase::IgnoreCase))
+		else if (Row.row_type.Equals(TEXT("OPTION"), ESearchCase::IgnoreCase))
 		{
-			OptionsById.FindOrAdd(DpId).Add(*Row);
+			Out.OptionsById.FindOrAdd(DpId).Add(MoveTemp(Row));
 		}
 	}
 
-	for (auto& Pair : OptionsById)
+	for (auto& Pair : Out.OptionsById)
 	{
 		Pair.Value.Sort([](const FSGDecisionPointRow& A, const FSGDecisionPointRow& B)
 		{
@@ -135,8 +204,85 @@ void USGDecisionPointSubsystem::BuildIndex()
 	}
 }
 
+void USGDecisionPointSubsystem::BuildIndexFromJson(const FString& RelPath, FIndex& Out)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
+
+	FString Json;
+	if (!FSGNarrativeAsync::LoadProjectFile(RelPath, Json))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+	if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Dps = nullptr;
+		if (Root->TryGetArrayField(TEXT("decision_points"), Dps) && Dps)
+		{
+			for (const TSharedPtr<FJsonValue>& DpVal : *Dps)
+			{
+				const TSharedPtr<FJsonObject> DpObj = DpVal.IsValid() ? DpVal->AsObject() : nullptr;
+				if (!DpObj.IsValid()) continue;
+
+				const FString DpId = DpObj->GetStringField(TEXT("dp_id"));
+				if (DpId.IsEmpty()) continue;
+
+				FSGDecisionPointRow Prompt;
+				Prompt.act = DpObj->GetStringField(TEXT("act"));
+				Prompt.scene = DpObj->GetStringField(TEXT("scene"));
+				Prompt.dp_id = DpId;
+				Prompt.row_type = TEXT("PROMPT");
+				Prompt.prompt_text = DpObj->GetStringField(TEXT("title"));
+				Out.PromptById.Add(DpId, Prompt);
+
+				const TArray<TSharedPtr<FJsonValue>>* Opts = nullptr;
+				if (DpObj->TryGetArrayField(TEXT("options"), Opts) && Opts)
+				{
+					TArray<FSGDecisionPointRow>& Bucket = Out.OptionsById.FindOrAdd(DpId);
+					for (const TSharedPtr<FJsonValue>& OptVal : *Opts)
+					{
+						const TSharedPtr<FJsonObject> OptObj = OptVal.IsValid() ? OptVal->AsObject() : nullptr;
+						if (!OptObj.IsValid()) continue;
+
+						FSGDecisionPointRow Opt;
+						Opt.act = Prompt.act;
+						Opt.scene = Prompt.scene;
+						Opt.dp_id = DpId;
+						Opt.row_type = TEXT("OPTION");
+						Opt.prompt_text = Prompt.prompt_text;
+						Opt.option_key = OptObj->GetStringField(TEXT("key"));
+						Opt.option_text = OptObj->GetStringField(TEXT("text"));
+						Opt.immediate = OptObj->GetStringField(TEXT("immediate"));
+						Opt.long_term = OptObj->GetStringField(TEXT("long_term"));
+						Bucket.Add(Opt);
+					}
+
+					Bucket.Sort([](const FSGDecisionPointRow& A, const FSGDecisionPointRow& B)
+					{
+						return A.option_key < B.option_key;
+					});
+				}
+			}
+		}
+	}
+}
+
 bool USGDecisionPointSubsystem::GetPrompt(const FString& DpId, FSGDecisionPointRow& OutPrompt) const
 {
+	if (Database.IsValid())
+	{
+		const FSGNarrativeDbTable& Prompts = Database->GetTable(ESGNarrativeDbSection::DecisionPromptTable);
+		const FSGRowRange Range = Prompts.Find(FStringView(DpId));
+		if (Range.Num > 0)
+		{
+			Prompts.ReadRow(Range.Start, OutPrompt);
+			return true;
+		}
+		return false;
+	}
+
 	if (const FSGDecisionPointRow* Found = PromptById.Find(DpId))
 	{
 		OutPrompt = *Found;
@@ -149,6 +295,18 @@ bool USGDecisionPointSubsystem::GetOptions(const FString& DpId, TArray<FSGDecisi
 {
 	OutOptions.Reset();
 
+	if (Database.IsValid())
+	{
+		const FSGNarrativeDbTable& Options = Database->GetTable(ESGNarrativeDbSection::DecisionOptionTable);
+		const FSGRowRange Range = Options.Find(FStringView(DpId));
+		OutOptions.SetNum(Range.Num);
+		for (int32 Idx = 0; Idx < Range.Num; ++Idx)
+		{
+			Options.ReadRow(Range.Start + Idx, OutOptions[Idx]);
+		}
+		return OutOptions.Num() > 0;
+	}
+
 	if (const TArray<FSGDecisionPointRow>* Found = OptionsById.Find(DpId))
 	{
 		OutOptions = *Found;
@@ -0,0 +1,272 @@
+#include "SGDialoguePrefetcher.h"
+#include "SGCompiledDialogue.h"
+#include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+
+namespace
+{
+	/** Budget guess for an asset nothing has been measured for yet. */
+	constexpr int64 DefaultAssetBytes = 256 * 1024;
+
+	void ReleaseHandle(const TSharedPtr<FStreamableHandle>& Handle)
+	{
+		if (!Handle.IsValid())
+		{
+			return;
+		}
+
+		if (Handle->IsLoadingInProgress())
+		{
+			Handle->CancelHandle();
+		}
+		else
+		{
+			Handle->ReleaseHandle();
+		}
+	}
+}
+
+FSGDialoguePrefetcher::~FSGDialoguePrefetcher()
+{
+	ReleaseAll();
+}
+
+void FSGDialoguePrefetcher::Prefetch(const FSGCompiledDialogue& Compiled, int32 Node)
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings || Settings->PrefetchDepth <= 0 || Node < 0 || Node >= Compiled.NumNodes())
+	{
+		ReleaseAll();
+		return;
+	}
+
+	// 1) Assets of every node within PrefetchDepth edges, breadth first so nearer nodes come first.
+	// A node's range holds its options too, so option `next` edges are followed like any other.
+	TArray<FSoftObjectPath> Wanted;
+	TSet<FSoftObjectPath> WantedSet;
+	TArray<FSoftObjectPath> RowAssets;
+
+	TBitArray<> Visited(false, Compiled.NumNodes());
+	Visited[Node] = true;
+	TArray<int32> Frontier = { Node };
+
+	for (int32 Depth = 0; Depth <= Settings->PrefetchDepth && Frontier.Num() > 0; ++Depth)
+	{
+		TArray<int32> NextFrontier;
+		for (const int32 Current : Frontier)
+		{
+			const FSGRowRange Range = Compiled.GetNodeRange(Current);
+			for (int32 Slot = Range.Start; Slot < Range.Start + Range.Num; ++Slot)
+			{
+				GetRowAssets(Compiled, Slot, RowAssets);
+				for (const FSoftObjectPath& Path : RowAssets)
+				{
+					bool bAlreadyWanted = false;
+					WantedSet.Add(Path, &bAlreadyWanted);
+					if (!bAlreadyWanted)
+					{
+						Wanted.Add(Path);
+					}
+				}
+
+				const int32 Next = Compiled.GetNextNode(Slot);
+				if (Next != INDEX_NONE && !Visited[Next])
+				{
+					Visited[Next] = true;
+					NextFrontier.Add(Next);
+				}
+			}
+		}
+		Frontier = MoveTemp(NextFrontier);
+	}
+
+	// 2) Release what is no longer reachable: the branches the player did not take.
+	for (auto It = Held.CreateIterator(); It; ++It)
+	{
+		if (!WantedSet.Contains(It.Key()))
+		{
+			ReleaseHandle(It.Value().Handle);
+			It.RemoveCurrent();
+		}
+	}
+
+	// 3) Request nearest first until the budget is spent.
+	const int64 Budget = (int64)Settings->PrefetchBudgetMB * 1024 * 1024;
+	int64 Committed = 0;
+	for (const TPair<FSoftObjectPath, FHeld>& Pair : Held)
+	{
+		Committed += Pair.Value.Bytes >= 0 ? Pair.Value.Bytes : EstimateBytes(Pair.Key);
+	}
+
+	for (const FSoftObjectPath& Path : Wanted)
+	{
+		if (Held.Contains(Path))
+		{
+			continue;
+		}
+
+		const int64 Estimate = EstimateBytes(Path);
+		if (Committed + Estimate > Budget)
+		{
+			break;
+		}
+
+		// Add first: an already resident asset completes inside RequestAsyncLoad.
+		Held.Add(Path);
+		TSharedPtr<FStreamableHandle> Handle = Streamable.RequestAsyncLoad(Path, FStreamableDelegate::CreateRaw(this, &FSGDialoguePrefetcher::OnLoaded, Path));
+
+		FHeld& Entry = Held.FindChecked(Path);
+		Entry.Handle = MoveTemp(Handle);
+		if (!Entry.Handle.IsValid())
+		{
+			// Bad path; keep the entry so it is not requested again at every node.
+			Entry.Bytes = 0;
+		}
+		Committed += Estimate;
+	}
+
+	UpdateStats();
+}
+
+void FSGDialoguePrefetcher::ReleaseAll()
+{
+	for (TPair<FSoftObjectPath, FHeld>& Pair : Held)
+	{
+		ReleaseHandle(Pair.Value.Handle);
+	}
+	Held.Reset();
+
+	EmotionAssets.Reset();
+	AnimAssets.Reset();
+	VoiceAssetExists.Reset();
+
+	UpdateStats();
+}
+
+int64 FSGDialoguePrefetcher::GetResidentBytes() const
+{
+	int64 Bytes = 0;
+	for (const TPair<FSoftObjectPath, FHeld>& Pair : Held)
+	{
+		Bytes += FMath::Max<int64>(Pair.Value.Bytes, 0);
+	}
+	return Bytes;
+}
+
+void FSGDialoguePrefetcher::GetRowAssets(const FSGCompiledDialogue& Compiled, int32 Slot, TArray<FSoftObjectPath>& OutAssets)
+{
+	OutAssets.Reset();
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		return;
+	}
+
+	const FSGDialogueRowData& Row = Compiled.GetRow(Slot);
+
+	if (const FSoftObjectPath* Emotion = FindValueAsset(EmotionAssets, Settings->EmotionAssets, Row.emotion))
+	{
+		OutAssets.Add(*Emotion);
+	}
+
+	if (const FSoftObjectPath* Anim = FindValueAsset(AnimAssets, Settings->AnimAssets, Row.anim))
+	{
+		OutAssets.Add(*Anim);
+	}
+
+	if (!Settings->VoiceAssetPathFormat.IsEmpty())
+	{
+		FString VoicePath = Settings->VoiceAssetPathFormat;
+		VoicePath.ReplaceInline(TEXT("{id}"), *Row.id.ToString(), ESearchCase::CaseSensitive);
+		VoicePath.ReplaceInline(TEXT("{option_key}"), *Row.option_key.ToString(), ESearchCase::CaseSensitive);
+
+		const FSoftObjectPath Voice(VoicePath);
+		if (DoesVoiceAssetExist(Voice))
+		{
+			OutAssets.Add(Voice);
+		}
+	}
+}
+
+bool FSGDialoguePrefetcher::DoesVoiceAssetExist(const FSoftObjectPath& Path)
+{
+	if (!Path.IsValid())
+	{
+		return false;
+	}
+
+	if (const bool* Known = VoiceAssetExists.Find(Path))
+	{
+		return *Known;
+	}
+
+	IAssetRegistry* Registry = IAssetRegistry::Get();
+	if (!Registry)
+	{
+		return false;
+	}
+
+	const bool bExists = Registry->GetAssetByObjectPath(Path).IsValid();
+
+	// A miss during the initial editor scan may be an asset not discovered yet; ask again next time.
+	if (bExists || !Registry->IsLoadingAssets())
+	{
+		VoiceAssetExists.Add(Path, bExists);
+	}
+	return bExists;
+}
+
+const FSoftObjectPath* FSGDialoguePrefetcher::FindValueAsset(TMap<FSGNarrativeString, FSoftObjectPath>& Cache, const TMap<FName, FSoftObjectPath>& Source, FSGNarrativeString Value)
+{
+	if (Value.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	const FSoftObjectPath* Found = Cache.Find(Value);
+	if (!Found)
+	{
+		// Matched as an FName, so case-insensitively like the setting's keys: "Angry" finds rows saying "angry".
+		// A value no FName spells is not a settings key either.
+		const FStringView View = Value.View();
+		const FName Name(View.Len(), View.GetData(), FNAME_Find);
+		const FSoftObjectPath* Configured = Name.IsNone() ? nullptr : Source.Find(Name);
+		Found = &Cache.Add(Value, Configured ? *Configured : FSoftObjectPath());
+	}
+	return Found->IsValid() ? Found : nullptr;
+}
+
+int64 FSGDialoguePrefetcher::EstimateBytes(const FSoftObjectPath& Path) const
+{
+	if (const int64* Known = KnownSizes.Find(Path))
+	{
+		return *Known;
+	}
+	return KnownSizes.Num() > 0 ? KnownBytesTotal / KnownSizes.Num() : DefaultAssetBytes;
+}
+
+void FSGDialoguePrefetcher::OnLoaded(FSoftObjectPath Path)
+{
+	FHeld* Entry = Held.Find(Path);
+	if (!Entry)
+	{
+		return;
+	}
+
+	const UObject* Asset = Path.ResolveObject();
+	Entry->Bytes = Asset ? (int64)Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+
+	int64& Known = KnownSizes.FindOrAdd(Path, 0);
+	KnownBytesTotal += Entry->Bytes - Known;
+	Known = Entry->Bytes;
+
+	UpdateStats();
+}
+
+void FSGDialoguePrefetcher::UpdateStats() const
+{
+	SET_MEMORY_STAT(STAT_SGNarrative_PrefetchMemory, GetResidentBytes());
+}
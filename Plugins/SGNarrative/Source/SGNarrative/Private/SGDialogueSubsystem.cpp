@@ -1,20 +1,44 @@
 #include "SGDialogueSubsystem.h"
+#include "SGNarrativeDatabase.h"
 #include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
+#include "SGStateKeyRegistry.h"
 
-#include "Dom/JsonObject.h"
-#include "Serialization/JsonReader.h"
-#include "Serialization/JsonSerializer.h"
+#include "UObject/StrongObjectPtr.h"
 
 void USGDialogueSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
-	Reload();
+
+	// Seed known flags before anything builds story state; the table adds its own keys on compile.
+	FSGStateKeyRegistry::Get().RegisterProjectKeys();
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (Settings && Settings->bLoadAsync)
+	{
+		ReloadAsync();
+	}
+	else
+	{
+		Reload();
+	}
 }
 
 void USGDialogueSubsystem::Reload()
 {
+	++LoadRequest;
+	bReady = false;
+
 	DialogueDecisionTable = nullptr;
-	RowsById.Reset();
+	Compiled.Reset();
+
+	// A cooked database already holds grouped rows and compiled programs.
+	const TSharedPtr<const FSGNarrativeDatabase> Database = FSGNarrativeDatabase::GetProjectDatabase();
+	if (Database.IsValid() && Compiled.BuildFromDatabase(*Database))
+	{
+		FinishLoad();
+		return;
+	}
 
 	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
 	if (Settings && Settings->DialogueDecisionTable.IsValid() == false)
@@ -28,11 +52,117 @@ void USGDialogueSubsystem::Reload()
 	}
 
 	BuildIndex();
+	FinishLoad();
+}
+
+void USGDialogueSubsystem::ReloadAsync()
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		Reload();
+		return;
+	}
+
+	const uint32 Request = ++LoadRequest;
+	TWeakObjectPtr<USGDialogueSubsystem> WeakThis(this);
+
+	// The current index stays usable, but it is no longer the one being loaded.
+	bReady = false;
+
+	const TSharedPtr<const FSGNarrativeDatabase> Database = FSGNarrativeDatabase::GetProjectDatabase();
+	if (Database.IsValid() && Database->GetTable(ESGNarrativeDbSection::DialogueTable).IsValid())
+	{
+		TSharedRef<FSGCompiledDialogue> Built = MakeShared<FSGCompiledDialogue>();
+		FSGNarrativeAsync::Run(
+			[Built, Database]()
+			{
+				Built->BuildFromDatabase(*Database);
+			},
+			[WeakThis, Request, Built]()
+			{
+				USGDialogueSubsystem* This = WeakThis.Get();
+				if (!This || This->LoadRequest != Request)
+				{
+					return;
+				}
+
+				This->DialogueDecisionTable = nullptr;
+				This->Compiled = MoveTemp(*Built);
+				This->FinishLoad();
+			});
+		return;
+	}
+
+	FSGNarrativeAsync::LoadTable(Settings->DialogueDecisionTable, [WeakThis, Request](UDataTable* Table)
+	{
+		if (!WeakThis.IsValid() || WeakThis->LoadRequest != Request)
+		{
+			return;
+		}
+
+		// Rows are copied here, on the game thread: the table can be edited or reimported while the
+		// worker compiles. The pin only keeps the table alive until the swap.
+		TArray<FSGDialogueDecisionRow> RowCopies = FSGNarrativeAsync::CopyRows<FSGDialogueDecisionRow>(Table, TEXT("USGDialogueSubsystem::ReloadAsync"));
+
+		TSharedRef<FSGCompiledDialogue> Built = MakeShared<FSGCompiledDialogue>();
+		TStrongObjectPtr<UDataTable> Pinned(Table);
+
+		FSGNarrativeAsync::Run(
+			[Built, RowCopies = MoveTemp(RowCopies)]() mutable
+			{
+				TArray<FSGDialogueDecisionRow*> AllRows;
+				AllRows.Reserve(RowCopies.Num());
+				for (FSGDialogueDecisionRow& Row : RowCopies)
+				{
+					AllRows.Add(&Row);
+				}
+				Built->Build(AllRows);
+			},
+			[WeakThis, Request, Built, Pinned = MoveTemp(Pinned)]()
+			{
+				USGDialogueSubsystem* This = WeakThis.Get();
+				if (!This || This->LoadRequest != Request)
+				{
+					return;
+				}
+
+				This->DialogueDecisionTable = Pinned.Get();
+				This->Compiled = MoveTemp(*Built);
+				This->FinishLoad();
+			});
+	});
+}
+
+void USGDialogueSubsystem::ReloadFromTable(UDataTable* Table)
+{
+	++LoadRequest;
+	bReady = false;
+
+	DialogueDecisionTable = Table;
+	BuildIndex();
+	FinishLoad();
+}
+
+void USGDialogueSubsystem::FinishLoad()
+{
+	ResetWatches();
+	bWatchesStale = WatchedDecisions.Num() > 0;
+	bAdoptKeys = true;
+
+	// Node indices belong to the old index.
+	Prefetcher.ReleaseAll();
+
+	SET_MEMORY_STAT(STAT_SGNarrative_DialogueIndexMemory, Compiled.GetAllocatedSize());
+	SET_MEMORY_STAT(STAT_SGNarrative_StringPoolMemory, FSGNarrativeStringPool::Get().GetAllocatedSize());
+
+	bReady = true;
+	OnReady.Broadcast();
 }
 
 void USGDialogueSubsystem::BuildIndex()
 {
-	RowsById.Reset();
+	Compiled.Reset();
 
 	if (!DialogueDecisionTable)
 	{
@@ -43,373 +173,515 @@ void USGDialogueSubsystem::BuildIndex()
 	TArray<FSGDialogueDecisionRow*> AllRows;
 	DialogueDecisionTable->GetAllRows(Context, AllRows);
 
-	for (const FSGDialogueDecisionRow* Row : AllRows)
-	{
-		if (!Row)
-		{
-			continue;
-		}
-
-		TArray<FSGDialogueDecisionRow>& Bucket = RowsById.FindOrAdd(Row->id);
-		Bucket.Add(*Row);
-	}
+	// Parse conditions/checks/effects once; cached rows carry their compiled slot.
+	Compiled.Build(AllRows);
 }
 
 bool USGDialogueSubsystem::GetRowsByNarrativeId(FName Id, TArray<FSGDialogueDecisionRow>& OutRows) const
 {
 	OutRows.Reset();
 
-	if (const TArray<FSGDialogueDecisionRow>* Found = RowsById.Find(Id))
+	const int32 Node = Compiled.FindNode(Id);
+	if (Node == INDEX_NONE)
 	{
-		OutRows = *Found;
-		return OutRows.Num() > 0;
+		return false;
 	}
 
-	return false;
+	const FSGRowRange Range = Compiled.GetNodeRange(Node);
+	OutRows.SetNum(Range.Num);
+	for (int32 Idx = 0; Idx < Range.Num; ++Idx)
+	{
+		Compiled.MaterializeRow(Range.Start + Idx, OutRows[Idx]);
+	}
+	return OutRows.Num() > 0;
 }
 
 bool USGDialogueSubsystem::GetFirstRowByNarrativeId(FName Id, FSGDialogueDecisionRow& OutRow) const
 {
-	TArray<FSGDialogueDecisionRow> Rows;
-	if (!GetRowsByNarrativeId(Id, Rows))
+	const int32 Node = Compiled.FindNode(Id);
+	if (Node == INDEX_NONE)
 	{
 		return false;
 	}
 
-	// Prefer a non-option row for the "node".
-	for (const FSGDialogueDecisionRow& R : Rows)
-	{
-		if (!R.type.Equals(TEXT("DECISION_OPTION"), ESearchCase::IgnoreCase))
-		{
-			OutRow = R;
-			return true;
-		}
-	}
-
-	// Fallback: first row.
-	OutRow = Rows[0];
+	Compiled.MaterializeRow(Compiled.GetNodePrimarySlot(Node), OutRow);
 	return true;
 }
 
+const FSGDialogueRowData* USGDialogueSubsystem::FindNodeRow(FName Id) const
+{
+	const int32 Node = Compiled.FindNode(Id);
+	return Node != INDEX_NONE ? &Compiled.GetRow(Compiled.GetNodePrimarySlot(Node)) : nullptr;
+}
+
+bool USGDialogueSubsystem::IsAvailableOption(int32 Slot, const FSGStoryState& State) const
+{
+	return Compiled.EvalConditions(Slot, State) && Compiled.EvalChecks(Slot, State);
+}
+
+FSGDialogueRowHandle USGDialogueSubsystem::MakeHandle(int32 Slot) const
+{
+	FSGDialogueRowHandle Handle;
+	Handle.Slot = Slot;
+	Handle.Serial = Compiled.GetSerial();
+	return Handle;
+}
+
 bool USGDialogueSubsystem::GetDecisionOptions(FName DecisionId, const FSGStoryState& State, TArray<FSGDialogueDecisionRow>& OutOptions) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_EvalOptions);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
 	OutOptions.Reset();
 
-	TArray<FSGDialogueDecisionRow> Rows;
-	if (!GetRowsByNarrativeId(DecisionId, Rows))
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE)
 	{
 		return false;
 	}
 
-	for (const FSGDialogueDecisionRow& Row : Rows)
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
 	{
-		if (!Row.type.Equals(TEXT("DECISION_OPTION"), ESearchCase::IgnoreCase))
+		if (IsAvailableOption(Slot, State))
 		{
-			continue;
+			Compiled.MaterializeRow(Slot, OutOptions.AddDefaulted_GetRef());
 		}
+	}
 
-		if (!AreConditionsMet(Row, State))
-		{
-			continue;
-		}
+	FSGNarrativeTrace::DecisionShown(TraceStart, DecisionId, Compiled.GetNodeOptionSlots(Node).Num(), OutOptions.Num());
+	return OutOptions.Num() > 0;
+}
+
+bool USGDialogueSubsystem::GetDecisionOptionRows(FName DecisionId, const FSGStoryState& State, TArray<const FSGDialogueRowData*>& OutOptions) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_EvalOptions);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
+	OutOptions.Reset();
 
-		if (!AreChecksMet(Row, State))
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE)
+	{
+		return false;
+	}
+
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
+	{
+		if (IsAvailableOption(Slot, State))
 		{
-			continue;
+			OutOptions.Add(&Compiled.GetRow(Slot));
 		}
-
-		OutOptions.Add(Row);
 	}
 
+	FSGNarrativeTrace::DecisionShown(TraceStart, DecisionId, Compiled.GetNodeOptionSlots(Node).Num(), OutOptions.Num());
 	return OutOptions.Num() > 0;
 }
 
-bool USGDialogueSubsystem::AreConditionsMet(const FSGDialogueDecisionRow& Row, const FSGStoryState& State) const
+void USGDialogueSubsystem::ResetWatches()
 {
-	TArray<FString> Conds;
-	ParseStringArrayJson(Row.conditions, Conds);
+	WatchedNodes.Init(false, Compiled.NumNodes());
+	OptionAvailable.Init(false, Compiled.NumRows());
 
-	for (const FString& Raw : Conds)
+	for (const FName Id : WatchedDecisions)
 	{
-		const FString Trim = Raw.TrimStartAndEnd();
-		if (Trim.IsEmpty())
+		const int32 Node = Compiled.FindNode(Id);
+		if (Node != INDEX_NONE)
 		{
-			continue;
+			WatchedNodes[Node] = true;
 		}
+	}
+}
 
-		const bool bNegated = Trim.StartsWith(TEXT("!"));
-		const FString FlagStr = bNegated ? Trim.Mid(1) : Trim;
-		const FName Flag(*FlagStr);
+void USGDialogueSubsystem::WatchDecision(FName DecisionId, const FSGStoryState& State)
+{
+	if (WatchedNodes.Num() != Compiled.NumNodes())
+	{
+		ResetWatches();
+	}
 
-		const bool bHas = State.Flags.Contains(Flag);
-		if (!bNegated && !bHas)
-		{
-			return false;
-		}
-		if (bNegated && bHas)
-		{
-			return false;
-		}
+	WatchedDecisions.AddUnique(DecisionId);
+
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE)
+	{
+		return;
 	}
 
-	return true;
+	WatchedNodes[Node] = true;
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
+	{
+		OptionAvailable[Slot] = IsAvailableOption(Slot, State);
+	}
 }
 
-bool USGDialogueSubsystem::AreChecksMet(const FSGDialogueDecisionRow& Row, const FSGStoryState& State) const
+void USGDialogueSubsystem::UnwatchDecision(FName DecisionId)
 {
-	TArray<FString> Checks;
-	ParseStringArrayJson(Row.checks, Checks);
+	WatchedDecisions.Remove(DecisionId);
 
-	for (const FString& Expr : Checks)
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node != INDEX_NONE && WatchedNodes.IsValidIndex(Node))
 	{
-		if (!EvalSimpleCheck(Expr, State))
-		{
-			return false;
-		}
+		WatchedNodes[Node] = false;
 	}
-
-	return true;
 }
 
-void USGDialogueSubsystem::ApplyRowEffects(const FSGDialogueDecisionRow& Row, FSGStoryState& State) const
+bool USGDialogueSubsystem::UpdateWatchedOption(int32 Slot, const FSGStoryState& State)
 {
-	// 1) Set flags
+	const bool bAvailable = IsAvailableOption(Slot, State);
+	if (OptionAvailable[Slot] == bAvailable)
 	{
-		TArray<FString> Flags;
-		ParseStringArrayJson(Row.set_flags, Flags);
-		for (const FString& F : Flags)
-		{
-			const FString Trim = F.TrimStartAndEnd();
-			if (!Trim.IsEmpty())
-			{
-				State.Flags.Add(FName(*Trim));
-			}
-		}
+		return false;
 	}
 
-	// 2) Grants JSON object
-	const FString GrantsTrim = Row.grants.TrimStartAndEnd();
-	if (GrantsTrim.IsEmpty() || GrantsTrim == TEXT("{}"))
+	OptionAvailable[Slot] = bAvailable;
+	return true;
+}
+
+void USGDialogueSubsystem::RefreshWatchedDecisions(FSGStoryState& State)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_EvalOptions);
+
+	// A Reload may have registered keys this state still holds by name.
+	if (bAdoptKeys)
 	{
-		return;
+		bAdoptKeys = false;
+		State.AdoptRegisteredKeys();
 	}
 
-	TSharedPtr<FJsonObject> RootObj;
-	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(GrantsTrim);
-	if (!FJsonSerializer::Deserialize(Reader, RootObj) || !RootObj.IsValid())
+	FSGStoryStateChanges Changes;
+	State.TakeChanges(Changes);
+
+	if (WatchedDecisions.Num() == 0 || (Changes.IsEmpty() && !bWatchesStale))
 	{
-		// If parsing fails, we intentionally do nothing.
 		return;
 	}
 
-	auto ApplyDeltaObject = [&](const TCHAR* FieldName)
+	TArray<int32, TInlineAllocator<8>> ChangedNodes;
+
+	if (bWatchesStale || Changes.bAll)
 	{
-		const TSharedPtr<FJsonObject>* ObjPtr = nullptr;
-		if (RootObj->TryGetObjectField(FieldName, ObjPtr) && ObjPtr && ObjPtr->IsValid())
+		// 1a) New index or replaced state: every watched option; after a reload every decision is reported.
+		const bool bReportAll = bWatchesStale;
+		bWatchesStale = false;
+
+		for (const FName Id : WatchedDecisions)
 		{
-			for (const auto& Pair : (*ObjPtr)->Values)
+			const int32 Node = Compiled.FindNode(Id);
+			if (Node == INDEX_NONE)
 			{
-				const FString Key = Pair.Key;
-				const FString DeltaStr = Pair.Value.IsValid() ? Pair.Value->AsString() : TEXT("0");
-				const int32 Delta = ParseDelta(DeltaStr);
-
-				const FName KName(*Key);
-				const int32 Current = State.Ints.Contains(KName) ? State.Ints[KName] : 0;
-				State.Ints.Add(KName, Current + Delta);
+				continue;
 			}
-		}
-	};
 
-	ApplyDeltaObject(TEXT("rep"));
-	ApplyDeltaObject(TEXT("trust"));
+			bool bChanged = bReportAll;
+			for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
+			{
+				bChanged |= UpdateWatchedOption(Slot, State);
+			}
 
-	// xp: number or string
-	if (RootObj->HasField(TEXT("xp")))
+			if (bChanged)
+			{
+				ChangedNodes.AddUnique(Node);
+			}
+		}
+	}
+	else
 	{
-		int32 XpDelta = 0;
-		const TSharedPtr<FJsonValue> V = RootObj->TryGetField(TEXT("xp"));
-		if (V.IsValid())
+		// 1b) Only rows that read a changed key, and of those only options of watched decisions.
+		auto Visit = [this, &State, &ChangedNodes](TConstArrayView<int32> Readers)
 		{
-			if (V->Type == EJson::Number)
+			for (const int32 Slot : Readers)
 			{
-				XpDelta = (int32)V->AsNumber();
+				const int32 Node = Compiled.GetRowNode(Slot);
+				if (WatchedNodes[Node]
+					&& Compiled.GetRowType(Slot) == ESGDialogueRowType::DecisionOption
+					&& UpdateWatchedOption(Slot, State))
+				{
+					ChangedNodes.AddUnique(Node);
+				}
 			}
-			else if (V->Type == EJson::String)
+		};
+
+		for (int32 Word = 0; Word < Changes.FlagWords.Num(); ++Word)
+		{
+			uint32 Bits = Changes.FlagWords[Word];
+			while (Bits != 0)
 			{
-				XpDelta = ParseDelta(V->AsString());
+				Visit(Compiled.GetFlagReaders(Word * 32 + FMath::CountTrailingZeros(Bits)));
+				Bits &= Bits - 1;
 			}
 		}
 
-		if (XpDelta != 0)
+		for (int32 Word = 0; Word < Changes.IntWords.Num(); ++Word)
 		{
-			const FName Key(TEXT("xp"));
-			const int32 Current = State.Ints.Contains(Key) ? State.Ints[Key] : 0;
-			State.Ints.Add(Key, Current + XpDelta);
+			uint32 Bits = Changes.IntWords[Word];
+			while (Bits != 0)
+			{
+				Visit(Compiled.GetIntReaders(Word * 32 + FMath::CountTrailingZeros(Bits)));
+				Bits &= Bits - 1;
+			}
 		}
 	}
 
-	// item: string or array. We store as counter ints: item_<name> += 1
-	if (RootObj->HasField(TEXT("item")))
+	// 2) Notify once every cache is updated, so handlers see a consistent view.
+	for (const int32 Node : ChangedNodes)
 	{
-		const TSharedPtr<FJsonValue> V = RootObj->TryGetField(TEXT("item"));
-		if (V.IsValid())
-		{
-			auto AddItemCounter = [&](const FString& ItemName)
-			{
-				const FString TrimItem = ItemName.TrimStartAndEnd();
-				if (TrimItem.IsEmpty()) return;
+		OnDecisionOptionsChanged.Broadcast(Compiled.GetNodeId(Node));
+	}
+}
 
-				const FString KeyStr = FString::Printf(TEXT("item_%s"), *TrimItem);
-				const FName Key(*KeyStr);
-				const int32 Current = State.Ints.Contains(Key) ? State.Ints[Key] : 0;
-				State.Ints.Add(Key, Current + 1);
-			};
+bool USGDialogueSubsystem::GetWatchedOptionHandles(FName DecisionId, TArray<FSGDialogueRowHandle>& OutHandles) const
+{
+	OutHandles.Reset();
 
-			if (V->Type == EJson::String)
-			{
-				AddItemCounter(V->AsString());
-			}
-			else if (V->Type == EJson::Array)
-			{
-				const TArray<TSharedPtr<FJsonValue>> Arr = V->AsArray();
-				for (const TSharedPtr<FJsonValue>& Elem : Arr)
-				{
-					if (Elem.IsValid())
-					{
-						AddItemCounter(Elem->AsString());
-					}
-				}
-			}
-		}
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE || bWatchesStale || !WatchedNodes.IsValidIndex(Node) || !WatchedNodes[Node])
+	{
+		return false;
 	}
 
-	// Any other numeric top-level keys: mirror into Ints.
-	for (const auto& Pair : RootObj->Values)
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
 	{
-		const FString Key = Pair.Key;
-		if (Key == TEXT("rep") || Key == TEXT("trust") || Key == TEXT("xp") || Key == TEXT("item"))
+		if (OptionAvailable[Slot])
 		{
-			continue;
+			OutHandles.Add(MakeHandle(Slot));
 		}
+	}
+	return true;
+}
 
-		const TSharedPtr<FJsonValue> V = Pair.Value;
-		if (!V.IsValid()) continue;
+bool USGDialogueSubsystem::HasDecisionOptions(FName DecisionId, const FSGStoryState& State) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_EvalOptions);
 
-		if (V->Type == EJson::Number)
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE)
+	{
+		return false;
+	}
+
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
+	{
+		if (IsAvailableOption(Slot, State))
 		{
-			const int32 Delta = (int32)V->AsNumber();
-			const FName KName(*Key);
-			const int32 Current = State.Ints.Contains(KName) ? State.Ints[KName] : 0;
-			State.Ints.Add(KName, Current + Delta);
+			return true;
 		}
-		else if (V->Type == EJson::String)
+	}
+	return false;
+}
+
+bool USGDialogueSubsystem::GetDecisionOptionHandles(FName DecisionId, const FSGStoryState& State, TArray<FSGDialogueRowHandle>& OutHandles) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_EvalOptions);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
+	OutHandles.Reset();
+
+	const int32 Node = Compiled.FindNode(DecisionId);
+	if (Node == INDEX_NONE)
+	{
+		return false;
+	}
+
+	for (const int32 Slot : Compiled.GetNodeOptionSlots(Node))
+	{
+		if (IsAvailableOption(Slot, State))
 		{
-			const int32 Delta = ParseDelta(V->AsString());
-			if (Delta != 0)
-			{
-				const FName KName(*Key);
-				const int32 Current = State.Ints.Contains(KName) ? State.Ints[KName] : 0;
-				State.Ints.Add(KName, Current + Delta);
-			}
+			OutHandles.Add(MakeHandle(Slot));
 		}
 	}
+
+	FSGNarrativeTrace::DecisionShown(TraceStart, DecisionId, Compiled.GetNodeOptionSlots(Node).Num(), OutHandles.Num());
+	return OutHandles.Num() > 0;
 }
 
-bool USGDialogueSubsystem::ApplyRowAndGetNext(const FSGDialogueDecisionRow& Row, FSGStoryState& State, FName& OutNextId) const
+void USGDialogueSubsystem::PrefetchFromNode(FName Id)
 {
-	ApplyRowEffects(Row, State);
-	OutNextId = Row.next;
-	return !OutNextId.IsNone();
+	const int32 Node = Compiled.FindNode(Id);
+	if (Node == INDEX_NONE)
+	{
+		return;
+	}
+
+	Prefetcher.Prefetch(Compiled, Node);
 }
 
-void USGDialogueSubsystem::ParseStringArrayJson(const FString& JsonLikeArray, TArray<FString>& Out)
+bool USGDialogueSubsystem::QueryRowHandles(const FString& Quest, const FString& Hub, const FString& Speaker, TArray<FSGDialogueRowHandle>& OutHandles) const
 {
-	Out.Reset();
+	OutHandles.Reset();
 
-	const FString Trim = JsonLikeArray.TrimStartAndEnd();
-	if (Trim.IsEmpty() || Trim == TEXT("[]"))
+	FSGDialogueQuery Query;
+	if (!Quest.IsEmpty())
 	{
-		return;
+		Query.Quest(Quest);
+	}
+	if (!Hub.IsEmpty())
+	{
+		Query.Hub(Hub);
+	}
+	if (!Speaker.IsEmpty())
+	{
+		Query.Speaker(Speaker);
 	}
 
-	// First try: strict JSON parse
+	TArray<int32> Slots;
+	Compiled.Query(Query, Slots);
+
+	OutHandles.Reserve(Slots.Num());
+	for (const int32 Slot : Slots)
 	{
-		TSharedPtr<FJsonValue> RootValue;
-		const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Trim);
-		if (FJsonSerializer::Deserialize(Reader, RootValue) && RootValue.IsValid())
-		{
-			const TArray<TSharedPtr<FJsonValue>>* Arr = nullptr;
-			if (RootValue->TryGetArray(Arr) && Arr)
-			{
-				for (const TSharedPtr<FJsonValue>& V : *Arr)
-				{
-					if (V.IsValid())
-					{
-						Out.Add(V->AsString());
-					}
-				}
-				return;
-			}
-		}
+		OutHandles.Add(MakeHandle(Slot));
 	}
+	return OutHandles.Num() > 0;
+}
 
-	// Fallback: naive split for mildly broken arrays
-	FString Inner = Trim;
-	Inner.RemoveFromStart(TEXT("["));
-	Inner.RemoveFromEnd(TEXT("]"));
+bool USGDialogueSubsystem::GetNodeRowHandle(FName Id, FSGDialogueRowHandle& OutHandle) const
+{
+	OutHandle = FSGDialogueRowHandle();
 
-	TArray<FString> Parts;
-	Inner.ParseIntoArray(Parts, TEXT(","), true);
-	for (FString P : Parts)
+	const int32 Node = Compiled.FindNode(Id);
+	if (Node == INDEX_NONE)
 	{
-		P = P.TrimStartAndEnd();
-		P = P.Replace(TEXT("\""), TEXT(""));
-		if (!P.IsEmpty())
-		{
-			Out.Add(P);
-		}
+		return false;
+	}
+
+	OutHandle = MakeHandle(Compiled.GetNodePrimarySlot(Node));
+	return true;
+}
+
+bool USGDialogueSubsystem::GetRowByHandle(const FSGDialogueRowHandle& Handle, FSGDialogueDecisionRow& OutRow) const
+{
+	if (!ResolveHandle(Handle))
+	{
+		return false;
+	}
+
+	Compiled.MaterializeRow(Handle.Slot, OutRow);
+	return true;
+}
+
+const FSGDialogueRowData* USGDialogueSubsystem::ResolveHandle(const FSGDialogueRowHandle& Handle) const
+{
+	if (Handle.Serial == Compiled.GetSerial() && Compiled.IsValidSlot(Handle.Slot))
+	{
+		return &Compiled.GetRow(Handle.Slot);
 	}
+	return nullptr;
 }
 
-bool USGDialogueSubsystem::EvalSimpleCheck(const FString& Expr, const FSGStoryState& State)
+ESGDialogueRowType USGDialogueSubsystem::GetNodeType(FName Id) const
 {
-	// Supports: key>=N, key<=N, key==N, key!=N, key>N, key<N
-	FString Key, Op, NumStr;
-	const FString E = Expr.TrimStartAndEnd();
+	const int32 Node = Compiled.FindNode(Id);
+	return Node != INDEX_NONE ? Compiled.GetRowType(Compiled.GetNodePrimarySlot(Node)) : ESGDialogueRowType::Unknown;
+}
 
-	auto Extract = [&](const FString& InOp) -> bool
+bool USGDialogueSubsystem::ApplyRowAndGetNextNode(const FSGDialogueRowHandle& Row, FSGStoryState& State, FSGDialogueRowHandle& OutNextNode) const
+{
+	OutNextNode = FSGDialogueRowHandle();
+
+	if (!ResolveHandle(Row))
 	{
-		const int32 Idx = E.Find(InOp);
-		if (Idx == INDEX_NONE) return false;
-		Key = E.Left(Idx).TrimStartAndEnd();
-		Op = InOp;
-		NumStr = E.Mid(Idx + InOp.Len()).TrimStartAndEnd();
-		return true;
-	};
+		return false;
+	}
 
-	if (!(Extract(TEXT(">=")) || Extract(TEXT("<=")) || Extract(TEXT("==")) || Extract(TEXT("!=")) || Extract(TEXT(">")) || Extract(TEXT("<"))))
+	ApplySlot(Row.Slot, State);
+
+	const int32 NextNode = Compiled.GetNextNode(Row.Slot);
+	if (NextNode == INDEX_NONE)
 	{
-		// Unknown expression; be permissive by default.
-		return true;
+		return false;
 	}
 
-	const int32 N = ParseDelta(NumStr);
-	const FName KName(*Key);
-	const int32 Current = State.Ints.Contains(KName) ? State.Ints[KName] : 0;
+	OutNextNode = MakeHandle(Compiled.GetNodePrimarySlot(NextNode));
+	return true;
+}
+
+bool USGDialogueSubsystem::ApplyRowJournaled(const FSGDialogueRowHandle& Row, FSGStoryState& State, FSGStoryJournal& Journal) const
+{
+	if (!ResolveHandle(Row))
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_ApplyEffects);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
+	FSGStoryJournalEntry Entry;
+	Compiled.ApplyEffects(Row.Slot, State, Entry);
+	Journal.Add(MoveTemp(Entry));
+
+	const FSGDialogueRowData& Data = Compiled.GetRow(Row.Slot);
+	FSGNarrativeTrace::RowApplied(TraceStart, Data.id, Data.option_key.View());
+	return true;
+}
+
+bool USGDialogueSubsystem::PreviewRowEffects(const FSGDialogueRowHandle& Row, const FSGStoryState& State, FSGStoryState& OutPreview) const
+{
+	if (!ResolveHandle(Row))
+	{
+		return false;
+	}
 
-	if (Op == TEXT(">=")) return Current >= N;
-	if (Op == TEXT("<=")) return Current <= N;
-	if (Op == TEXT("==")) return Current == N;
-	if (Op == TEXT("!=")) return Current != N;
-	if (Op == TEXT(">")) return Current > N;
-	if (Op == TEXT("<")) return Current < N;
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_ApplyEffects);
 
+	// The copy shares every chunk with State; applying copies only what the effects touch.
+	OutPreview = State;
+	Compiled.ApplyEffects(Row.Slot, OutPreview);
 	return true;
 }
 
-int32 USGDialogueSubsystem::ParseDelta(const FString& DeltaStr)
+bool USGDialogueSubsystem::AreConditionsMet(const FSGDialogueDecisionRow& Row, const FSGStoryState& State) const
+{
+	const int32 Slot = Compiled.ResolveSlot(Row);
+	if (Slot != INDEX_NONE)
+	{
+		return Compiled.EvalConditions(Slot, State);
+	}
+
+	return FSGCompiledDialogue::EvalConditionsUncompiled(Row, State);
+}
+
+bool USGDialogueSubsystem::AreChecksMet(const FSGDialogueDecisionRow& Row, const FSGStoryState& State) const
 {
-	FString S = DeltaStr.TrimStartAndEnd();
-	S = S.Replace(TEXT("−"), TEXT("-")); // unicode minus
-	return FCString::Atoi(*S);
+	const int32 Slot = Compiled.ResolveSlot(Row);
+	if (Slot != INDEX_NONE)
+	{
+		return Compiled.EvalChecks(Slot, State);
+	}
+
+	return FSGCompiledDialogue::EvalChecksUncompiled(Row, State);
+}
+
+void USGDialogueSubsystem::ApplyRowEffects(const FSGDialogueDecisionRow& Row, FSGStoryState& State) const
+{
+	const int32 Slot = Compiled.ResolveSlot(Row);
+	if (Slot != INDEX_NONE)
+	{
+		ApplySlot(Slot, State);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_ApplyEffects);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
+	FSGCompiledDialogue::ApplyEffectsUncompiled(Row, State);
+
+	FSGNarrativeTrace::RowApplied(TraceStart, Row.id, Row.option_key);
+}
+
+void USGDialogueSubsystem::ApplySlot(int32 Slot, FSGStoryState& State) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_ApplyEffects);
+	const uint64 TraceStart = FSGNarrativeTrace::Begin();
+
+	Compiled.ApplyEffects(Slot, State);
+
+	const FSGDialogueRowData& Data = Compiled.GetRow(Slot);
+	FSGNarrativeTrace::RowApplied(TraceStart, Data.id, Data.option_key.View());
+}
+
+bool USGDialogueSubsystem::ApplyRowAndGetNext(const FSGDialogueDecisionRow& Row, FSGStoryState& State, FName& OutNextId) const
+{
+	ApplyRowEffects(Row, State);
+	OutNextId = Row.next;
+	return !OutNextId.IsNone();
 }
@@ -0,0 +1,72 @@
+#include "SGNarrativeAsync.h"
+
+#include "Async/Async.h"
+#include "Engine/AssetManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void FSGNarrativeAsync::LoadTable(const TSoftObjectPtr<UDataTable>& Table, FOnTableLoaded OnLoaded)
+{
+	if (Table.IsNull())
+	{
+		OnLoaded(nullptr);
+		return;
+	}
+
+	if (UDataTable* Loaded = Table.Get())
+	{
+		OnLoaded(Loaded);
+		return;
+	}
+
+	struct FRequest
+	{
+		FOnTableLoaded OnLoaded;
+		bool bDone = false;
+
+		void Complete(UDataTable* Loaded)
+		{
+			if (!bDone)
+			{
+				bDone = true;
+				OnLoaded(Loaded);
+			}
+		}
+	};
+
+	const FSoftObjectPath Path = Table.ToSoftObjectPath();
+	TSharedRef<FRequest> Request = MakeShared<FRequest>();
+	Request->OnLoaded = MoveTemp(OnLoaded);
+
+	const TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Path, FStreamableDelegate::CreateLambda([Path, Request]()
+	{
+		Request->Complete(Cast<UDataTable>(Path.ResolveObject()));
+	}));
+
+	// No handle means the request never started (bad path); report it like a missing table.
+	if (!Handle.IsValid())
+	{
+		Request->Complete(nullptr);
+	}
+}
+
+void FSGNarrativeAsync::Run(TUniqueFunction<void()>&& Work, TUniqueFunction<void()>&& Finish)
+{
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Work = MoveTemp(Work), Finish = MoveTemp(Finish)]() mutable
+	{
+		Work();
+		AsyncTask(ENamedThreads::GameThread, MoveTemp(Finish));
+	});
+}
+
+bool FSGNarrativeAsync::LoadProjectFile(const FString& RelPathIn, FString& OutText)
+{
+	const FString RelPath = RelPathIn.TrimStartAndEnd();
+	if (RelPath.IsEmpty())
+	{
+		return false;
+	}
+
+	const FString AbsPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), RelPath));
+	return FFileHelper::LoadFileToString(OutText, *AbsPath);
+}
@@ -0,0 +1,504 @@
+#include "SGNarrativeDatabase.h"
+#include "SGDialogueTypes.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGQuestSubsystem.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+static_assert(sizeof(TCHAR) == 2, "SGNarrative databases store strings as UTF-16 and read them in place.");
+
+namespace
+{
+	FCriticalSection GProjectDatabaseLock;
+	TSharedPtr<const FSGNarrativeDatabase> GProjectDatabase;
+	bool GProjectDatabaseMounted = false;
+
+	/** Section cursor that refuses to read past the end of the section. */
+	struct FSectionReader
+	{
+		const uint8* Ptr;
+		uint64 Remaining;
+
+		template <typename T>
+		const T* Take(uint64 Count)
+		{
+			if (Count > Remaining / sizeof(T))
+			{
+				return nullptr;
+			}
+			const uint64 Bytes = Count * sizeof(T);
+			const T* Result = reinterpret_cast<const T*>(Ptr);
+			Ptr += Bytes;
+			Remaining -= Bytes;
+			return Result;
+		}
+	};
+
+	bool PropertyFitsField(const FProperty* Property, ESGNarrativeDbField Kind)
+	{
+		switch (Kind)
+		{
+		case ESGNarrativeDbField::String:
+			return Property->IsA<FStrProperty>();
+		case ESGNarrativeDbField::Name:
+			return Property->IsA<FNameProperty>();
+		case ESGNarrativeDbField::Int:
+			return Property->IsA<FIntProperty>();
+		case ESGNarrativeDbField::Float:
+			return Property->IsA<FFloatProperty>();
+		case ESGNarrativeDbField::Bool:
+			return Property->IsA<FBoolProperty>();
+		case ESGNarrativeDbField::StringList:
+		{
+			const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Property);
+			return ArrayProp && ArrayProp->Inner->IsA<FStrProperty>();
+		}
+		}
+		return false;
+	}
+}
+
+uint32 FSGNarrativeDatabase::HashKey(FStringView Key)
+{
+	uint32 Hash = 2166136261u;
+	for (const TCHAR Char : Key)
+	{
+		Hash ^= (uint32)FChar::ToLower(Char);
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+FSGNarrativeDatabase::~FSGNarrativeDatabase()
+{
+	// The region must be unmapped before its file handle closes.
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+TSharedPtr<const FSGNarrativeDatabase> FSGNarrativeDatabase::Mount(const FString& AbsPath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*AbsPath))
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FSGNarrativeDatabase> Database = MakeShareable(new FSGNarrativeDatabase());
+
+	Database->MappedFile.Reset(PlatformFile.OpenMapped(*AbsPath));
+	if (Database->MappedFile.IsValid())
+	{
+		Database->MappedRegion.Reset(Database->MappedFile->MapRegion(0, Database->MappedFile->GetFileSize()));
+	}
+
+	bool bOk = false;
+	if (Database->MappedRegion.IsValid())
+	{
+		bOk = Database->Init(Database->MappedRegion->GetMappedPtr(), (uint64)Database->MappedRegion->GetMappedSize());
+	}
+	else
+	{
+		// Platforms (or pak files) without mapping support: one read, still no parse.
+		Database->MappedFile.Reset();
+		if (FFileHelper::LoadFileToArray(Database->Loaded, *AbsPath))
+		{
+			bOk = Database->Init(Database->Loaded.GetData(), (uint64)Database->Loaded.Num());
+		}
+	}
+
+	if (!bOk)
+	{
+		UE_LOG(LogSGNarrative, Warning, TEXT("Narrative database %s is invalid or from another version; falling back to source tables."), *AbsPath);
+		return nullptr;
+	}
+
+	UE_LOG(LogSGNarrative, Log, TEXT("Mounted narrative database %s (%llu bytes, %s)."), *AbsPath, Database->Size,
+		Database->MappedRegion.IsValid() ? TEXT("mapped") : TEXT("loaded"));
+	return Database;
+}
+
+TSharedPtr<const FSGNarrativeDatabase> FSGNarrativeDatabase::GetProjectDatabase()
+{
+	FScopeLock Lock(&GProjectDatabaseLock);
+	if (!GProjectDatabaseMounted)
+	{
+		GProjectDatabaseMounted = true;
+
+		const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+		FString RelPath = Settings ? Settings->NarrativeDatabaseFile.TrimStartAndEnd() : FString();
+
+#if WITH_EDITOR
+		if (GIsEditor && Settings && !Settings->bUseNarrativeDatabaseInEditor)
+		{
+			RelPath.Reset();
+		}
+#endif
+
+		if (!RelPath.IsEmpty())
+		{
+			GProjectDatabase = Mount(FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), RelPath)));
+		}
+	}
+	return GProjectDatabase;
+}
+
+void FSGNarrativeDatabase::ResetProjectDatabase()
+{
+	FScopeLock Lock(&GProjectDatabaseLock);
+	GProjectDatabase.Reset();
+	GProjectDatabaseMounted = false;
+}
+
+bool FSGNarrativeDatabase::Init(const uint8* InData, uint64 InSize)
+{
+	if (!InData || InSize < sizeof(FSGNarrativeDbHeader))
+	{
+		return false;
+	}
+
+	const FSGNarrativeDbHeader* Header = reinterpret_cast<const FSGNarrativeDbHeader*>(InData);
+	if (Header->Magic != Magic || Header->Version != Version || Header->TotalSize != InSize)
+	{
+		return false;
+	}
+
+	FSectionReader Reader{ InData + sizeof(FSGNarrativeDbHeader), InSize - sizeof(FSGNarrativeDbHeader) };
+	const FSGNarrativeDbSection* Sections = Reader.Take<FSGNarrativeDbSection>(Header->NumSections);
+	if (!Sections)
+	{
+		return false;
+	}
+
+	Data = InData;
+	Size = InSize;
+
+	for (uint32 Idx = 0; Idx < Header->NumSections; ++Idx)
+	{
+		const FSGNarrativeDbSection& Section = Sections[Idx];
+		if (Section.Offset > InSize || Section.Size > InSize - Section.Offset || (Section.Offset & 7) != 0)
+		{
+			return false;
+		}
+
+		const uint8* SectionData = InData + Section.Offset;
+		FSectionReader Body{ SectionData, Section.Size };
+
+		switch ((ESGNarrativeDbSection)Section.Type)
+		{
+		case ESGNarrativeDbSection::Strings:
+		{
+			Strings = Body.Take<FSGNarrativeDbStrings>(1);
+			StringOffsets = Strings ? Body.Take<uint32>((uint64)Strings->NumStrings + 1) : nullptr;
+			if (!StringOffsets)
+			{
+				return false;
+			}
+			NumStringChars = StringOffsets[Strings->NumStrings];
+			StringChars = Body.Take<TCHAR>(NumStringChars);
+			if (!StringChars)
+			{
+				return false;
+			}
+			break;
+		}
+		case ESGNarrativeDbSection::Lists:
+			NumListWords = (uint32)(Section.Size / sizeof(uint32));
+			Lists = Body.Take<uint32>(NumListWords);
+			break;
+		case ESGNarrativeDbSection::DialoguePrograms:
+			Programs = TConstArrayView<FSGNarrativeDbProgram>(Body.Take<FSGNarrativeDbProgram>(Section.Size / sizeof(FSGNarrativeDbProgram)), (int32)(Section.Size / sizeof(FSGNarrativeDbProgram)));
+			break;
+		case ESGNarrativeDbSection::DialogueInstrs:
+			Instrs = TConstArrayView<FSGNarrativeDbInstr>(Body.Take<FSGNarrativeDbInstr>(Section.Size / sizeof(FSGNarrativeDbInstr)), (int32)(Section.Size / sizeof(FSGNarrativeDbInstr)));
+			break;
+		case ESGNarrativeDbSection::DialogueEffects:
+			Effects = TConstArrayView<FSGNarrativeDbInstr>(Body.Take<FSGNarrativeDbInstr>(Section.Size / sizeof(FSGNarrativeDbInstr)), (int32)(Section.Size / sizeof(FSGNarrativeDbInstr)));
+			break;
+		case ESGNarrativeDbSection::DialogueTable:
+		case ESGNarrativeDbSection::DecisionPromptTable:
+		case ESGNarrativeDbSection::DecisionOptionTable:
+		case ESGNarrativeDbSection::CinematicShotTable:
+		case ESGNarrativeDbSection::QuestSummaryTable:
+		case ESGNarrativeDbSection::QuestDetailsTable:
+		case ESGNarrativeDbSection::QuestBranchTable:
+			if (!InitTable((ESGNarrativeDbSection)Section.Type, SectionData, Section.Size))
+			{
+				return false;
+			}
+			break;
+		default:
+			// Unknown sections are skipped so newer cooks stay readable when only adding data.
+			break;
+		}
+	}
+
+	if (!Strings)
+	{
+		return false;
+	}
+
+	// Programs are only usable if every instruction range fits; otherwise drop them and recompile from rows.
+	const int32 NumDialogueRows = Tables[(int32)ESGNarrativeDbSection::DialogueTable].Num();
+	bool bProgramsOk = Programs.Num() == NumDialogueRows;
+	for (const FSGNarrativeDbProgram& Program : Programs)
+	{
+		bProgramsOk &= (uint64)Program.ConditionStart + Program.ConditionNum <= (uint64)Instrs.Num()
+			&& (uint64)Program.CheckStart + Program.CheckNum <= (uint64)Instrs.Num()
+			&& (uint64)Program.EffectStart + Program.EffectNum <= (uint64)Effects.Num();
+	}
+	if (!bProgramsOk)
+	{
+		Programs = TConstArrayView<FSGNarrativeDbProgram>();
+	}
+
+	// Bind each table to the row struct the cook wrote it from, so ReadRow is a walk over the bound cells.
+	const TPair<ESGNarrativeDbSection, const UScriptStruct*> RowStructs[] =
+	{
+		{ ESGNarrativeDbSection::DialogueTable, FSGDialogueDecisionRow::StaticStruct() },
+		{ ESGNarrativeDbSection::DecisionPromptTable, FSGDecisionPointRow::StaticStruct() },
+		{ ESGNarrativeDbSection::DecisionOptionTable, FSGDecisionPointRow::StaticStruct() },
+		{ ESGNarrativeDbSection::CinematicShotTable, FSGCinematicShotRow::StaticStruct() },
+		{ ESGNarrativeDbSection::QuestSummaryTable, FSGBranchQuestSummaryRow::StaticStruct() },
+		{ ESGNarrativeDbSection::QuestDetailsTable, FSGBranchQuestDetails::StaticStruct() },
+		{ ESGNarrativeDbSection::QuestBranchTable, FSGBranchQuestBranch::StaticStruct() },
+	};
+	for (const TPair<ESGNarrativeDbSection, const UScriptStruct*>& Pair : RowStructs)
+	{
+		FSGNarrativeDbTable& Table = Tables[(int32)Pair.Key];
+		if (Table.IsValid())
+		{
+			Table.BoundStruct = Pair.Value;
+			Table.BindFields(Pair.Value, Table.Bindings);
+		}
+	}
+
+	return true;
+}
+
+bool FSGNarrativeDatabase::InitTable(ESGNarrativeDbSection Type, const uint8* SectionData, uint64 SectionSize)
+{
+	FSectionReader Body{ SectionData, SectionSize };
+	FSGNarrativeDbTable& Table = Tables[(int32)Type];
+
+	const FSGNarrativeDbTableHeader* Header = Body.Take<FSGNarrativeDbTableHeader>(1);
+	if (!Header || (Header->NumBuckets & (Header->NumBuckets - 1)) != 0)
+	{
+		return false;
+	}
+
+	Table.FieldNames = Body.Take<uint32>(Header->NumFields);
+	Table.FieldKinds = Body.Take<uint32>(Header->NumFields);
+	Table.Cells = Body.Take<uint32>((uint64)Header->NumRows * Header->NumFields);
+	Table.Keys = Body.Take<FSGNarrativeDbKey>(Header->NumKeys);
+	Table.Buckets = Body.Take<uint32>(Header->NumBuckets);
+
+	if (!Table.FieldNames || !Table.FieldKinds || !Table.Cells || !Table.Keys || !Table.Buckets)
+	{
+		return false;
+	}
+
+	for (uint32 Idx = 0; Idx < Header->NumKeys; ++Idx)
+	{
+		const FSGNarrativeDbKey& Key = Table.Keys[Idx];
+		if ((uint64)Key.Start + Key.Num > Header->NumRows)
+		{
+			return false;
+		}
+	}
+
+	Table.Database = this;
+	Table.Header = Header;
+	return true;
+}
+
+FStringView FSGNarrativeDatabase::GetString(uint32 Id) const
+{
+	if (!Strings || Id >= Strings->NumStrings)
+	{
+		return FStringView();
+	}
+
+	const uint32 Start = StringOffsets[Id];
+	const uint32 End = StringOffsets[Id + 1];
+	if (Start > End || End > NumStringChars)
+	{
+		return FStringView();
+	}
+	return FStringView(StringChars + Start, (int32)(End - Start));
+}
+
+TConstArrayView<uint32> FSGNarrativeDatabase::GetList(uint32 Offset) const
+{
+	if (!Lists || Offset >= NumListWords)
+	{
+		return TConstArrayView<uint32>();
+	}
+
+	const uint32 Count = Lists[Offset];
+	if (Count > NumListWords - Offset - 1)
+	{
+		return TConstArrayView<uint32>();
+	}
+	return TConstArrayView<uint32>(Lists + Offset + 1, (int32)Count);
+}
+
+FSGRowRange FSGNarrativeDbTable::Find(FStringView Key) const
+{
+	FSGRowRange Range;
+	if (!Header || Header->NumBuckets == 0)
+	{
+		return Range;
+	}
+
+	const uint32 Hash = FSGNarrativeDatabase::HashKey(Key);
+	const uint32 Mask = Header->NumBuckets - 1;
+
+	// Linear probing; the cook keeps the load factor at or below one half.
+	for (uint32 Probe = 0; Probe < Header->NumBuckets; ++Probe)
+	{
+		const uint32 Entry = Buckets[(Hash + Probe) & Mask];
+		if (Entry == 0 || Entry > Header->NumKeys)
+		{
+			break;
+		}
+
+		const FSGNarrativeDbKey& Candidate = Keys[Entry - 1];
+		if (Candidate.Hash == Hash && Database->GetString(Candidate.Key).Equals(Key, ESearchCase::IgnoreCase))
+		{
+			Range.Start = (int32)Candidate.Start;
+			Range.Num = (int32)Candidate.Num;
+			break;
+		}
+	}
+	return Range;
+}
+
+FSGRowRange FSGNarrativeDbTable::Find(FName Key) const
+{
+	if (Key.IsNone())
+	{
+		return FSGRowRange();
+	}
+
+	FNameBuilder Builder(Key);
+	return Find(Builder.ToView());
+}
+
+int32 FSGNarrativeDbTable::FindField(FName FieldName) const
+{
+	if (!Header)
+	{
+		return INDEX_NONE;
+	}
+
+	FNameBuilder Builder(FieldName);
+	for (uint32 Field = 0; Field < Header->NumFields; ++Field)
+	{
+		if (Database->GetString(FieldNames[Field]).Equals(Builder.ToView(), ESearchCase::IgnoreCase))
+		{
+			return (int32)Field;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void FSGNarrativeDbTable::BindFields(const UScriptStruct* Struct, TArray<FFieldBinding>& OutBindings) const
+{
+	OutBindings.Reset();
+	if (!Header || !Struct)
+	{
+		return;
+	}
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		FProperty* Property = *It;
+		const int32 Field = FindField(Property->GetFName());
+		if (Field == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const ESGNarrativeDbField Kind = (ESGNarrativeDbField)FieldKinds[Field];
+		if (!PropertyFitsField(Property, Kind))
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("Narrative database: field '%s' (kind %u) does not fit %s::%s (%s); it is not read."),
+				*FString(Database->GetString(FieldNames[Field])), (uint32)Kind, *Struct->GetName(), *Property->GetName(), *Property->GetCPPType());
+			continue;
+		}
+
+		OutBindings.Add({ Property, Field, Kind });
+	}
+}
+
+void FSGNarrativeDbTable::ReadRow(int32 Index, const UScriptStruct* Struct, void* OutRow) const
+{
+	if (!Header || !Struct || !OutRow || Index < 0 || Index >= Num())
+	{
+		return;
+	}
+
+	const uint32* Row = Cells + (uint64)Index * Header->NumFields;
+	if (Struct == BoundStruct)
+	{
+		ReadCells(Row, Bindings, OutRow);
+		return;
+	}
+
+	// Not the struct the table was cooked from: bind for this call only.
+	TArray<FFieldBinding> CallBindings;
+	BindFields(Struct, CallBindings);
+	ReadCells(Row, CallBindings, OutRow);
+}
+
+void FSGNarrativeDbTable::ReadCells(const uint32* Row, TConstArrayView<FFieldBinding> RowBindings, void* OutRow) const
+{
+	for (const FFieldBinding& Binding : RowBindings)
+	{
+		void* Value = Binding.Property->ContainerPtrToValuePtr<void>(OutRow);
+		const uint32 Cell = Row[Binding.Field];
+
+		switch (Binding.Kind)
+		{
+		case ESGNarrativeDbField::String:
+			static_cast<FStrProperty*>(Binding.Property)->SetPropertyValue(Value, FString(Database->GetString(Cell)));
+			break;
+		case ESGNarrativeDbField::Name:
+		{
+			const FStringView Str = Database->GetString(Cell);
+			static_cast<FNameProperty*>(Binding.Property)->SetPropertyValue(Value, Str.IsEmpty() ? FName() : FName(Str));
+			break;
+		}
+		case ESGNarrativeDbField::Int:
+			static_cast<FIntProperty*>(Binding.Property)->SetPropertyValue(Value, (int32)Cell);
+			break;
+		case ESGNarrativeDbField::Float:
+		{
+			float Float = 0.0f;
+			FMemory::Memcpy(&Float, &Cell, sizeof(Float));
+			static_cast<FFloatProperty*>(Binding.Property)->SetPropertyValue(Value, Float);
+			break;
+		}
+		case ESGNarrativeDbField::Bool:
+			static_cast<FBoolProperty*>(Binding.Property)->SetPropertyValue(Value, Cell != 0);
+			break;
+		case ESGNarrativeDbField::StringList:
+		{
+			TArray<FString>& Out = *reinterpret_cast<TArray<FString>*>(Value);
+			const TConstArrayView<uint32> Ids = Database->GetList(Cell);
+			Out.Reset(Ids.Num());
+			for (const uint32 Id : Ids)
+			{
+				Out.Emplace(Database->GetString(Id));
+			}
+			break;
+		}
+		}
+	}
+}
@@ -1,4 +1,7 @@
 #include "Modules/ModuleManager.h"
+#include "SGNarrativeLog.h"
+
+DEFINE_LOG_CATEGORY(LogSGNarrative);
 
 class FSGNarrativeModule : public IModuleInterface
 {
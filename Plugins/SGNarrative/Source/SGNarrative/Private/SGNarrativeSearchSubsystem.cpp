@@ -0,0 +1,266 @@
+#include "SGNarrativeSearchSubsystem.h"
+#include "SGDecisionPointSubsystem.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
+
+#include "Engine/DataTable.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	const FName NAME_line_or_prompt(TEXT("line_or_prompt"));
+	const FName NAME_option_text(TEXT("option_text"));
+	const FName NAME_dialogue(TEXT("dialogue"));
+	const FName NAME_prompt_text(TEXT("prompt_text"));
+
+	void AddEntry(TArray<FSGNarrativeTextEntry>& Out, FName Row, FName Field, const FString& Text)
+	{
+		if (!Text.IsEmpty())
+		{
+			Out.Add(FSGNarrativeTextEntry{ Row, Field, Text });
+		}
+	}
+
+	void AddDecisionPoint(TArray<FSGNarrativeTextEntry>& Out, FName Row, const FSGDecisionPointRow& Data)
+	{
+		AddEntry(Out, Row, NAME_prompt_text, Data.prompt_text);
+		AddEntry(Out, Row, NAME_option_text, Data.option_text);
+	}
+
+	void RunSearch(const TArray<FString>& Args, bool bSubstring)
+	{
+		USGNarrativeSearchSubsystem* Search = GEngine ? GEngine->GetEngineSubsystem<USGNarrativeSearchSubsystem>() : nullptr;
+		if (!Search || Args.Num() == 0)
+		{
+			return;
+		}
+
+		const FString Query = FString::Join(Args, TEXT(" "));
+		const double Start = FPlatformTime::Seconds();
+
+		TArray<FSGNarrativeSearchHit> Hits;
+		if (bSubstring)
+		{
+			Search->FindSubstring(Query, 50, Hits);
+		}
+		else
+		{
+			Search->FindWords(Query, 50, Hits);
+		}
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrative search \"%s\": %d hits (max 50) in %.2f ms."), *Query, Hits.Num(), (FPlatformTime::Seconds() - Start) * 1000.0);
+		for (const FSGNarrativeSearchHit& Hit : Hits)
+		{
+			UE_LOG(LogSGNarrative, Display, TEXT("  [%s] %s.%s: %s"),
+				*UEnum::GetDisplayValueAsText(Hit.Source).ToString(), *Hit.Row.ToString(), *Hit.Field.ToString(), *Hit.Text);
+		}
+	}
+
+	FAutoConsoleCommand GSearchCommand(
+		TEXT("SGNarrative.Search"),
+		TEXT("Log narrative lines containing every given word."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) { RunSearch(Args, false); }));
+
+	FAutoConsoleCommand GSearchTextCommand(
+		TEXT("SGNarrative.SearchText"),
+		TEXT("Log narrative lines containing the given text."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) { RunSearch(Args, true); }));
+}
+
+void USGNarrativeSearchSubsystem::Deinitialize()
+{
+#if WITH_EDITOR
+	UnwatchTables();
+#endif
+
+	Index.Reset();
+	Super::Deinitialize();
+}
+
+void USGNarrativeSearchSubsystem::Reload()
+{
+	StaleSources = ~0u;
+	RefreshStale();
+}
+
+void USGNarrativeSearchSubsystem::FindWords(const FString& Query, int32 MaxHits, TArray<FSGNarrativeSearchHit>& OutHits)
+{
+	RefreshStale();
+	Index.FindWords(Query, OutHits, MaxHits);
+}
+
+void USGNarrativeSearchSubsystem::FindSubstring(const FString& Query, int32 MaxHits, TArray<FSGNarrativeSearchHit>& OutHits)
+{
+	RefreshStale();
+	Index.FindSubstring(Query, OutHits, MaxHits);
+}
+
+const FSGNarrativeTextIndex& USGNarrativeSearchSubsystem::GetIndex()
+{
+	RefreshStale();
+	return Index;
+}
+
+void USGNarrativeSearchSubsystem::RefreshStale()
+{
+	if (StaleSources == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_BuildIndex);
+
+	for (int32 SourceIdx = 0; SourceIdx < (int32)ESGNarrativeTextSource::Num; ++SourceIdx)
+	{
+		if ((StaleSources & (1u << SourceIdx)) == 0)
+		{
+			continue;
+		}
+
+		const ESGNarrativeTextSource Source = (ESGNarrativeTextSource)SourceIdx;
+
+		TArray<FSGNarrativeTextEntry> Entries;
+		UDataTable* Table = nullptr;
+		CollectEntries(Source, Entries, &Table);
+
+		const FSGNarrativeTextIndex::FUpdateStats Stats = Index.UpdateSource(Source, Entries);
+		UE_LOG(LogSGNarrative, Verbose, TEXT("Narrative search: %s +%d ~%d -%d lines."),
+			*UEnum::GetValueAsString(Source), Stats.Added, Stats.Changed, Stats.Removed);
+
+#if WITH_EDITOR
+		WatchTable(Source, Table);
+#endif
+	}
+
+	StaleSources = 0;
+	SET_MEMORY_STAT(STAT_SGNarrative_TextIndexMemory, Index.GetAllocatedSize());
+}
+
+void USGNarrativeSearchSubsystem::CollectEntries(ESGNarrativeTextSource Source, TArray<FSGNarrativeTextEntry>& OutEntries, UDataTable** OutTable)
+{
+	OutEntries.Reset();
+	if (OutTable)
+	{
+		*OutTable = nullptr;
+	}
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		return;
+	}
+
+	static const FString Context = TEXT("USGNarrativeSearchSubsystem::CollectEntries");
+	UDataTable* Table = nullptr;
+
+	switch (Source)
+	{
+	case ESGNarrativeTextSource::Dialogue:
+		Table = Settings->DialogueDecisionTable.LoadSynchronous();
+		if (Table)
+		{
+			Table->ForeachRow<FSGDialogueDecisionRow>(Context, [&OutEntries](const FName& Key, const FSGDialogueDecisionRow& Row)
+			{
+				AddEntry(OutEntries, Key, NAME_line_or_prompt, Row.line_or_prompt);
+				AddEntry(OutEntries, Key, NAME_option_text, Row.option_text);
+			});
+		}
+		break;
+
+	case ESGNarrativeTextSource::MainQuest:
+	case ESGNarrativeTextSource::OptionalPrompts:
+		Table = (Source == ESGNarrativeTextSource::MainQuest ? Settings->MainQuestDialogueTable : Settings->OptionalPromptsTable).LoadSynchronous();
+		if (Table)
+		{
+			Table->ForeachRow<FSGMainQuestLineRow>(Context, [&OutEntries](const FName& Key, const FSGMainQuestLineRow& Row)
+			{
+				AddEntry(OutEntries, Key, NAME_dialogue, Row.dialogue);
+			});
+		}
+		break;
+
+	case ESGNarrativeTextSource::DecisionPoints:
+		Table = Settings->DecisionPointsTable.LoadSynchronous();
+		if (Table)
+		{
+			Table->ForeachRow<FSGDecisionPointRow>(Context, [&OutEntries](const FName& Key, const FSGDecisionPointRow& Row)
+			{
+				AddDecisionPoint(OutEntries, Key, Row);
+			});
+		}
+		else if (!Settings->DecisionPointsJson.IsEmpty())
+		{
+			// Same fallback as USGDecisionPointSubsystem; rows are named dp_id / dp_id:option_key.
+			USGDecisionPointSubsystem::FIndex JsonIndex;
+			USGDecisionPointSubsystem::BuildIndexFromJson(Settings->DecisionPointsJson, JsonIndex);
+
+			for (const TPair<FString, FSGDecisionPointRow>& Pair : JsonIndex.PromptById)
+			{
+				AddDecisionPoint(OutEntries, FName(*Pair.Key), Pair.Value);
+			}
+			for (const TPair<FString, TArray<FSGDecisionPointRow>>& Pair : JsonIndex.OptionsById)
+			{
+				for (const FSGDecisionPointRow& Option : Pair.Value)
+				{
+					AddDecisionPoint(OutEntries, FName(*FString::Printf(TEXT("%s:%s"), *Pair.Key, *Option.option_key)), Option);
+				}
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (OutTable)
+	{
+		*OutTable = Table;
+	}
+}
+
+#if WITH_EDITOR
+void USGNarrativeSearchSubsystem::WatchTable(ESGNarrativeTextSource Source, UDataTable* Table)
+{
+	const int32 SourceIdx = (int32)Source;
+	if (WatchedTables[SourceIdx].Get() == Table)
+	{
+		return;
+	}
+
+	if (UDataTable* Previous = WatchedTables[SourceIdx].Get())
+	{
+		Previous->OnDataTableChanged().Remove(WatchHandles[SourceIdx]);
+	}
+
+	WatchedTables[SourceIdx] = Table;
+	WatchHandles[SourceIdx].Reset();
+
+	if (Table)
+	{
+		// Edits only mark the source; the next search re-reads it and diffs line by line.
+		TWeakObjectPtr<USGNarrativeSearchSubsystem> WeakThis(this);
+		WatchHandles[SourceIdx] = Table->OnDataTableChanged().AddLambda([WeakThis, SourceIdx]()
+		{
+			if (USGNarrativeSearchSubsystem* This = WeakThis.Get())
+			{
+				This->StaleSources |= 1u << SourceIdx;
+			}
+		});
+	}
+}
+
+void USGNarrativeSearchSubsystem::UnwatchTables()
+{
+	for (int32 SourceIdx = 0; SourceIdx < (int32)ESGNarrativeTextSource::Num; ++SourceIdx)
+	{
+		if (UDataTable* Table = WatchedTables[SourceIdx].Get())
+		{
+			Table->OnDataTableChanged().Remove(WatchHandles[SourceIdx]);
+		}
+		WatchedTables[SourceIdx].Reset();
+		WatchHandles[SourceIdx].Reset();
+	}
+}
+#endif
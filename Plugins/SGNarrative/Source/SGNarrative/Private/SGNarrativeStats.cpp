@@ -0,0 +1,76 @@
+#include "SGNarrativeStats.h"
+
+DEFINE_STAT(STAT_SGNarrative_BuildIndex);
+DEFINE_STAT(STAT_SGNarrative_EvalOptions);
+DEFINE_STAT(STAT_SGNarrative_ApplyEffects);
+DEFINE_STAT(STAT_SGNarrative_QuestJsonLoad);
+DEFINE_STAT(STAT_SGNarrative_CinematicsLookup);
+DEFINE_STAT(STAT_SGNarrative_PublishState);
+
+DEFINE_STAT(STAT_SGNarrative_DialogueIndexMemory);
+DEFINE_STAT(STAT_SGNarrative_StringPoolMemory);
+DEFINE_STAT(STAT_SGNarrative_CinematicsIndexMemory);
+DEFINE_STAT(STAT_SGNarrative_DecisionPointsIndexMemory);
+DEFINE_STAT(STAT_SGNarrative_QuestDetailsMemory);
+DEFINE_STAT(STAT_SGNarrative_TextIndexMemory);
+DEFINE_STAT(STAT_SGNarrative_PrefetchMemory);
+
+#if UE_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_DEFINE(SGNarrativeChannel)
+
+UE_TRACE_EVENT_BEGIN(SGNarrative, RowApplied)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, RowId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, OptionKey)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(SGNarrative, DecisionShown)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, DecisionId)
+	UE_TRACE_EVENT_FIELD(int32, NumOptions)
+	UE_TRACE_EVENT_FIELD(int32, NumAvailable)
+UE_TRACE_EVENT_END()
+
+void FSGNarrativeTrace::RowApplied(uint64 StartCycle, FName RowId, FStringView OptionKey)
+{
+	if (StartCycle == 0)
+	{
+		return;
+	}
+
+	const uint64 EndCycle = FPlatformTime::Cycles64();
+
+	TCHAR Id[NAME_SIZE];
+	const uint32 IdLen = RowId.ToString(Id);
+
+	UE_TRACE_LOG(SGNarrative, RowApplied, SGNarrativeChannel)
+		<< RowApplied.StartCycle(StartCycle)
+		<< RowApplied.EndCycle(EndCycle)
+		<< RowApplied.RowId(Id, IdLen)
+		<< RowApplied.OptionKey(OptionKey.GetData(), OptionKey.Len());
+}
+
+void FSGNarrativeTrace::DecisionShown(uint64 StartCycle, FName DecisionId, int32 NumOptions, int32 NumAvailable)
+{
+	if (StartCycle == 0)
+	{
+		return;
+	}
+
+	const uint64 EndCycle = FPlatformTime::Cycles64();
+
+	TCHAR Id[NAME_SIZE];
+	const uint32 IdLen = DecisionId.ToString(Id);
+
+	UE_TRACE_LOG(SGNarrative, DecisionShown, SGNarrativeChannel)
+		<< DecisionShown.StartCycle(StartCycle)
+		<< DecisionShown.EndCycle(EndCycle)
+		<< DecisionShown.DecisionId(Id, IdLen)
+		<< DecisionShown.NumOptions(NumOptions)
+		<< DecisionShown.NumAvailable(NumAvailable);
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "SGNarrativeStringPool.h"
+
+FStringView FSGNarrativeString::View() const
+{
+	return FSGNarrativeStringPool::Get().Resolve(*this);
+}
+
+FString FSGNarrativeString::ToString() const
+{
+	return FString(View());
+}
+
+FSGNarrativeStringPool& FSGNarrativeStringPool::Get()
+{
+	static FSGNarrativeStringPool Instance;
+	return Instance;
+}
+
+FSGNarrativeStringPool::FSGNarrativeStringPool()
+{
+	// Id 0 is the empty string, so default handles resolve to "".
+	AddView(FStringView(TEXT(""), 0));
+}
+
+FSGNarrativeString FSGNarrativeStringPool::Find(FStringView Str) const
+{
+	FSGNarrativeString Handle;
+	if (!Str.IsEmpty())
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const uint32* Found = Ids.Find(Str))
+		{
+			Handle.Id = *Found;
+		}
+	}
+	return Handle;
+}
+
+FSGNarrativeString FSGNarrativeStringPool::Intern(FStringView Str)
+{
+	// Most calls hit an existing string; only take the write lock to add one.
+	FSGNarrativeString Handle = Find(Str);
+	if (!Handle.IsEmpty() || Str.IsEmpty())
+	{
+		return Handle;
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const uint32* Found = Ids.Find(Str))
+	{
+		Handle.Id = *Found;
+		return Handle;
+	}
+
+	const FStringView Pooled(Store(Str), Str.Len());
+	Handle.Id = AddView(Pooled);
+	Ids.Add(Pooled, Handle.Id);
+	return Handle;
+}
+
+uint32 FSGNarrativeStringPool::AddView(FStringView View)
+{
+	const uint32 Id = NumViews.load(std::memory_order_relaxed);
+	const int32 Page = (int32)(Id / PageViews);
+	checkf(Page < MaxPages, TEXT("FSGNarrativeStringPool is full (%d strings)."), MaxPages * PageViews);
+
+	FStringView* Views = Pages[Page].load(std::memory_order_relaxed);
+	if (!Views)
+	{
+		Views = OwnedPages.Emplace_GetRef(MakeUnique<FStringView[]>(PageViews)).Get();
+		Pages[Page].store(Views, std::memory_order_relaxed);
+	}
+	Views[Id % PageViews] = View;
+
+	// Publishes the page pointer and the view to readers that see the new count.
+	NumViews.store(Id + 1, std::memory_order_release);
+	return Id;
+}
+
+FStringView FSGNarrativeStringPool::Resolve(FSGNarrativeString Handle) const
+{
+	if (Handle.Id >= NumViews.load(std::memory_order_acquire))
+	{
+		return FStringView();
+	}
+	return Pages[Handle.Id / PageViews].load(std::memory_order_relaxed)[Handle.Id % PageViews];
+}
+
+int32 FSGNarrativeStringPool::Num() const
+{
+	return (int32)NumViews.load(std::memory_order_acquire);
+}
+
+SIZE_T FSGNarrativeStringPool::GetAllocatedSize() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return BlockBytes + Blocks.GetAllocatedSize() + OwnedPages.Num() * PageViews * sizeof(FStringView) + OwnedPages.GetAllocatedSize() + Ids.GetAllocatedSize();
+}
+
+const TCHAR* FSGNarrativeStringPool::Store(FStringView Str)
+{
+	// Blocks are never reallocated, which is what keeps views (and map keys) stable.
+	const int32 Needed = Str.Len() + 1;
+
+	TCHAR* Out = nullptr;
+	if (Needed > BlockChars)
+	{
+		// Oversized: a block of its own, and the current block stays open for the next string.
+		Out = Blocks.Emplace_GetRef(MakeUnique<TCHAR[]>(Needed)).Get();
+		BlockBytes += Needed * sizeof(TCHAR);
+	}
+	else
+	{
+		if (Needed > BlockChars - BlockUsed)
+		{
+			Blocks.Emplace(MakeUnique<TCHAR[]>(BlockChars));
+			BlockBytes += BlockChars * sizeof(TCHAR);
+			BlockUsed = 0;
+			CurrentBlock = Blocks.Num() - 1;
+		}
+
+		Out = Blocks[CurrentBlock].Get() + BlockUsed;
+		BlockUsed += Needed;
+	}
+
+	FMemory::Memcpy(Out, Str.GetData(), Str.Len() * sizeof(TCHAR));
+	Out[Str.Len()] = TCHAR('\0');
+	return Out;
+}
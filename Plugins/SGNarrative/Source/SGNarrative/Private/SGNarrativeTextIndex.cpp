@@ -0,0 +1,394 @@
+#include "SGNarrativeTextIndex.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/Unique.h"
+#include "String/Find.h"
+
+namespace
+{
+	void InsertSorted(TArray<int32>& List, int32 DocId)
+	{
+		// New documents get the highest id unless a freed one is reused, so this is nearly always an append.
+		if (List.Num() == 0 || List.Last() < DocId)
+		{
+			List.Add(DocId);
+			return;
+		}
+
+		const int32 Idx = Algo::LowerBound(List, DocId);
+		if (!List.IsValidIndex(Idx) || List[Idx] != DocId)
+		{
+			List.Insert(DocId, Idx);
+		}
+	}
+
+	/** Remove DocId; true if the list is now empty. */
+	bool RemoveSorted(TArray<int32>& List, int32 DocId)
+	{
+		const int32 Idx = Algo::LowerBound(List, DocId);
+		if (List.IsValidIndex(Idx) && List[Idx] == DocId)
+		{
+			List.RemoveAt(Idx, EAllowShrinking::No);
+		}
+		return List.Num() == 0;
+	}
+
+	void SortUnique(TArray<FString>& Words)
+	{
+		Words.Sort();
+		for (int32 Idx = Words.Num() - 1; Idx > 0; --Idx)
+		{
+			if (Words[Idx] == Words[Idx - 1])
+			{
+				Words.RemoveAt(Idx, EAllowShrinking::No);
+			}
+		}
+	}
+}
+
+void FSGNarrativeTextIndex::Reset()
+{
+	Docs.Reset();
+	FreeDocs.Reset();
+	DocByKey.Reset();
+	WordPostings.Reset();
+	TrigramPostings.Reset();
+}
+
+FSGNarrativeTextIndex::FUpdateStats FSGNarrativeTextIndex::UpdateSource(ESGNarrativeTextSource Source, TConstArrayView<FSGNarrativeTextEntry> Entries)
+{
+	FUpdateStats Stats;
+
+	// 1) Add new lines and re-index edited ones; untouched lines keep their postings.
+	TSet<int32> Seen;
+	Seen.Reserve(Entries.Num());
+
+	for (const FSGNarrativeTextEntry& Entry : Entries)
+	{
+		if (const int32* Found = DocByKey.Find(FDocKey{ Source, Entry.Row, Entry.Field }))
+		{
+			Seen.Add(*Found);
+
+			FDoc& Doc = Docs[*Found];
+			if (Doc.Text.Equals(Entry.Text, ESearchCase::CaseSensitive))
+			{
+				continue;
+			}
+
+			UnindexDoc(*Found);
+			Doc.Text = Entry.Text;
+			IndexDoc(*Found);
+			++Stats.Changed;
+			continue;
+		}
+
+		Seen.Add(AddDoc(Source, Entry.Row, Entry.Field, Entry.Text));
+		++Stats.Added;
+	}
+
+	// 2) Drop lines of this source that are gone.
+	TArray<int32> Stale;
+	for (const TPair<FDocKey, int32>& Pair : DocByKey)
+	{
+		if (Pair.Key.Source == Source && !Seen.Contains(Pair.Value))
+		{
+			Stale.Add(Pair.Value);
+		}
+	}
+
+	for (const int32 DocId : Stale)
+	{
+		RemoveDoc(DocId);
+		++Stats.Removed;
+	}
+
+	return Stats;
+}
+
+int32 FSGNarrativeTextIndex::AddDoc(ESGNarrativeTextSource Source, FName Row, FName Field, const FString& Text)
+{
+	const int32 DocId = FreeDocs.Num() > 0 ? FreeDocs.Pop(EAllowShrinking::No) : Docs.AddDefaulted();
+
+	FDoc& Doc = Docs[DocId];
+	Doc.Source = Source;
+	Doc.Row = Row;
+	Doc.Field = Field;
+	Doc.Text = Text;
+	Doc.bLive = true;
+
+	DocByKey.Add(FDocKey{ Source, Row, Field }, DocId);
+	IndexDoc(DocId);
+	return DocId;
+}
+
+void FSGNarrativeTextIndex::RemoveDoc(int32 DocId)
+{
+	UnindexDoc(DocId);
+
+	FDoc& Doc = Docs[DocId];
+	DocByKey.Remove(FDocKey{ Doc.Source, Doc.Row, Doc.Field });
+	Doc = FDoc();
+	FreeDocs.Add(DocId);
+}
+
+void FSGNarrativeTextIndex::IndexDoc(int32 DocId)
+{
+	const FString& Text = Docs[DocId].Text;
+
+	TArray<FString> Words;
+	Tokenize(Text, Words);
+	SortUnique(Words);
+	for (FString& Word : Words)
+	{
+		InsertSorted(WordPostings.FindOrAdd(MoveTemp(Word)), DocId);
+	}
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(Text, Trigrams);
+	for (const uint64 Trigram : Trigrams)
+	{
+		InsertSorted(TrigramPostings.FindOrAdd(Trigram), DocId);
+	}
+}
+
+void FSGNarrativeTextIndex::UnindexDoc(int32 DocId)
+{
+	const FString& Text = Docs[DocId].Text;
+
+	TArray<FString> Words;
+	Tokenize(Text, Words);
+	SortUnique(Words);
+	for (const FString& Word : Words)
+	{
+		if (TArray<int32>* List = WordPostings.Find(Word))
+		{
+			if (RemoveSorted(*List, DocId))
+			{
+				WordPostings.Remove(Word);
+			}
+		}
+	}
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(Text, Trigrams);
+	for (const uint64 Trigram : Trigrams)
+	{
+		if (TArray<int32>* List = TrigramPostings.Find(Trigram))
+		{
+			if (RemoveSorted(*List, DocId))
+			{
+				TrigramPostings.Remove(Trigram);
+			}
+		}
+	}
+}
+
+void FSGNarrativeTextIndex::FindWords(FStringView Query, TArray<FSGNarrativeSearchHit>& OutHits, int32 MaxHits) const
+{
+	OutHits.Reset();
+
+	TArray<FString> Words;
+	Tokenize(Query, Words);
+	SortUnique(Words);
+	if (Words.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<const TArray<int32>*> Lists;
+	for (const FString& Word : Words)
+	{
+		const TArray<int32>* List = WordPostings.Find(Word);
+		if (!List)
+		{
+			return;
+		}
+		Lists.Add(List);
+	}
+
+	TArray<int32> Matches;
+	Intersect(Lists, Matches);
+
+	for (const int32 DocId : Matches)
+	{
+		if (MaxHits > 0 && OutHits.Num() >= MaxHits)
+		{
+			break;
+		}
+		AddHit(DocId, OutHits);
+	}
+}
+
+void FSGNarrativeTextIndex::FindSubstring(FStringView Query, TArray<FSGNarrativeSearchHit>& OutHits, int32 MaxHits) const
+{
+	OutHits.Reset();
+
+	if (Query.IsEmpty())
+	{
+		return;
+	}
+
+	auto Contains = [Query](const FDoc& Doc)
+	{
+		return UE::String::FindFirst(Doc.Text, Query, ESearchCase::IgnoreCase) != INDEX_NONE;
+	};
+
+	// Too short for a trigram: scan. Still only a few ms at 100k lines, and rare in practice.
+	if (Query.Len() < 3)
+	{
+		for (int32 DocId = 0; DocId < Docs.Num(); ++DocId)
+		{
+			if (MaxHits > 0 && OutHits.Num() >= MaxHits)
+			{
+				break;
+			}
+			if (Docs[DocId].bLive && Contains(Docs[DocId]))
+			{
+				AddHit(DocId, OutHits);
+			}
+		}
+		return;
+	}
+
+	// 1) Candidates hold every trigram of the query.
+	TArray<uint64> Trigrams;
+	GetTrigrams(Query, Trigrams);
+
+	TArray<const TArray<int32>*> Lists;
+	for (const uint64 Trigram : Trigrams)
+	{
+		const TArray<int32>* List = TrigramPostings.Find(Trigram);
+		if (!List)
+		{
+			return;
+		}
+		Lists.Add(List);
+	}
+
+	TArray<int32> Candidates;
+	Intersect(Lists, Candidates);
+
+	// 2) Trigrams do not keep positions, so confirm the substring itself.
+	for (const int32 DocId : Candidates)
+	{
+		if (MaxHits > 0 && OutHits.Num() >= MaxHits)
+		{
+			break;
+		}
+		if (Contains(Docs[DocId]))
+		{
+			AddHit(DocId, OutHits);
+		}
+	}
+}
+
+void FSGNarrativeTextIndex::AddHit(int32 DocId, TArray<FSGNarrativeSearchHit>& OutHits) const
+{
+	const FDoc& Doc = Docs[DocId];
+
+	FSGNarrativeSearchHit& Hit = OutHits.AddDefaulted_GetRef();
+	Hit.Source = Doc.Source;
+	Hit.Row = Doc.Row;
+	Hit.Field = Doc.Field;
+	Hit.Text = Doc.Text;
+}
+
+void FSGNarrativeTextIndex::Tokenize(FStringView Text, TArray<FString>& OutWords)
+{
+	FString Word;
+	for (const TCHAR Char : Text)
+	{
+		if (FChar::IsAlnum(Char))
+		{
+			Word.AppendChar(FChar::ToLower(Char));
+		}
+		else if (Word.Len() > 0)
+		{
+			OutWords.Add(MoveTemp(Word));
+			Word.Reset();
+		}
+	}
+
+	if (Word.Len() > 0)
+	{
+		OutWords.Add(MoveTemp(Word));
+	}
+}
+
+void FSGNarrativeTextIndex::GetTrigrams(FStringView Text, TArray<uint64>& OutTrigrams)
+{
+	OutTrigrams.Reset();
+	if (Text.Len() < 3)
+	{
+		return;
+	}
+
+	// Three folded UTF-16 units per key; wider characters alias, which the substring check absorbs.
+	auto Fold = [](TCHAR Char) { return (uint64)((uint32)FChar::ToLower(Char) & 0xFFFF); };
+
+	OutTrigrams.Reserve(Text.Len() - 2);
+	for (int32 Idx = 0; Idx + 2 < Text.Len(); ++Idx)
+	{
+		OutTrigrams.Add(Fold(Text[Idx]) | (Fold(Text[Idx + 1]) << 16) | (Fold(Text[Idx + 2]) << 32));
+	}
+
+	OutTrigrams.Sort();
+	OutTrigrams.SetNum(Algo::Unique(OutTrigrams), EAllowShrinking::No);
+}
+
+void FSGNarrativeTextIndex::Intersect(TArray<const TArray<int32>*>& Lists, TArray<int32>& OutDocs)
+{
+	OutDocs.Reset();
+	if (Lists.Num() == 0)
+	{
+		return;
+	}
+
+	Lists.Sort([](const TArray<int32>& A, const TArray<int32>& B)
+	{
+		return A.Num() < B.Num();
+	});
+
+	OutDocs = *Lists[0];
+	for (int32 ListIdx = 1; ListIdx < Lists.Num() && OutDocs.Num() > 0; ++ListIdx)
+	{
+		const TArray<int32>& Other = *Lists[ListIdx];
+
+		int32 Kept = 0;
+		int32 OtherIdx = 0;
+		for (int32 Idx = 0; Idx < OutDocs.Num() && OtherIdx < Other.Num(); ++Idx)
+		{
+			while (OtherIdx < Other.Num() && Other[OtherIdx] < OutDocs[Idx])
+			{
+				++OtherIdx;
+			}
+			if (OtherIdx < Other.Num() && Other[OtherIdx] == OutDocs[Idx])
+			{
+				OutDocs[Kept++] = OutDocs[Idx];
+			}
+		}
+		OutDocs.SetNum(Kept, EAllowShrinking::No);
+	}
+}
+
+SIZE_T FSGNarrativeTextIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = Docs.GetAllocatedSize() + FreeDocs.GetAllocatedSize() + DocByKey.GetAllocatedSize();
+	for (const FDoc& Doc : Docs)
+	{
+		Size += Doc.Text.GetAllocatedSize();
+	}
+
+	Size += WordPostings.GetAllocatedSize();
+	for (const TPair<FString, TArray<int32>>& Pair : WordPostings)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+	}
+
+	Size += TrigramPostings.GetAllocatedSize();
+	for (const TPair<uint64, TArray<int32>>& Pair : TrigramPostings)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+	return Size;
+}
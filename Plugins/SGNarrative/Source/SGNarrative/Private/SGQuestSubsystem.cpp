@@ -1,18 +1,37 @@
 #include "SGQuestSubsystem.h"
+#include "SGNarrativeDatabase.h"
 #include "SGNarrativeSettings.h"
+#include "SGNarrativeStats.h"
 
 #include "JsonObjectConverter.h"
-#include "Misc/FileHelper.h"
-#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
 
 void USGQuestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
-	Reload();
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (Settings && Settings->bLoadAsync)
+	{
+		ReloadAsync();
+	}
+	else
+	{
+		Reload();
+	}
 }
 
 void USGQuestSubsystem::Reload()
 {
+	++LoadRequest;
+	bReady = false;
+
+	if (UseDatabase())
+	{
+		FinishLoad();
+		return;
+	}
+
 	BranchQuestSummaryTable = nullptr;
 	DetailsByCode.Reset();
 
@@ -23,10 +42,97 @@ void USGQuestSubsystem::Reload()
 	}
 
 	LoadDetailsJson();
+	FinishLoad();
+}
+
+void USGQuestSubsystem::ReloadAsync()
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (!Settings)
+	{
+		Reload();
+		return;
+	}
+
+	const uint32 Request = ++LoadRequest;
+	bReady = false;
+	if (UseDatabase())
+	{
+		// Nothing to parse: the database is read in place.
+		FinishLoad();
+		return;
+	}
+
+	TWeakObjectPtr<USGQuestSubsystem> WeakThis(this);
+	const FString DetailsPath = Settings->BranchQuestDetailsJson;
+
+	FSGNarrativeAsync::LoadTable(Settings->BranchQuestSummaryTable, [WeakThis, Request, DetailsPath](UDataTable* Table)
+	{
+		if (!WeakThis.IsValid() || WeakThis->LoadRequest != Request)
+		{
+			return;
+		}
+
+		TSharedRef<TMap<FName, FSGBranchQuestDetails>> Details = MakeShared<TMap<FName, FSGBranchQuestDetails>>();
+		TStrongObjectPtr<UDataTable> Pinned(Table);
+
+		FSGNarrativeAsync::Run(
+			[Details, DetailsPath]()
+			{
+				ParseDetailsJson(DetailsPath, *Details);
+			},
+			[WeakThis, Request, Details, Pinned = MoveTemp(Pinned)]()
+			{
+				USGQuestSubsystem* This = WeakThis.Get();
+				if (!This || This->LoadRequest != Request)
+				{
+					return;
+				}
+
+				This->BranchQuestSummaryTable = Pinned.Get();
+				This->DetailsByCode = MoveTemp(*Details);
+				This->FinishLoad();
+			});
+	});
+}
+
+bool USGQuestSubsystem::UseDatabase()
+{
+	Database = FSGNarrativeDatabase::GetProjectDatabase();
+	if (!Database.IsValid() || !Database->GetTable(ESGNarrativeDbSection::QuestSummaryTable).IsValid())
+	{
+		Database.Reset();
+		return false;
+	}
+
+	BranchQuestSummaryTable = nullptr;
+	DetailsByCode.Reset();
+	return true;
+}
+
+void USGQuestSubsystem::FinishLoad()
+{
+	SET_MEMORY_STAT(STAT_SGNarrative_QuestDetailsMemory, DetailsByCode.GetAllocatedSize());
+
+	bReady = true;
+	OnReady.Broadcast();
 }
 
 bool USGQuestSubsystem::GetQuestSummary(FName Code, FSGBranchQuestSummaryRow& OutRow) const
 {
+	if (Database.IsValid())
+	{
+		// The cook indexes summaries under both the row name and the code field.
+		const FSGNarrativeDbTable& Summaries = Database->GetTable(ESGNarrativeDbSection::QuestSummaryTable);
+		const FSGRowRange Range = Summaries.Find(Code);
+		if (Range.Num > 0)
+		{
+			Summaries.ReadRow(Range.Start, OutRow);
+			return true;
+		}
+		return false;
+	}
+
 	if (!BranchQuestSummaryTable)
 	{
 		return false;
@@ -58,6 +164,27 @@ bool USGQuestSubsystem::GetQuestSummary(FName Code, FSGBranchQuestSummaryRow& Ou
 
 bool USGQuestSubsystem::GetQuestDetails(FName Code, FSGBranchQuestDetails& OutDetails) const
 {
+	if (Database.IsValid())
+	{
+		const FSGNarrativeDbTable& Details = Database->GetTable(ESGNarrativeDbSection::QuestDetailsTable);
+		const FSGRowRange Range = Details.Find(Code);
+		if (Range.Num == 0)
+		{
+			return false;
+		}
+
+		Details.ReadRow(Range.Start, OutDetails);
+
+		const FSGNarrativeDbTable& Branches = Database->GetTable(ESGNarrativeDbSection::QuestBranchTable);
+		const FSGRowRange BranchRange = Branches.Find(Code);
+		OutDetails.branches.SetNum(BranchRange.Num);
+		for (int32 Idx = 0; Idx < BranchRange.Num; ++Idx)
+		{
+			Branches.ReadRow(BranchRange.Start + Idx, OutDetails.branches[Idx]);
+		}
+		return true;
+	}
+
 	if (const FSGBranchQuestDetails* Found = DetailsByCode.Find(Code))
 	{
 		OutDetails = *Found;
@@ -66,6 +193,40 @@ bool USGQuestSubsystem::GetQuestDetails(FName Code, FSGBranchQuestDetails& OutDe
 	return false;
 }
 
+int32 USGQuestSubsystem::GetBranchCount(FName Code) const
+{
+	if (Database.IsValid())
+	{
+		if (Database->GetTable(ESGNarrativeDbSection::QuestDetailsTable).Find(Code).Num == 0)
+		{
+			return INDEX_NONE;
+		}
+		return Database->GetTable(ESGNarrativeDbSection::QuestBranchTable).Find(Code).Num;
+	}
+
+	const FSGBranchQuestDetails* D = DetailsByCode.Find(Code);
+	return D ? D->branches.Num() : INDEX_NONE;
+}
+
+const FSGBranchQuestBranch* USGQuestSubsystem::FindBranch(FName Code, int32 BranchIndex, FSGBranchQuestBranch& Scratch) const
+{
+	if (Database.IsValid())
+	{
+		const FSGNarrativeDbTable& Branches = Database->GetTable(ESGNarrativeDbSection::QuestBranchTable);
+		const FSGRowRange Range = Branches.Find(Code);
+		if (BranchIndex < 0 || BranchIndex >= Range.Num)
+		{
+			return nullptr;
+		}
+
+		Branches.ReadRow(Range.Start + BranchIndex, Scratch);
+		return &Scratch;
+	}
+
+	const FSGBranchQuestDetails* D = DetailsByCode.Find(Code);
+	return (D && D->branches.IsValidIndex(BranchIndex)) ? &D->branches[BranchIndex] : nullptr;
+}
+
 void USGQuestSubsystem::StartQuest(FName Code, int32 BranchIndex)
 {
 	FSGQuestProgress P;
@@ -75,16 +236,14 @@ void USGQuestSubsystem::StartQuest(FName Code, int32 BranchIndex)
 	P.bCompleted = false;
 
 	// Clamp to available branches if details exist.
-	if (const FSGBranchQuestDetails* D = DetailsByCode.Find(Code))
+	const int32 NumBranches = GetBranchCount(Code);
+	if (NumBranches > 0)
 	{
-		if (D->branches.Num() > 0)
-		{
-			P.branch_index = FMath::Clamp(P.branch_index, 0, D->branches.Num() - 1);
-		}
-		else
-		{
-			P.branch_index = 0;
-		}
+		P.branch_index = FMath::Clamp(P.branch_index, 0, NumBranches - 1);
+	}
+	else if (NumBranches == 0)
+	{
+		P.branch_index = 0;
 	}
 
 	ProgressByCode.Add(Code, P);
@@ -100,13 +259,12 @@ bool USGQuestSubsystem::GetCurrentObjectiveText(FName Code, FString& OutObjectiv
 		return false;
 	}
 
-	const FSGBranchQuestDetails* D = DetailsByCode.Find(Code);
-	if (D && D->branches.IsValidIndex(P->branch_index))
+	FSGBranchQuestBranch Scratch;
+	if (const FSGBranchQuestBranch* B = FindBranch(Code, P->branch_index, Scratch))
 	{
-		const FSGBranchQuestBranch& B = D->branches[P->branch_index];
-		if (B.objectives.IsValidIndex(P->objective_index))
+		if (B->objectives.IsValidIndex(P->objective_index))
 		{
-			OutObjective = B.objectives[P->objective_index];
+			OutObjective = B->objectives[P->objective_index];
 			return true;
 		}
 	}
@@ -133,10 +291,10 @@ void USGQuestSubsystem::AdvanceObjective(FName Code, bool bCompleteWhenOutOfObje
 	P->objective_index++;
 
 	// If we have details, see if we've gone past the end.
-	const FSGBranchQuestDetails* D = DetailsByCode.Find(Code);
-	if (D && D->branches.IsValidIndex(P->branch_index))
+	FSGBranchQuestBranch Scratch;
+	if (const FSGBranchQuestBranch* B = FindBranch(Code, P->branch_index, Scratch))
 	{
-		const int32 MaxIdx = D->branches[P->branch_index].objectives.Num();
+		const int32 MaxIdx = B->objectives.Num();
 		if (P->objective_index >= MaxIdx)
 		{
 			if (bCompleteWhenOutOfObjectives)
@@ -179,17 +337,15 @@ void USGQuestSubsystem::LoadDetailsJson()
 		return;
 	}
 
-	FString RelPath = Settings->BranchQuestDetailsJson;
-	RelPath = RelPath.TrimStartAndEnd();
-	if (RelPath.IsEmpty())
-	{
-		return;
-	}
+	ParseDetailsJson(Settings->BranchQuestDetailsJson, DetailsByCode);
+}
 
-	const FString AbsPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), RelPath));
+void USGQuestSubsystem::ParseDetailsJson(const FString& RelPath, TMap<FName, FSGBranchQuestDetails>& OutDetails)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_QuestJsonLoad);
 
 	FString Json;
-	if (!FFileHelper::LoadFileToString(Json, *AbsPath))
+	if (!FSGNarrativeAsync::LoadProjectFile(RelPath, Json))
 	{
 		return;
 	}
@@ -202,6 +358,6 @@ void USGQuestSubsystem::LoadDetailsJson()
 
 	for (const FSGBranchQuestDetails& Q : FileObj.quests)
 	{
-		DetailsByCode.Add(Q.code, Q);
+		OutDetails.Add(Q.code, Q);
 	}
 }
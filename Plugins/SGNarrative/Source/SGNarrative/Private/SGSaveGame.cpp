@@ -0,0 +1,57 @@
+#include "SGSaveGame.h"
+#include "SGCompactSaveFormat.h"
+
+void USGCatalystSaveGame::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FSGSaveGameVersion::GUID);
+
+	// Reference collectors and memory counters walk the properties; they get the plain tagged pass.
+	if (Ar.IsObjectReferenceCollector() || Ar.IsCountingMemory())
+	{
+		Super::Serialize(Ar);
+		return;
+	}
+
+	const FSGCompactSaveData Data{ &StoryState, &Journal, &QuestProgress, &CurrentDialogueId };
+
+	if (Ar.IsSaving())
+	{
+		// Hold the narrative properties at their defaults during the tagged pass, so it writes
+		// nothing for them (defaults are delta-skipped), then write them compactly after it.
+		FSGStoryState SavedState = MoveTemp(StoryState);
+		FSGStoryJournal SavedJournal = MoveTemp(Journal);
+		TMap<FName, FSGQuestProgress> SavedQuests = MoveTemp(QuestProgress);
+		const FName SavedDialogueId = CurrentDialogueId;
+
+		StoryState = FSGStoryState();
+		Journal = FSGStoryJournal();
+		QuestProgress.Reset();
+		CurrentDialogueId = NAME_None;
+
+		Super::Serialize(Ar);
+
+		StoryState = MoveTemp(SavedState);
+		Journal = MoveTemp(SavedJournal);
+		QuestProgress = MoveTemp(SavedQuests);
+		CurrentDialogueId = SavedDialogueId;
+
+		FSGCompactSaveFormat::Write(Ar, Data);
+		return;
+	}
+
+	// Saves from before CompactNarrative carry the narrative properties as tags; the tagged pass loads them.
+	// Save games record the versions they were written with; other loading archives report the latest.
+	Super::Serialize(Ar);
+
+	bNarrativeLoadFailed = false;
+	if (Ar.CustomVer(FSGSaveGameVersion::GUID) >= FSGSaveGameVersion::CompactNarrative
+		&& !FSGCompactSaveFormat::Read(Ar, Data))
+	{
+		// Read stops partway through; drop everything rather than keep a half-restored story.
+		StoryState = FSGStoryState();
+		Journal = FSGStoryJournal();
+		QuestProgress.Reset();
+		CurrentDialogueId = NAME_None;
+		bNarrativeLoadFailed = true;
+	}
+}
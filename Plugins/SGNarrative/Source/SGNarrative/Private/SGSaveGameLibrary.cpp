@@ -1,4 +1,6 @@
 #include "SGSaveGameLibrary.h"
+#include "SGNarrativeLog.h"
+
 #include "Kismet/GameplayStatics.h"
 
 USGCatalystSaveGame* USGSaveGameLibrary::CreateNewSave()
@@ -17,6 +19,36 @@ bool USGSaveGameLibrary::SaveToSlot(USGCatalystSaveGame* SaveObj, const FString&
 
 USGCatalystSaveGame* USGSaveGameLibrary::LoadFromSlot(const FString& SlotName, int32 UserIndex)
 {
-	USaveGame* Loaded = UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex);
-	return Cast<USGCatalystSaveGame>(Loaded);
+	USGCatalystSaveGame* Loaded = Cast<USGCatalystSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
+	if (Loaded && Loaded->HasNarrativeLoadError())
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("Save slot '%s' (user %d) has malformed narrative data; not loaded."), *SlotName, UserIndex);
+		return nullptr;
+	}
+	return Loaded;
+}
+
+bool USGSaveGameLibrary::GetStoryState(const USGCatalystSaveGame* SaveObj, FSGStoryState& OutState)
+{
+	if (!SaveObj)
+	{
+		return false;
+	}
+
+	OutState = SaveObj->StoryState;
+	SaveObj->Journal.Replay(OutState);
+	return true;
+}
+
+void USGSaveGameLibrary::WriteJournalTail(USGCatalystSaveGame* SaveObj, const FSGStoryState& BaseState, const FSGStoryJournal& Journal, int32 BasePosition)
+{
+	if (!SaveObj)
+	{
+		return;
+	}
+
+	// BaseState is the state at Journal.BasePosition; fold up to BasePosition into it and keep the rest.
+	SaveObj->StoryState = BaseState;
+	SaveObj->Journal = Journal;
+	SaveObj->Journal.Rebase(SaveObj->StoryState, BasePosition);
 }
@@ -0,0 +1,321 @@
+#include "SGStateKeyRegistry.h"
+#include "SGKeys.h"
+#include "SGNarrativeSettings.h"
+
+#include "GameplayTagsManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FSGStateKeyRegistry& FSGStateKeyRegistry::Get()
+{
+	static FSGStateKeyRegistry Instance;
+	return Instance;
+}
+
+FSGStateKeyRegistry::FSGStateKeyRegistry()
+{
+	// Generated keys first, so each SGKeys constant is its own slot.
+	for (int32 Index = 0; Index < SGKeys::NumFlags; ++Index)
+	{
+		verify(RegisterFlag(FName(SGKeys::FlagNames[Index])) == Index);
+	}
+	for (int32 Index = 0; Index < SGKeys::NumInts; ++Index)
+	{
+		verify(RegisterInt(FName(SGKeys::IntNames[Index])) == Index);
+	}
+}
+
+int32 FSGStateKeyRegistry::FKeyTable::Find(FName Key) const
+{
+	FReadScopeLock ReadLock(Lock);
+	const int32* Found = Slots.Find(Key);
+	return Found ? *Found : INDEX_NONE;
+}
+
+int32 FSGStateKeyRegistry::FKeyTable::Register(FName Key)
+{
+	if (Key.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const int32* Found = Slots.Find(Key))
+	{
+		return *Found;
+	}
+
+	const int32 Slot = NumNames.load(std::memory_order_relaxed);
+	const int32 Page = Slot / PageNames;
+	checkf(Page < MaxPages, TEXT("FSGStateKeyRegistry is full (%d keys)."), MaxPages * PageNames);
+
+	FName* Names = Pages[Page].load(std::memory_order_relaxed);
+	if (!Names)
+	{
+		Names = OwnedPages.Emplace_GetRef(MakeUnique<FName[]>(PageNames)).Get();
+		Pages[Page].store(Names, std::memory_order_relaxed);
+	}
+	Names[Slot % PageNames] = Key;
+	Slots.Add(Key, Slot);
+
+	// Publishes the page pointer and the name to readers that see the new count.
+	NumNames.store(Slot + 1, std::memory_order_release);
+	return Slot;
+}
+
+FName FSGStateKeyRegistry::FKeyTable::GetName(int32 Slot) const
+{
+	if (Slot < 0 || Slot >= NumNames.load(std::memory_order_acquire))
+	{
+		return NAME_None;
+	}
+	return Pages[Slot / PageNames].load(std::memory_order_relaxed)[Slot % PageNames];
+}
+
+int32 FSGStateKeyRegistry::FKeyTable::Num() const
+{
+	return NumNames.load(std::memory_order_acquire);
+}
+
+void FSGStateKeyRegistry::RegisterProjectKeys()
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	bMirrorFlagTags = Settings && Settings->bMirrorFlagsToGameplayTags;
+
+	TArray<FName> ProjectFlags;
+	TArray<FName> ProjectInts;
+	CollectProjectKeys(ProjectFlags, ProjectInts);
+
+	for (const FName& Flag : ProjectFlags)
+	{
+		RegisterFlag(Flag);
+	}
+	for (const FName& Key : ProjectInts)
+	{
+		RegisterInt(Key);
+	}
+
+	if (!bWatchingTagTree)
+	{
+		bWatchingTagTree = true;
+		UGameplayTagsManager& Manager = UGameplayTagsManager::Get();
+		Manager.CallOrRegister_OnDoneAddingNativeTagsDelegate(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FSGStateKeyRegistry::OnTagTreeChanged));
+#if WITH_EDITOR
+		Manager.OnEditorRefreshGameplayTagTree.AddRaw(this, &FSGStateKeyRegistry::OnTagTreeChanged);
+#endif
+	}
+}
+
+void FSGStateKeyRegistry::OnTagTreeChanged()
+{
+	FWriteScopeLock WriteLock(TagLock);
+	bTagTreeComplete = true;
+	FlagTags.Reset();
+}
+
+FGameplayTag FSGStateKeyRegistry::GetFlagTag(int32 Slot) const
+{
+	if (Slot < 0)
+	{
+		return FGameplayTag();
+	}
+
+	{
+		// Until the tag tree is complete a missing tag may still be added, so only found tags are final.
+		FReadScopeLock ReadLock(TagLock);
+		if (FlagTags.IsValidIndex(Slot) && (bTagTreeComplete || FlagTags[Slot].IsValid()))
+		{
+			return FlagTags[Slot];
+		}
+	}
+
+	const int32 NumSlots = NumFlags();
+
+	FWriteScopeLock WriteLock(TagLock);
+	UGameplayTagsManager& Manager = UGameplayTagsManager::Get();
+	if (FlagTags.IsValidIndex(Slot) && !FlagTags[Slot].IsValid())
+	{
+		FlagTags[Slot] = Manager.RequestGameplayTag(MakeFlagTagName(GetFlagName(Slot).ToString()), false);
+	}
+	for (int32 Next = FlagTags.Num(); Next < NumSlots; ++Next)
+	{
+		FlagTags.Add(Manager.RequestGameplayTag(MakeFlagTagName(GetFlagName(Next).ToString()), false));
+	}
+	return FlagTags.IsValidIndex(Slot) ? FlagTags[Slot] : FGameplayTag();
+}
+
+FGameplayTag FSGStateKeyRegistry::FindFlagTag(FName Flag) const
+{
+	const int32 Slot = FindFlag(Flag);
+	if (Slot != INDEX_NONE)
+	{
+		return GetFlagTag(Slot);
+	}
+	return UGameplayTagsManager::Get().RequestGameplayTag(MakeFlagTagName(Flag.ToString()), false);
+}
+
+FName FSGStateKeyRegistry::MakeFlagTagName(FStringView Flag)
+{
+	static const FStringView Root = TEXTVIEW("SG.Flag");
+	if (Flag.StartsWith(Root) && (Flag.Len() == Root.Len() || Flag[Root.Len()] == TCHAR('.')))
+	{
+		return FName(Flag);
+	}
+
+	// The flag's prefix (up to the first '_') is its parent tag: ga_briefed -> SG.Flag.ga.briefed.
+	TStringBuilder<128> Name;
+	Name << Root << TEXT('.') << Flag;
+
+	int32 Underscore = INDEX_NONE;
+	if (Flag.FindChar(TCHAR('_'), Underscore) && Underscore > 0)
+	{
+		Name.GetData()[Root.Len() + 1 + Underscore] = TCHAR('.');
+	}
+	return FName(Name.ToView());
+}
+
+void FSGStateKeyRegistry::CollectProjectKeys(TArray<FName>& OutFlags, TArray<FName>& OutInts)
+{
+	// Granted by every "xp" grant; always worth a slot.
+	OutInts.Add(FName(TEXT("xp")));
+
+	CollectGameplayTagFlags(OutFlags);
+
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+	if (Settings)
+	{
+		CollectStateKeysFile(Settings->StateKeysFile, OutFlags, OutInts);
+	}
+}
+
+void FSGStateKeyRegistry::CollectGameplayTagFlags(TArray<FName>& OutFlags)
+{
+	static const FString Prefix = TEXT("SG.Flag.");
+
+	UGameplayTagsManager& Manager = UGameplayTagsManager::Get();
+	const FGameplayTag Parent = Manager.RequestGameplayTag(FName(TEXT("SG.Flag")), false);
+	if (!Parent.IsValid())
+	{
+		return;
+	}
+
+	// Leaves only: SG.Flag.ga is the group of SG.Flag.ga.briefed, not a flag. The inverse of
+	// MakeFlagTagName: the first '.' under SG.Flag is the flag's '_' (SG.Flag.ga.briefed -> ga_briefed).
+	const FGameplayTagContainer Children = Manager.RequestGameplayTagChildren(Parent);
+	for (const FGameplayTag& Tag : Children)
+	{
+		const TSharedPtr<FGameplayTagNode> Node = Manager.FindTagNode(Tag);
+		if (!Node.IsValid() || Node->GetChildTagNodes().Num() > 0)
+		{
+			continue;
+		}
+
+		const FString TagStr = Tag.GetTagName().ToString();
+		if (TagStr.StartsWith(Prefix))
+		{
+			FString Flag = TagStr.RightChop(Prefix.Len());
+			int32 Dot = INDEX_NONE;
+			if (Flag.FindChar(TCHAR('.'), Dot))
+			{
+				Flag[Dot] = TCHAR('_');
+			}
+			OutFlags.Add(FName(*Flag));
+		}
+	}
+}
+
+void FSGStateKeyRegistry::CollectStateKeysFile(const FString& RelPathIn, TArray<FName>& OutFlags, TArray<FName>& OutInts)
+{
+	const FString RelPath = RelPathIn.TrimStartAndEnd();
+	if (RelPath.IsEmpty())
+	{
+		return;
+	}
+
+	const FString AbsPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), RelPath));
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *AbsPath))
+	{
+		return;
+	}
+
+	enum class ESection : uint8
+	{
+		Other,
+		Flags,
+		NumericChecks,
+		IntKeys,
+		Items,
+	};
+
+	// The notes are markdown: "## Section" headings followed by "- `key`" list items.
+	ESection Section = ESection::Other;
+	for (const FString& RawLine : Lines)
+	{
+		const FString Line = RawLine.TrimStartAndEnd();
+		if (Line.StartsWith(TEXT("#")))
+		{
+			if (Line.Contains(TEXT("Flags"), ESearchCase::CaseSensitive) || Line.Contains(TEXT("required flags")))
+			{
+				Section = ESection::Flags;
+			}
+			else if (Line.Contains(TEXT("Numeric checks")))
+			{
+				Section = ESection::NumericChecks;
+			}
+			else if (Line.Contains(TEXT("Reputation keys")) || Line.Contains(TEXT("Trust keys")))
+			{
+				Section = ESection::IntKeys;
+			}
+			else if (Line.Contains(TEXT("Items referenced")))
+			{
+				Section = ESection::Items;
+			}
+			else
+			{
+				Section = ESection::Other;
+			}
+			continue;
+		}
+
+		if (Section == ESection::Other || !Line.StartsWith(TEXT("-")))
+		{
+			continue;
+		}
+
+		const int32 Open = Line.Find(TEXT("`"));
+		const int32 Close = Line.Find(TEXT("`"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		if (Open == INDEX_NONE || Close <= Open + 1)
+		{
+			continue;
+		}
+
+		const FString Key = Line.Mid(Open + 1, Close - Open - 1);
+		switch (Section)
+		{
+		case ESection::Flags:
+			OutFlags.Add(FName(*Key));
+			break;
+		case ESection::NumericChecks:
+		{
+			// "academy_clearance>=1" -> academy_clearance
+			int32 End = 0;
+			while (End < Key.Len() && (FChar::IsAlnum(Key[End]) || Key[End] == TCHAR('_')))
+			{
+				++End;
+			}
+			OutInts.Add(FName(*Key.Left(End)));
+			break;
+		}
+		case ESection::IntKeys:
+			OutInts.Add(FName(*Key));
+			break;
+		case ESection::Items:
+			OutInts.Add(FName(*FString::Printf(TEXT("item_%s"), *Key)));
+			break;
+		default:
+			break;
+		}
+	}
+}
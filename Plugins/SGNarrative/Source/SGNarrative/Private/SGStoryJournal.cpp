@@ -0,0 +1,70 @@
+#include "SGStoryJournal.h"
+
+void FSGStoryJournalEntry::Redo(FSGStoryState& State) const
+{
+	for (const FName& Flag : FlagsAdded)
+	{
+		State.AddFlag(Flag);
+	}
+
+	for (const FSGStoryIntDelta& Delta : Ints)
+	{
+		State.SetInt(Delta.Key, Delta.NewValue);
+	}
+}
+
+void FSGStoryJournalEntry::Undo(FSGStoryState& State) const
+{
+	for (int32 Idx = Ints.Num() - 1; Idx >= 0; --Idx)
+	{
+		const FSGStoryIntDelta& Delta = Ints[Idx];
+		if (Delta.bWasSet)
+		{
+			State.SetInt(Delta.Key, Delta.OldValue);
+		}
+		else
+		{
+			State.RemoveInt(Delta.Key);
+		}
+	}
+
+	for (const FName& Flag : FlagsAdded)
+	{
+		State.RemoveFlag(Flag);
+	}
+}
+
+bool FSGStoryJournal::UndoTo(FSGStoryState& State, int32 Position)
+{
+	if (Position < BasePosition || Position > GetPosition())
+	{
+		return false;
+	}
+
+	while (GetPosition() > Position)
+	{
+		Entries.Last().Undo(State);
+		Entries.Pop(EAllowShrinking::No);
+	}
+	return true;
+}
+
+void FSGStoryJournal::Replay(FSGStoryState& State) const
+{
+	for (const FSGStoryJournalEntry& Entry : Entries)
+	{
+		Entry.Redo(State);
+	}
+}
+
+void FSGStoryJournal::Rebase(FSGStoryState& BaseState, int32 Position)
+{
+	const int32 Num = FMath::Clamp(Position - BasePosition, 0, Entries.Num());
+	for (int32 Idx = 0; Idx < Num; ++Idx)
+	{
+		Entries[Idx].Redo(BaseState);
+	}
+
+	Entries.RemoveAt(0, Num);
+	BasePosition += Num;
+}
@@ -0,0 +1,55 @@
+#include "SGStorySnapshot.h"
+#include "SGNarrativeStats.h"
+
+FSGStorySnapshotPublisher::FSGStorySnapshotPublisher()
+	: Current(MakeShared<FSGStoryState, ESPMode::ThreadSafe>())
+{
+}
+
+bool FSGStorySnapshotPublisher::Publish(const FSGStoryState& State)
+{
+	check(IsInGameThread());
+
+	// Version 0 (never written through the API) can't be compared, so it always publishes.
+	const uint64 Version = State.GetCacheVersion();
+	if (Version != 0 && Version == PublishedVersion)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SGNarrative_PublishState);
+
+	// 1) Copy outside the lock; readers keep using the old snapshot meanwhile.
+	TSharedRef<FSGStoryState, ESPMode::ThreadSafe> Copy = MakeShared<FSGStoryState, ESPMode::ThreadSafe>(State);
+	Copy->Changes.Reset();
+
+	// 2) Swap. The old snapshot is freed by whichever thread drops the last reference to it.
+	FSGStoryStateSnapshot Previous = Copy;
+	{
+		FWriteScopeLock WriteLock(Lock);
+		Swap(Current, Previous);
+		Serial.Increment();
+	}
+
+	PublishedVersion = Version;
+	return true;
+}
+
+void FSGStorySnapshotPublisher::Reset()
+{
+	check(IsInGameThread());
+
+	FSGStoryStateSnapshot Previous = MakeShared<FSGStoryState, ESPMode::ThreadSafe>();
+	{
+		FWriteScopeLock WriteLock(Lock);
+		Swap(Current, Previous);
+		Serial.Increment();
+	}
+	PublishedVersion = 0;
+}
+
+FSGStoryStateSnapshot FSGStorySnapshotPublisher::Get() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Current;
+}
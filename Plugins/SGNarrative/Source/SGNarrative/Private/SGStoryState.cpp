@@ -0,0 +1,940 @@
+#include "SGStoryState.h"
+#include "SGStateKeyRegistry.h"
+#include "SGNarrativeLog.h"
+
+#include "HAL/ThreadSafeCounter64.h"
+#include "Serialization/CustomVersion.h"
+
+const FGuid FSGStoryStateVersion::GUID(0x8D2F4A61, 0x3C9E4B17, 0xA5D07E92, 0x41B6C3F8);
+
+static FCustomVersionRegistration GRegisterSGStoryStateVersion(FSGStoryStateVersion::GUID, FSGStoryStateVersion::LatestVersion, TEXT("SGStoryStateVer"));
+
+namespace
+{
+	FThreadSafeCounter64 GStoryStateVersion;
+
+	/** splitmix64 finalizer: spreads (kind, key, value) over all 64 bits so sums do not cancel. */
+	uint64 MixHash(uint64 Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+
+	enum class EHashKind : uint64
+	{
+		Flag = 1,
+		Int = 2,
+	};
+
+	uint64 EntryHash(EHashKind Kind, uint32 Key, int32 Value = 0)
+	{
+		return MixHash(MixHash(((uint64)Kind << 32) | Key) + (uint32)Value);
+	}
+
+	// Entries hash by key name wherever they are stored, so a key hashes the same in its slot and by name.
+	uint64 FlagHash(FName Flag) { return EntryHash(EHashKind::Flag, GetTypeHash(Flag)); }
+	uint64 IntHash(FName Key, int32 Value) { return EntryHash(EHashKind::Int, GetTypeHash(Key), Value); }
+	uint64 FlagSlotHash(int32 Slot) { return FlagHash(FSGStateKeyRegistry::Get().GetFlagName(Slot)); }
+	uint64 IntSlotHash(int32 Slot, int32 Value) { return IntHash(FSGStateKeyRegistry::Get().GetIntName(Slot), Value); }
+
+	void MirrorTag(FGameplayTagContainer& Tags, const FGameplayTag& Tag, bool bSet)
+	{
+		if (!Tag.IsValid())
+		{
+			return;
+		}
+
+		if (bSet)
+		{
+			Tags.AddTag(Tag);
+		}
+		else
+		{
+			Tags.RemoveTag(Tag);
+		}
+	}
+
+	void MirrorFlagTag(FGameplayTagContainer& Tags, int32 Slot, bool bSet)
+	{
+		const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+		if (Registry.IsMirroringFlagTags())
+		{
+			MirrorTag(Tags, Registry.GetFlagTag(Slot), bSet);
+		}
+	}
+
+	/** For flags held by name (ad-hoc, or set before registration). */
+	void MirrorFlagNameTag(FGameplayTagContainer& Tags, FName Flag, bool bSet)
+	{
+		const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+		if (Registry.IsMirroringFlagTags())
+		{
+			MirrorTag(Tags, Registry.FindFlagTag(Flag), bSet);
+		}
+	}
+
+	template <typename WordArray>
+	void MarkChanged(WordArray& Words, int32 Slot)
+	{
+		const int32 Word = Slot >> 5;
+		if (Word >= Words.Num())
+		{
+			Words.AddZeroed(Word + 1 - Words.Num());
+		}
+		Words[Word] |= 1u << (Slot & 31);
+	}
+}
+
+bool FSGStoryState::HasFlag(FName Flag) const
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindFlag(Flag);
+	if (Slot != INDEX_NONE && HasFlagSlot(Slot))
+	{
+		return true;
+	}
+
+	// Unregistered flags, or flags set before their key was registered.
+	return Flags.Num() > 0 && Flags.Contains(Flag);
+}
+
+void FSGStoryState::AddFlag(FName Flag)
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindFlag(Flag);
+	if (Slot != INDEX_NONE)
+	{
+		AddFlagSlot(Slot);
+	}
+	else
+	{
+		bool bAlreadySet = false;
+		Flags.Add(Flag, &bAlreadySet);
+		if (!bAlreadySet)
+		{
+			ContentHash += FlagHash(Flag);
+			MirrorFlagNameTag(FlagTags, Flag, true);
+			BumpVersion();
+		}
+	}
+}
+
+void FSGStoryState::RemoveFlag(FName Flag)
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindFlag(Flag);
+	if (Slot != INDEX_NONE)
+	{
+		RemoveFlagSlot(Slot);
+	}
+	else if (Flags.Remove(Flag) > 0)
+	{
+		ContentHash -= FlagHash(Flag);
+		MirrorFlagNameTag(FlagTags, Flag, false);
+		BumpVersion();
+	}
+}
+
+void FSGStoryState::BumpVersion()
+{
+	Version = (uint64)GStoryStateVersion.Increment();
+}
+
+FSGStoryFlagChunk& FSGStoryState::MutableFlagChunk(int32 Slot)
+{
+	const int32 Chunk = (Slot >> 5) / FSGStoryFlagChunk::Words;
+	if (Chunk >= FlagChunks.Num())
+	{
+		FlagChunks.SetNum(Chunk + 1);
+	}
+
+	TSharedPtr<FSGStoryFlagChunk>& Ptr = FlagChunks[Chunk];
+	if (!Ptr.IsValid())
+	{
+		Ptr = MakeShared<FSGStoryFlagChunk>();
+	}
+	else if (!Ptr.IsUnique())
+	{
+		// Another copy still reads this chunk; write to our own.
+		Ptr = MakeShared<FSGStoryFlagChunk>(*Ptr);
+	}
+	return *Ptr;
+}
+
+FSGStoryIntChunk& FSGStoryState::MutableIntChunk(int32 Slot)
+{
+	const int32 Chunk = Slot / FSGStoryIntChunk::Slots;
+	if (Chunk >= IntChunks.Num())
+	{
+		IntChunks.SetNum(Chunk + 1);
+	}
+
+	TSharedPtr<FSGStoryIntChunk>& Ptr = IntChunks[Chunk];
+	if (!Ptr.IsValid())
+	{
+		Ptr = MakeShared<FSGStoryIntChunk>();
+	}
+	else if (!Ptr.IsUnique())
+	{
+		Ptr = MakeShared<FSGStoryIntChunk>(*Ptr);
+	}
+	return *Ptr;
+}
+
+int32 FSGStoryState::NumUniqueChunks() const
+{
+	int32 Num = 0;
+	for (const TSharedPtr<FSGStoryFlagChunk>& Chunk : FlagChunks)
+	{
+		Num += (Chunk.IsValid() && Chunk.IsUnique()) ? 1 : 0;
+	}
+	for (const TSharedPtr<FSGStoryIntChunk>& Chunk : IntChunks)
+	{
+		Num += (Chunk.IsValid() && Chunk.IsUnique()) ? 1 : 0;
+	}
+	return Num;
+}
+
+void FSGStoryState::AddFlagSlot(int32 Slot)
+{
+	if (HasFlagSlot(Slot))
+	{
+		return;
+	}
+
+	// Set by name before the key was registered: the same flag moves into its slot, already hashed.
+	const bool bWasSet = Flags.Num() > 0 && Flags.Remove(FSGStateKeyRegistry::Get().GetFlagName(Slot)) > 0;
+
+	MutableFlagChunk(Slot).Bits[(Slot >> 5) % FSGStoryFlagChunk::Words] |= 1u << (Slot & 31);
+	MirrorFlagTag(FlagTags, Slot, true);
+	if (!bWasSet)
+	{
+		ContentHash += FlagSlotHash(Slot);
+		MarkChanged(Changes.FlagWords, Slot);
+		BumpVersion();
+	}
+}
+
+void FSGStoryState::RemoveFlagSlot(int32 Slot)
+{
+	// A registered flag can still sit in the name set if it was added before registration.
+	const bool bInSlot = HasFlagSlot(Slot);
+	const bool bByName = Flags.Num() > 0 && Flags.Remove(FSGStateKeyRegistry::Get().GetFlagName(Slot)) > 0;
+	if (!bInSlot && !bByName)
+	{
+		return;
+	}
+
+	if (bInSlot)
+	{
+		MutableFlagChunk(Slot).Bits[(Slot >> 5) % FSGStoryFlagChunk::Words] &= ~(1u << (Slot & 31));
+	}
+	ContentHash -= FlagSlotHash(Slot);
+	MirrorFlagTag(FlagTags, Slot, false);
+	MarkChanged(Changes.FlagWords, Slot);
+	BumpVersion();
+}
+
+bool FSGStoryState::MatchesFlagMasks(const uint32* Required, const uint32* Forbidden, int32 NumWords) const
+{
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+
+	for (int32 Word = 0; Word < NumWords; ++Word)
+	{
+		const uint32 Bits = GetFlagWord(Word);
+
+		if ((Bits & Forbidden[Word]) != 0)
+		{
+			return false;
+		}
+
+		uint32 Missing = Required[Word] & ~Bits;
+		if (Missing == 0)
+		{
+			continue;
+		}
+
+		// Only a non-empty name set can still supply a missing bit.
+		if (Flags.Num() == 0)
+		{
+			return false;
+		}
+
+		while (Missing != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros(Missing);
+			Missing &= Missing - 1;
+
+			if (!Flags.Contains(Registry.GetFlagName(Word * 32 + Bit)))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (Flags.Num() > 0)
+	{
+		for (int32 Word = 0; Word < NumWords; ++Word)
+		{
+			uint32 Forbid = Forbidden[Word];
+			while (Forbid != 0)
+			{
+				const int32 Bit = FMath::CountTrailingZeros(Forbid);
+				Forbid &= Forbid - 1;
+
+				if (Flags.Contains(Registry.GetFlagName(Word * 32 + Bit)))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void FSGStoryState::GetAllFlags(TArray<FName>& OutFlags) const
+{
+	OutFlags.Reset();
+
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	for (int32 Word = 0; Word < NumFlagWords(); ++Word)
+	{
+		uint32 Bits = GetFlagWord(Word);
+		while (Bits != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+			OutFlags.Add(Registry.GetFlagName(Word * 32 + Bit));
+		}
+	}
+
+	for (const FName& Flag : Flags)
+	{
+		OutFlags.AddUnique(Flag);
+	}
+}
+
+bool FSGStoryState::HasFlagTag(const FGameplayTag& Tag) const
+{
+	if (!Tag.IsValid())
+	{
+		return false;
+	}
+
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	if (Registry.IsMirroringFlagTags())
+	{
+		return FlagTags.HasTag(Tag);
+	}
+
+	for (int32 Word = 0; Word < NumFlagWords(); ++Word)
+	{
+		uint32 Bits = GetFlagWord(Word);
+		while (Bits != 0)
+		{
+			if (Registry.GetFlagTag(Word * 32 + FMath::CountTrailingZeros(Bits)).MatchesTag(Tag))
+			{
+				return true;
+			}
+			Bits &= Bits - 1;
+		}
+	}
+
+	for (const FName& Flag : Flags)
+	{
+		if (Registry.FindFlagTag(Flag).MatchesTag(Tag))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FSGStoryState::MatchesFlagTagQuery(const FGameplayTagQuery& Query) const
+{
+	if (FSGStateKeyRegistry::Get().IsMirroringFlagTags())
+	{
+		return Query.Matches(FlagTags);
+	}
+
+	FGameplayTagContainer Tags;
+	GetFlagTags(Tags);
+	return Query.Matches(Tags);
+}
+
+void FSGStoryState::GetFlagTags(FGameplayTagContainer& OutTags) const
+{
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	if (Registry.IsMirroringFlagTags())
+	{
+		OutTags = FlagTags;
+		return;
+	}
+
+	OutTags.Reset();
+	for (int32 Word = 0; Word < NumFlagWords(); ++Word)
+	{
+		uint32 Bits = GetFlagWord(Word);
+		while (Bits != 0)
+		{
+			const FGameplayTag Tag = Registry.GetFlagTag(Word * 32 + FMath::CountTrailingZeros(Bits));
+			if (Tag.IsValid())
+			{
+				OutTags.AddTag(Tag);
+			}
+			Bits &= Bits - 1;
+		}
+	}
+
+	for (const FName& Flag : Flags)
+	{
+		const FGameplayTag Tag = Registry.FindFlagTag(Flag);
+		if (Tag.IsValid())
+		{
+			OutTags.AddTag(Tag);
+		}
+	}
+}
+
+void FSGStoryState::RebuildFlagTags()
+{
+	FlagTags.Reset();
+	if (!FSGStateKeyRegistry::Get().IsMirroringFlagTags())
+	{
+		return;
+	}
+
+	for (int32 Word = 0; Word < NumFlagWords(); ++Word)
+	{
+		uint32 Bits = GetFlagWord(Word);
+		while (Bits != 0)
+		{
+			MirrorFlagTag(FlagTags, Word * 32 + FMath::CountTrailingZeros(Bits), true);
+			Bits &= Bits - 1;
+		}
+	}
+
+	for (const FName& Flag : Flags)
+	{
+		MirrorFlagNameTag(FlagTags, Flag, true);
+	}
+}
+
+bool FSGStoryState::FindInt(FName Key, int32& OutValue) const
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindInt(Key);
+	if (Slot != INDEX_NONE && HasIntSlot(Slot))
+	{
+		OutValue = GetIntSlot(Slot);
+		return true;
+	}
+
+	if (const int32* Found = Ints.Find(Key))
+	{
+		OutValue = *Found;
+		return true;
+	}
+	return false;
+}
+
+int32 FSGStoryState::GetInt(FName Key, int32 DefaultValue) const
+{
+	int32 Value = DefaultValue;
+	FindInt(Key, Value);
+	return Value;
+}
+
+void FSGStoryState::SetInt(FName Key, int32 Value)
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindInt(Key);
+	if (Slot != INDEX_NONE)
+	{
+		SetIntSlot(Slot, Value);
+	}
+	else
+	{
+		const int32* Current = Ints.Find(Key);
+		if (!Current || *Current != Value)
+		{
+			if (Current)
+			{
+				ContentHash -= IntHash(Key, *Current);
+			}
+			ContentHash += IntHash(Key, Value);
+
+			Ints.Add(Key, Value);
+			BumpVersion();
+		}
+	}
+}
+
+void FSGStoryState::AddInt(FName Key, int32 Delta)
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindInt(Key);
+	if (Slot != INDEX_NONE)
+	{
+		AddIntSlot(Slot, Delta);
+	}
+	else
+	{
+		// Adding 0 to a missing key still creates it.
+		if (Delta != 0 || !Ints.Contains(Key))
+		{
+			BumpVersion();
+		}
+
+		// Only an existing entry has a hash to take out.
+		int32* Value = Ints.Find(Key);
+		if (Value)
+		{
+			ContentHash -= IntHash(Key, *Value);
+			*Value += Delta;
+		}
+		else
+		{
+			Value = &Ints.Add(Key, Delta);
+		}
+		ContentHash += IntHash(Key, *Value);
+	}
+}
+
+void FSGStoryState::RemoveInt(FName Key)
+{
+	const int32 Slot = FSGStateKeyRegistry::Get().FindInt(Key);
+
+	// A registered key can also (or only) sit in the name map if it was written before registration;
+	// the slot value is the one readers see, and the one hashed.
+	const bool bInSlot = Slot != INDEX_NONE && HasIntSlot(Slot);
+	int32 Removed = bInSlot ? GetIntSlot(Slot) : 0;
+
+	int32 Loose = 0;
+	const bool bByName = Ints.RemoveAndCopyValue(Key, Loose);
+	if (!bInSlot && !bByName)
+	{
+		return;
+	}
+
+	if (bInSlot)
+	{
+		FSGStoryIntChunk& Chunk = MutableIntChunk(Slot);
+		const int32 Index = Slot % FSGStoryIntChunk::Slots;
+		Chunk.Present &= ~(1u << Index);
+		Chunk.Values[Index] = 0;
+	}
+	else
+	{
+		Removed = Loose;
+	}
+
+	ContentHash -= IntHash(Key, Removed);
+	if (Slot != INDEX_NONE && Removed != 0)
+	{
+		MarkChanged(Changes.IntWords, Slot);
+	}
+	BumpVersion();
+}
+
+void FSGStoryState::SetIntSlot(int32 Slot, int32 Value)
+{
+	// Unchanged writes must not copy a shared chunk.
+	const bool bWasSet = HasIntSlot(Slot);
+	if (bWasSet && GetIntSlot(Slot) == Value)
+	{
+		return;
+	}
+
+	bool bExisted = false;
+	int32& Current = TouchIntSlot(Slot, bExisted);
+	if (bExisted && Current == Value)
+	{
+		// Only moved from the name map into the slot.
+		return;
+	}
+
+	if (bExisted)
+	{
+		ContentHash -= IntSlotHash(Slot, Current);
+	}
+	ContentHash += IntSlotHash(Slot, Value);
+
+	// A new key set to 0 reads as before.
+	if (Current != Value)
+	{
+		MarkChanged(Changes.IntWords, Slot);
+	}
+	Current = Value;
+	BumpVersion();
+}
+
+void FSGStoryState::AddIntSlot(int32 Slot, int32 Delta)
+{
+	const bool bWasSet = HasIntSlot(Slot);
+	if (bWasSet && Delta == 0)
+	{
+		return;
+	}
+
+	bool bExisted = false;
+	int32& Current = TouchIntSlot(Slot, bExisted);
+	if (bExisted && Delta == 0)
+	{
+		return;
+	}
+
+	if (bExisted)
+	{
+		ContentHash -= IntSlotHash(Slot, Current);
+	}
+	Current += Delta;
+	ContentHash += IntSlotHash(Slot, Current);
+
+	if (Delta != 0)
+	{
+		MarkChanged(Changes.IntWords, Slot);
+	}
+	BumpVersion();
+}
+
+int32& FSGStoryState::TouchIntSlot(int32 Slot, bool& bOutExisted)
+{
+	FSGStoryIntChunk& Chunk = MutableIntChunk(Slot);
+	const int32 Index = Slot % FSGStoryIntChunk::Slots;
+
+	int32& Value = Chunk.Values[Index];
+	bOutExisted = (Chunk.Present & (1u << Index)) != 0;
+	if (bOutExisted)
+	{
+		return Value;
+	}
+
+	Chunk.Present |= 1u << Index;
+	Value = 0;
+
+	// A value written by name before the key was registered moves into the slot.
+	if (Ints.Num() > 0)
+	{
+		bOutExisted = Ints.RemoveAndCopyValue(FSGStateKeyRegistry::Get().GetIntName(Slot), Value);
+	}
+	return Value;
+}
+
+int32 FSGStoryState::GetLooseIntForSlot(int32 Slot) const
+{
+	const int32* Found = Ints.Find(FSGStateKeyRegistry::Get().GetIntName(Slot));
+	return Found ? *Found : 0;
+}
+
+void FSGStoryState::AdoptRegisteredKeys()
+{
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+
+	// Only storage moves: readers already saw these keys by name, and they hash by name either way.
+	TArray<TPair<FName, int32>, TInlineAllocator<8>> Adopted;
+	for (const FName& Flag : Flags)
+	{
+		const int32 Slot = Registry.FindFlag(Flag);
+		if (Slot != INDEX_NONE)
+		{
+			Adopted.Emplace(Flag, Slot);
+		}
+	}
+
+	for (const TPair<FName, int32>& Pair : Adopted)
+	{
+		if (HasFlagSlot(Pair.Value))
+		{
+			// The slot was set since; the name entry was a duplicate.
+			Flags.Remove(Pair.Key);
+		}
+		else
+		{
+			// AddFlagSlot moves the name entry into the slot.
+			AddFlagSlot(Pair.Value);
+		}
+	}
+
+	Adopted.Reset();
+	for (const TPair<FName, int32>& Pair : Ints)
+	{
+		const int32 Slot = Registry.FindInt(Pair.Key);
+		if (Slot != INDEX_NONE)
+		{
+			Adopted.Emplace(Pair.Key, Slot);
+		}
+	}
+
+	for (const TPair<FName, int32>& Pair : Adopted)
+	{
+		if (HasIntSlot(Pair.Value))
+		{
+			// The slot was written since; it is the value every reader already sees.
+			Ints.Remove(Pair.Key);
+		}
+		else
+		{
+			// TouchIntSlot moves the loose value into the slot.
+			bool bExisted = false;
+			TouchIntSlot(Pair.Value, bExisted);
+		}
+	}
+}
+
+void FSGStoryState::GetAllInts(TMap<FName, int32>& OutInts) const
+{
+	OutInts = Ints;
+
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	for (int32 ChunkIdx = 0; ChunkIdx < IntChunks.Num(); ++ChunkIdx)
+	{
+		const FSGStoryIntChunk* Chunk = IntChunks[ChunkIdx].Get();
+		uint32 Bits = Chunk ? Chunk->Present : 0u;
+		while (Bits != 0)
+		{
+			const int32 Index = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+
+			OutInts.Add(Registry.GetIntName(ChunkIdx * FSGStoryIntChunk::Slots + Index), Chunk->Values[Index]);
+		}
+	}
+}
+
+bool FSGStoryState::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FSGStoryStateVersion::GUID);
+
+	// Saved as tagged properties: let the engine load Flags / Ints, PostSerialize sorts them into slots.
+	if (Ar.IsLoading() && Ar.CustomVer(FSGStoryStateVersion::GUID) < FSGStoryStateVersion::NativeSerializer)
+	{
+		return false;
+	}
+
+	static constexpr int32 CurrentSerialVersion = 1;
+	int32 SerialVersion = CurrentSerialVersion;
+	Ar << SerialVersion;
+
+	if (Ar.IsLoading() && SerialVersion != CurrentSerialVersion)
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("FSGStoryState: unknown serial version %d (expected %d)."), SerialVersion, CurrentSerialVersion);
+		Ar.SetError();
+		return true;
+	}
+
+	// Flags and ints by name: slots and loose entries from both sources merged.
+	TArray<FName> AllFlags;
+	TMap<FName, int32> AllInts;
+	if (!Ar.IsLoading())
+	{
+		GetAllFlags(AllFlags);
+		GetAllInts(AllInts);
+	}
+
+	Ar << AllFlags;
+	Ar << AllInts;
+
+	if (Ar.IsLoading() && !Ar.IsError())
+	{
+		LoadFromNames(AllFlags, AllInts);
+	}
+
+	return true;
+}
+
+void FSGStoryState::PostSerialize(const FArchive& Ar)
+{
+	if (!Ar.IsLoading() || Ar.CustomVer(FSGStoryStateVersion::GUID) >= FSGStoryStateVersion::NativeSerializer)
+	{
+		return;
+	}
+
+	// The tagged path filled Flags / Ints directly, registered keys included.
+	const TArray<FName> AllFlags = Flags.Array();
+	const TMap<FName, int32> AllInts = Ints;
+	LoadFromNames(AllFlags, AllInts);
+}
+
+void FSGStoryState::LoadFromNames(const TArray<FName>& AllFlags, const TMap<FName, int32>& AllInts)
+{
+	Flags.Reset();
+	FlagChunks.Reset();
+	Ints.Reset();
+	IntChunks.Reset();
+	ContentHash = 0;
+	FlagTags.Reset();
+
+	for (const FName& Flag : AllFlags)
+	{
+		AddFlag(Flag);
+	}
+
+	for (const TPair<FName, int32>& Pair : AllInts)
+	{
+		SetInt(Pair.Key, Pair.Value);
+	}
+
+	// Per-key changes mean nothing against a replaced state.
+	Changes.Reset();
+	Changes.bAll = true;
+	BumpVersion();
+}
+
+uint64 FSGStoryState::GetCacheVersion() const
+{
+	if (Version == 0 || (Flags.Num() == 0 && Ints.Num() == 0))
+	{
+		return Version;
+	}
+
+	uint64 Loose = 0;
+	for (const FName& Flag : Flags)
+	{
+		Loose += FlagHash(Flag);
+	}
+	for (const TPair<FName, int32>& Pair : Ints)
+	{
+		Loose += IntHash(Pair.Key, Pair.Value);
+	}
+
+	// Never 0, which would mean "do not cache".
+	return MixHash(Version ^ Loose) | 1;
+}
+
+uint64 FSGStoryState::ComputeContentHash() const
+{
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	uint64 Hash = 0;
+
+	for (int32 Word = 0; Word < NumFlagWords(); ++Word)
+	{
+		uint32 Bits = GetFlagWord(Word);
+		while (Bits != 0)
+		{
+			const int32 Bit = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+			Hash += FlagSlotHash(Word * 32 + Bit);
+		}
+	}
+
+	// A name entry whose slot is also set is the same key, counted once (direct writes can leave both).
+	for (const FName& Flag : Flags)
+	{
+		const int32 Slot = Registry.FindFlag(Flag);
+		if (Slot == INDEX_NONE || !HasFlagSlot(Slot))
+		{
+			Hash += FlagHash(Flag);
+		}
+	}
+
+	for (int32 ChunkIdx = 0; ChunkIdx < IntChunks.Num(); ++ChunkIdx)
+	{
+		const FSGStoryIntChunk* Chunk = IntChunks[ChunkIdx].Get();
+		uint32 Bits = Chunk ? Chunk->Present : 0u;
+		while (Bits != 0)
+		{
+			const int32 Index = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+			Hash += IntSlotHash(ChunkIdx * FSGStoryIntChunk::Slots + Index, Chunk->Values[Index]);
+		}
+	}
+
+	for (const TPair<FName, int32>& Pair : Ints)
+	{
+		const int32 Slot = Registry.FindInt(Pair.Key);
+		if (Slot == INDEX_NONE || !HasIntSlot(Slot))
+		{
+			Hash += IntHash(Pair.Key, Pair.Value);
+		}
+	}
+
+	return Hash;
+}
+
+bool FSGStoryState::Identical(const FSGStoryState* Other, uint32 PortFlags) const
+{
+	if (!Other)
+	{
+		return false;
+	}
+
+	// A key held by name here may be in its slot there: compare what readers see.
+	if (Flags.Num() > 0 || Ints.Num() > 0 || Other->Flags.Num() > 0 || Other->Ints.Num() > 0)
+	{
+		return IdenticalByName(*Other);
+	}
+
+	// Shared chunks are equal by construction; trailing empty chunks are not significant.
+	const int32 NumFlagChunks = FMath::Max(FlagChunks.Num(), Other->FlagChunks.Num());
+	for (int32 ChunkIdx = 0; ChunkIdx < NumFlagChunks; ++ChunkIdx)
+	{
+		const FSGStoryFlagChunk* A = FlagChunks.IsValidIndex(ChunkIdx) ? FlagChunks[ChunkIdx].Get() : nullptr;
+		const FSGStoryFlagChunk* B = Other->FlagChunks.IsValidIndex(ChunkIdx) ? Other->FlagChunks[ChunkIdx].Get() : nullptr;
+		if (A == B)
+		{
+			continue;
+		}
+
+		for (int32 Word = 0; Word < FSGStoryFlagChunk::Words; ++Word)
+		{
+			if ((A ? A->Bits[Word] : 0u) != (B ? B->Bits[Word] : 0u))
+			{
+				return false;
+			}
+		}
+	}
+
+	const int32 NumIntChunks = FMath::Max(IntChunks.Num(), Other->IntChunks.Num());
+	for (int32 ChunkIdx = 0; ChunkIdx < NumIntChunks; ++ChunkIdx)
+	{
+		const FSGStoryIntChunk* A = IntChunks.IsValidIndex(ChunkIdx) ? IntChunks[ChunkIdx].Get() : nullptr;
+		const FSGStoryIntChunk* B = Other->IntChunks.IsValidIndex(ChunkIdx) ? Other->IntChunks[ChunkIdx].Get() : nullptr;
+		if (A == B)
+		{
+			continue;
+		}
+
+		const uint32 Present = A ? A->Present : 0u;
+		if (Present != (B ? B->Present : 0u))
+		{
+			return false;
+		}
+
+		uint32 Bits = Present;
+		while (Bits != 0)
+		{
+			const int32 Index = FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+			if (A->Values[Index] != B->Values[Index])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FSGStoryState::IdenticalByName(const FSGStoryState& Other) const
+{
+	TArray<FName> AllFlags;
+	TArray<FName> OtherFlags;
+	GetAllFlags(AllFlags);
+	Other.GetAllFlags(OtherFlags);
+	if (AllFlags.Num() != OtherFlags.Num())
+	{
+		return false;
+	}
+
+	const TSet<FName> FlagSet(AllFlags);
+	for (const FName& Flag : OtherFlags)
+	{
+		if (!FlagSet.Contains(Flag))
+		{
+			return false;
+		}
+	}
+
+	TMap<FName, int32> AllInts;
+	TMap<FName, int32> OtherInts;
+	GetAllInts(AllInts);
+	Other.GetAllInts(OtherInts);
+	return AllInts.OrderIndependentCompareEqual(OtherInts);
+}
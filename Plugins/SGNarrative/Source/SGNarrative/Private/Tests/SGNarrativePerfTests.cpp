@@ -0,0 +1,471 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SGCinematicsSubsystem.h"
+#include "SGDecisionPointSubsystem.h"
+#include "SGDialogueSubsystem.h"
+#include "SGQuestSubsystem.h"
+
+#include "Engine/GameInstance.h"
+#include "HAL/FileManager.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HAL/PlatformTime.h"
+#include "JsonObjectConverter.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+/**
+ * Narrative perf suite: synthetic tables at 1k / 10k / 100k rows, timed through the subsystem API.
+ *
+ * Run with Automation RunTests SGNarrative.Perf (the tests carry PerfFilter, so they are not part of
+ * the default smoke/product runs). Each run appends ns/op, bytes retained per op and the op's peak
+ * memory to Saved/Automation/SGNarrativePerf.csv. If SGNarrativePerf.baseline.csv exists next to it (a
+ * copy of a good run), an op that got much slower or peaks higher than its baseline fails the test,
+ * which is what the VSTestAdapter [RUNTEST] results report.
+ *
+ * Memory comes from Low Level Memory Tracker tags (run with -llm; the columns are -1 without it).
+ * Each op runs under its own tag, which LLM attributes per thread without touching GMalloc, so work
+ * on other threads is not counted. LLM slows every allocation: compare runs made with the same flags.
+ */
+namespace
+{
+	/** Slower than baseline by more than this factor fails. */
+	constexpr double TimeTolerance = 1.5;
+
+	/** Peak memory over baseline by more than this factor, plus PeakSlackKB, fails (LLM byte counts are near-deterministic). */
+	constexpr double PeakTolerance = 1.25;
+	constexpr double PeakSlackKB = 4.0;
+
+	/** Lookup ops per measurement; builds and loads run BuildOps times. */
+	constexpr int32 LookupOps = 100000;
+	constexpr int32 BuildOps = 3;
+
+	struct FPerfResult
+	{
+		FString Op;
+		double NsPerOp = 0.0;
+
+		/** Net bytes still held after the op, per op; -1 without LLM. */
+		double RetainedBytesPerOp = -1.0;
+
+		/** Most memory the op's tag held at once during the measurement; -1 without LLM. */
+		double PeakKB = -1.0;
+	};
+
+	/** Bytes the tag holds now and at its peak, or false when LLM is not running. */
+	bool ReadTagBytes(FName Tag, int64& OutCurrent, int64& OutPeak)
+	{
+#if LLM_ENABLED_IN_CONFIG
+		if (FLowLevelMemTracker::IsEnabled())
+		{
+			FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+
+			// Folds the per-thread counts into the tag totals.
+			Tracker.UpdateStatsPerFrame();
+			OutCurrent = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None, UE::LLM::ESizeParams::ReportCurrent);
+			OutPeak = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None, UE::LLM::ESizeParams::ReportPeak);
+			return true;
+		}
+#endif
+		return false;
+	}
+
+	/** Call Body(OpIndex) Ops times under an LLM tag of its own, so its allocations (temporaries included) are the tag's. */
+	template <typename FuncType>
+	FPerfResult Measure(const TCHAR* Op, int32 NumRows, int32 Ops, FuncType&& Body)
+	{
+		FPerfResult Result;
+		Result.Op = Op;
+
+		// One tag per op and size, so the tag's peak is this measurement's peak.
+		const FName Tag(*FString::Printf(TEXT("SGNarrativePerf/%d/%s"), NumRows, Op));
+
+		int64 StartBytes = 0;
+		int64 StartPeak = 0;
+		const bool bTracked = ReadTagBytes(Tag, StartBytes, StartPeak);
+
+		const double Start = FPlatformTime::Seconds();
+		{
+#if LLM_ENABLED_IN_CONFIG
+			FLLMScope TagScope(Tag, false, ELLMTagSet::None, ELLMTracker::Default);
+#endif
+			for (int32 Idx = 0; Idx < Ops; ++Idx)
+			{
+				Body(Idx);
+			}
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+		Result.NsPerOp = Seconds * 1.0e9 / Ops;
+
+		int64 EndBytes = 0;
+		int64 EndPeak = 0;
+		if (bTracked && ReadTagBytes(Tag, EndBytes, EndPeak))
+		{
+			Result.RetainedBytesPerOp = (double)(EndBytes - StartBytes) / Ops;
+			Result.PeakKB = EndPeak / 1024.0;
+		}
+		return Result;
+	}
+
+	/** Transient DataTable of RowStruct rows named R_<index>. */
+	template <typename RowType>
+	UDataTable* MakeTable(const TArray<RowType>& Rows)
+	{
+		UDataTable* Table = NewObject<UDataTable>(GetTransientPackage());
+		Table->RowStruct = RowType::StaticStruct();
+		for (int32 Idx = 0; Idx < Rows.Num(); ++Idx)
+		{
+			Table->AddRow(*FString::Printf(TEXT("R_%d"), Idx), Rows[Idx]);
+		}
+		return Table;
+	}
+
+	/**
+	 * Blocks shaped like the shipped suite: a line, then a decision with three options (one free,
+	 * one behind a flag, one behind a rep check that grants rep), leading to the next block.
+	 */
+	void MakeDialogueRows(int32 NumRows, TArray<FSGDialogueDecisionRow>& Out, TArray<FName>& OutDecisionIds)
+	{
+		const int32 NumBlocks = FMath::Max(NumRows / 5, 1);
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			const FName LineId(*FString::Printf(TEXT("SYN_%d_LINE"), Block));
+			const FName DecisionId(*FString::Printf(TEXT("SYN_%d"), Block));
+			const FName NextId(*FString::Printf(TEXT("SYN_%d_LINE"), (Block + 1) % NumBlocks));
+			const FString Quest = FString::Printf(TEXT("Synthetic Quest %d"), Block / 40);
+			const FString Hub = FString::Printf(TEXT("Hub %d"), Block / 200);
+			const FString Rep = FString::Printf(TEXT("rep_syn_%d"), Block % 8);
+
+			FSGDialogueDecisionRow Line;
+			Line.quest = Quest;
+			Line.hub = Hub;
+			Line.id = LineId;
+			Line.type = TEXT("DIALOGUE");
+			Line.speaker = FString::Printf(TEXT("Speaker %d"), Block % 24);
+			Line.emotion = TEXT("neutral");
+			Line.line_or_prompt = FString::Printf(TEXT("Synthetic line %d."), Block);
+			Line.checks = TEXT("[]");
+			Line.conditions = TEXT("[]");
+			Line.set_flags = FString::Printf(TEXT("[\"syn_seen_%d\"]"), Block % 256);
+			Line.grants = TEXT("{}");
+			Line.next = DecisionId;
+			Out.Add(Line);
+
+			FSGDialogueDecisionRow Decision;
+			Decision.quest = Quest;
+			Decision.hub = Hub;
+			Decision.id = DecisionId;
+			Decision.type = TEXT("DECISION");
+			Decision.line_or_prompt = FString::Printf(TEXT("Synthetic decision %d?"), Block);
+			Decision.checks = TEXT("[]");
+			Decision.conditions = TEXT("[]");
+			Decision.set_flags = TEXT("[]");
+			Decision.grants = TEXT("{}");
+			Out.Add(Decision);
+			OutDecisionIds.Add(DecisionId);
+
+			for (int32 Option = 0; Option < 3; ++Option)
+			{
+				FSGDialogueDecisionRow& Row = Out.Add_GetRef(Decision);
+				Row.type = TEXT("DECISION_OPTION");
+				Row.option_key = FString::Chr(TEXT('A') + Option);
+				Row.option_text = FString::Printf(TEXT("Synthetic option %d%c."), Block, TEXT('A') + Option);
+				Row.next = NextId;
+
+				if (Option == 1)
+				{
+					Row.conditions = FString::Printf(TEXT("[\"syn_seen_%d\"]"), (Block + 1) % 256);
+					Row.set_flags = FString::Printf(TEXT("[\"syn_choice_%d\"]"), Block % 512);
+				}
+				else if (Option == 2)
+				{
+					Row.checks = FString::Printf(TEXT("[\"%s>=1\"]"), *Rep);
+					Row.grants = FString::Printf(TEXT("{\"rep\": {\"%s\": \"+1\"}}"), *Rep);
+				}
+			}
+		}
+	}
+
+	/** Scenes of eight shots, twenty scenes per questline. */
+	void MakeShotRows(int32 NumRows, TArray<FSGCinematicShotRow>& Out, TArray<TPair<FString, FString>>& OutScenes)
+	{
+		for (int32 Idx = 0; Idx < NumRows; ++Idx)
+		{
+			const int32 Scene = Idx / 8;
+
+			FSGCinematicShotRow& Shot = Out.AddDefaulted_GetRef();
+			Shot.questline = FString::Printf(TEXT("Synthetic Quest %d"), Scene / 20);
+			Shot.scene_id = FString::Printf(TEXT("SYN-S%d"), Scene);
+			Shot.shot_no = 8 - Idx % 8;
+			Shot.framing = TEXT("WIDE");
+			Shot.lens_mm = 35.0f;
+			Shot.duration_s = 4.0f;
+			Shot.description = FString::Printf(TEXT("Synthetic shot %d"), Idx);
+
+			if (Idx % 8 == 0)
+			{
+				OutScenes.Emplace(Shot.questline, Shot.scene_id);
+			}
+		}
+	}
+
+	/** One prompt and three options per decision point. */
+	void MakeDecisionPointRows(int32 NumRows, TArray<FSGDecisionPointRow>& Out, TArray<FString>& OutIds)
+	{
+		const int32 NumPoints = FMath::Max(NumRows / 4, 1);
+		for (int32 Point = 0; Point < NumPoints; ++Point)
+		{
+			const FString DpId = FString::Printf(TEXT("DP-SYN-%d"), Point);
+			OutIds.Add(DpId);
+
+			for (int32 Idx = 0; Idx < 4; ++Idx)
+			{
+				FSGDecisionPointRow& Row = Out.AddDefaulted_GetRef();
+				Row.act = FString::Printf(TEXT("Act %d"), Point / 100);
+				Row.scene = FString::Printf(TEXT("S%d"), Point / 10);
+				Row.dp_id = DpId;
+				Row.row_type = Idx == 0 ? TEXT("PROMPT") : TEXT("OPTION");
+				Row.prompt_text = FString::Printf(TEXT("Synthetic decision point %d"), Point);
+				if (Idx > 0)
+				{
+					// Reverse key order so the option sort has work to do.
+					Row.option_key = FString::Chr(TEXT('D') - Idx);
+					Row.option_text = FString::Printf(TEXT("Synthetic option %d"), Idx);
+					Row.immediate = TEXT("+SYN_TRUST");
+				}
+			}
+		}
+	}
+
+	/** Quest details JSON with two branches of two objectives per quest (a "row" per objective). */
+	FString MakeQuestDetailsJson(int32 NumRows)
+	{
+		FSGBranchQuestDetailsFile File;
+		File.generated_from = TEXT("SGNarrativePerfTests");
+
+		const int32 NumQuests = FMath::Max(NumRows / 4, 1);
+		for (int32 Quest = 0; Quest < NumQuests; ++Quest)
+		{
+			FSGBranchQuestDetails& Details = File.quests.AddDefaulted_GetRef();
+			Details.code = *FString::Printf(TEXT("SYN%d"), Quest);
+			Details.title = FString::Printf(TEXT("Synthetic Quest %d"), Quest);
+			Details.overview = TEXT("Synthetic overview.");
+
+			for (int32 Branch = 0; Branch < 2; ++Branch)
+			{
+				FSGBranchQuestBranch& Out = Details.branches.AddDefaulted_GetRef();
+				Out.name = FString::Printf(TEXT("Branch %d"), Branch + 1);
+				Out.objectives = { TEXT("Synthetic objective 1"), TEXT("Synthetic objective 2") };
+				Out.rewards = TEXT("rep +1");
+			}
+		}
+
+		FString Json;
+		FJsonObjectConverter::UStructToJsonObjectString(File, Json);
+		return Json;
+	}
+
+	FString GetResultsPath() { return FPaths::Combine(FPaths::AutomationDir(), TEXT("SGNarrativePerf.csv")); }
+	FString GetBaselinePath() { return FPaths::Combine(FPaths::AutomationDir(), TEXT("SGNarrativePerf.baseline.csv")); }
+
+	/** "rows|op" -> (ns/op, peak KB), last entry wins. Peak is -1 when the baseline has none. */
+	void LoadBaseline(TMap<FString, TPair<double, double>>& Out)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *GetBaselinePath()))
+		{
+			return;
+		}
+
+		// timestamp,rows,op,ns_per_op,retained_bytes_per_op,peak_kb. Baselines from before the LLM
+		// columns (allocs_per_op,peak_mb) only contribute their timings.
+		bool bHasPeak = false;
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Cells;
+			Line.ParseIntoArray(Cells, TEXT(","), false);
+			if (Cells.Num() >= 6 && Cells[0] == TEXT("timestamp"))
+			{
+				bHasPeak = Cells[5] == TEXT("peak_kb");
+			}
+			else if (Cells.Num() >= 6 && Cells[1].IsNumeric())
+			{
+				const double Peak = bHasPeak ? FCString::Atod(*Cells[5]) : -1.0;
+				Out.Add(Cells[1] + TEXT("|") + Cells[2], TPair<double, double>(FCString::Atod(*Cells[3]), Peak));
+			}
+		}
+	}
+
+	bool RunNarrativePerf(FAutomationTestBase& Test, int32 NumRows)
+	{
+		// 1) Synthetic sources.
+		TArray<FSGDialogueDecisionRow> DialogueRows;
+		TArray<FName> DecisionIds;
+		MakeDialogueRows(NumRows, DialogueRows, DecisionIds);
+
+		TArray<FSGCinematicShotRow> ShotRows;
+		TArray<TPair<FString, FString>> Scenes;
+		MakeShotRows(NumRows, ShotRows, Scenes);
+
+		TArray<FSGDecisionPointRow> PointRows;
+		TArray<FString> PointIds;
+		MakeDecisionPointRows(NumRows, PointRows, PointIds);
+
+		const FString QuestJsonAbs = FPaths::Combine(FPaths::AutomationDir(), FString::Printf(TEXT("SGNarrativePerf_Quests_%d.json"), NumRows));
+		if (!FFileHelper::SaveStringToFile(MakeQuestDetailsJson(NumRows), *QuestJsonAbs))
+		{
+			Test.AddError(FString::Printf(TEXT("Could not write %s."), *QuestJsonAbs));
+			return false;
+		}
+		FString QuestJsonRel = FPaths::ConvertRelativePathToFull(QuestJsonAbs);
+		FPaths::MakePathRelativeTo(QuestJsonRel, *FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()));
+
+		TStrongObjectPtr<UDataTable> DialogueTable(MakeTable(DialogueRows));
+		TStrongObjectPtr<UDataTable> ShotTable(MakeTable(ShotRows));
+		TStrongObjectPtr<UDataTable> PointTable(MakeTable(PointRows));
+
+		// Subsystems under a bare game instance (never initialized): only the table-driven paths run.
+		TStrongObjectPtr<UGameInstance> GameInstance(NewObject<UGameInstance>(GetTransientPackage()));
+		TStrongObjectPtr<USGDialogueSubsystem> Dialogue(NewObject<USGDialogueSubsystem>(GameInstance.Get()));
+		TStrongObjectPtr<USGCinematicsSubsystem> Cinematics(NewObject<USGCinematicsSubsystem>(GameInstance.Get()));
+		TStrongObjectPtr<USGDecisionPointSubsystem> DecisionPoints(NewObject<USGDecisionPointSubsystem>(GameInstance.Get()));
+
+		// 2) Measure.
+		TArray<FPerfResult> Results;
+
+		Results.Add(Measure(TEXT("Dialogue.BuildIndex"), NumRows, BuildOps, [&](int32) { Dialogue->ReloadFromTable(DialogueTable.Get()); }));
+		Results.Add(Measure(TEXT("Cinematics.BuildIndex"), NumRows, BuildOps, [&](int32) { Cinematics->ReloadFromTable(ShotTable.Get()); }));
+		Results.Add(Measure(TEXT("DecisionPoints.BuildIndex"), NumRows, BuildOps, [&](int32) { DecisionPoints->ReloadFromTable(PointTable.Get()); }));
+
+		Results.Add(Measure(TEXT("Quests.ParseDetailsJson"), NumRows, BuildOps, [&](int32)
+		{
+			TMap<FName, FSGBranchQuestDetails> Details;
+			USGQuestSubsystem::ParseDetailsJson(QuestJsonRel, Details);
+		}));
+
+		TArray<FSGDialogueDecisionRow> OutRows;
+		Results.Add(Measure(TEXT("GetRowsByNarrativeId"), NumRows, LookupOps, [&](int32 Op)
+		{
+			Dialogue->GetRowsByNarrativeId(DecisionIds[Op % DecisionIds.Num()], OutRows);
+		}));
+
+		// Half the flags and reps set, so every option kind passes somewhere and fails somewhere.
+		FSGStoryState State;
+		for (int32 Idx = 0; Idx < 256; Idx += 2)
+		{
+			State.AddFlag(*FString::Printf(TEXT("syn_seen_%d"), Idx));
+		}
+		for (int32 Idx = 0; Idx < 8; Idx += 2)
+		{
+			State.SetInt(*FString::Printf(TEXT("rep_syn_%d"), Idx), 1);
+		}
+
+		Results.Add(Measure(TEXT("GetDecisionOptions"), NumRows, LookupOps, [&](int32 Op)
+		{
+			Dialogue->GetDecisionOptions(DecisionIds[Op % DecisionIds.Num()], State, OutRows);
+		}));
+
+		// The granting option of each decision (materialized once; stamped rows take the compiled path).
+		TArray<FSGDialogueDecisionRow> GrantRows;
+		for (const FName& Id : DecisionIds)
+		{
+			if (Dialogue->GetRowsByNarrativeId(Id, OutRows) && OutRows.Num() > 0)
+			{
+				GrantRows.Add(OutRows.Last());
+			}
+		}
+		if (GrantRows.Num() == 0)
+		{
+			Test.AddError(TEXT("Synthetic dialogue did not index."));
+			return false;
+		}
+
+		FSGStoryState ApplyState = State;
+		Results.Add(Measure(TEXT("ApplyRowEffects"), NumRows, LookupOps, [&](int32 Op)
+		{
+			Dialogue->ApplyRowEffects(GrantRows[Op % GrantRows.Num()], ApplyState);
+		}));
+
+		TArray<FSGCinematicShotRow> OutShots;
+		Results.Add(Measure(TEXT("GetShotsForScene"), NumRows, LookupOps, [&](int32 Op)
+		{
+			const TPair<FString, FString>& Scene = Scenes[Op % Scenes.Num()];
+			Cinematics->GetShotsForScene(Scene.Key, Scene.Value, OutShots);
+		}));
+
+		TArray<FSGDecisionPointRow> OutOptions;
+		Results.Add(Measure(TEXT("GetOptions"), NumRows, LookupOps, [&](int32 Op)
+		{
+			DecisionPoints->GetOptions(PointIds[Op % PointIds.Num()], OutOptions);
+		}));
+
+		// 3) Report, append to the CSV, compare against the baseline.
+		TMap<FString, TPair<double, double>> Baseline;
+		LoadBaseline(Baseline);
+
+		const FString ResultsPath = GetResultsPath();
+		FString Csv;
+		if (!IFileManager::Get().FileExists(*ResultsPath))
+		{
+			Csv += TEXT("timestamp,rows,op,ns_per_op,retained_bytes_per_op,peak_kb\n");
+		}
+
+		const FString Timestamp = FDateTime::UtcNow().ToIso8601();
+		for (const FPerfResult& Result : Results)
+		{
+			Test.AddInfo(FString::Printf(TEXT("%d rows, %s: %.1f ns/op, %.1f bytes retained/op, peak %.1f KB"),
+				NumRows, *Result.Op, Result.NsPerOp, Result.RetainedBytesPerOp, Result.PeakKB));
+			Csv += FString::Printf(TEXT("%s,%d,%s,%.1f,%.1f,%.1f\n"), *Timestamp, NumRows, *Result.Op, Result.NsPerOp, Result.RetainedBytesPerOp, Result.PeakKB);
+
+			if (const TPair<double, double>* Base = Baseline.Find(FString::Printf(TEXT("%d|%s"), NumRows, *Result.Op)))
+			{
+				if (Base->Key > 0.0 && Result.NsPerOp > Base->Key * TimeTolerance)
+				{
+					Test.AddError(FString::Printf(TEXT("%s at %d rows regressed: %.1f ns/op, baseline %.1f."), *Result.Op, NumRows, Result.NsPerOp, Base->Key));
+				}
+				if (Base->Value >= 0.0 && Result.PeakKB >= 0.0 && Result.PeakKB > Base->Value * PeakTolerance + PeakSlackKB)
+				{
+					Test.AddError(FString::Printf(TEXT("%s at %d rows peaks higher: %.1f KB, baseline %.1f KB."), *Result.Op, NumRows, Result.PeakKB, Base->Value));
+				}
+			}
+		}
+
+		if (!FFileHelper::SaveStringToFile(Csv, *ResultsPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append))
+		{
+			Test.AddWarning(FString::Printf(TEXT("Could not write %s."), *ResultsPath));
+		}
+
+		IFileManager::Get().Delete(*QuestJsonAbs);
+		return !Test.HasAnyErrors();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGNarrativePerf1kTest, "SGNarrative.Perf.Rows1k",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSGNarrativePerf1kTest::RunTest(const FString& Parameters)
+{
+	return RunNarrativePerf(*this, 1000);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGNarrativePerf10kTest, "SGNarrative.Perf.Rows10k",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSGNarrativePerf10kTest::RunTest(const FString& Parameters)
+{
+	return RunNarrativePerf(*this, 10000);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGNarrativePerf100kTest, "SGNarrative.Perf.Rows100k",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSGNarrativePerf100kTest::RunTest(const FString& Parameters)
+{
+	return RunNarrativePerf(*this, 100000);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,100 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SGSaveGame.h"
+
+#include "Kismet/GameplayStatics.h"
+
+namespace
+{
+	/** True if Bytes holds Text as ANSI characters (how the save archives write FNames). */
+	bool ContainsAnsi(const TArray<uint8>& Bytes, const ANSICHAR* Text)
+	{
+		const int32 Len = FCStringAnsi::Strlen(Text);
+		for (int32 Idx = 0; Idx + Len <= Bytes.Num(); ++Idx)
+		{
+			if (FMemory::Memcmp(Bytes.GetData() + Idx, Text, Len) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGSaveGameCompactRoundTripTest, "SGNarrative.SaveGame.CompactRoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSGSaveGameCompactRoundTripTest::RunTest(const FString& Parameters)
+{
+	USGCatalystSaveGame* Save = NewObject<USGCatalystSaveGame>();
+	Save->StoryState.AddFlag(TEXT("sgtest_compact_flag"));
+	Save->StoryState.SetInt(TEXT("sgtest_compact_int"), -7);
+	Save->CurrentDialogueId = TEXT("SGTEST_NODE");
+
+	FSGStoryJournalEntry Entry;
+	Entry.RowId = TEXT("SGTEST_ROW");
+	Entry.FlagsAdded.Add(TEXT("sgtest_compact_flag"));
+	Save->Journal.Add(MoveTemp(Entry));
+
+	FSGQuestProgress Progress;
+	Progress.quest_code = TEXT("SGTEST_QUEST");
+	Progress.branch_index = 1;
+	Progress.objective_index = 2;
+	Save->QuestProgress.Add(Progress.quest_code, Progress);
+
+	TArray<uint8> Bytes;
+	if (!TestTrue(TEXT("SaveGameToMemory"), UGameplayStatics::SaveGameToMemory(Save, Bytes)))
+	{
+		return false;
+	}
+
+	// The compact block writes names in its symbol table; the tagged pass must not have written the properties.
+	TestTrue(TEXT("Compact block holds the story keys"), ContainsAnsi(Bytes, "sgtest_compact_int"));
+	TestFalse(TEXT("No StoryState property tag"), ContainsAnsi(Bytes, "StoryState"));
+	TestFalse(TEXT("No QuestProgress property tag"), ContainsAnsi(Bytes, "QuestProgress"));
+
+	const USGCatalystSaveGame* Loaded = Cast<USGCatalystSaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes));
+	if (!TestNotNull(TEXT("LoadGameFromMemory"), Loaded))
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Story state round-trips"), Loaded->StoryState.Equals(Save->StoryState));
+	TestEqual(TEXT("Int value"), Loaded->StoryState.GetInt(TEXT("sgtest_compact_int")), -7);
+	TestTrue(TEXT("Dialogue id"), Loaded->CurrentDialogueId == Save->CurrentDialogueId);
+	TestEqual(TEXT("Journal entries"), Loaded->Journal.Entries.Num(), 1);
+	if (Loaded->Journal.Entries.Num() == 1)
+	{
+		TestTrue(TEXT("Journal row"), Loaded->Journal.Entries[0].RowId == FName(TEXT("SGTEST_ROW")));
+	}
+
+	const FSGQuestProgress* LoadedProgress = Loaded->QuestProgress.Find(TEXT("SGTEST_QUEST"));
+	if (TestNotNull(TEXT("Quest progress"), LoadedProgress))
+	{
+		TestEqual(TEXT("Branch"), LoadedProgress->branch_index, 1);
+		TestEqual(TEXT("Objective"), LoadedProgress->objective_index, 2);
+	}
+	TestFalse(TEXT("No load error"), Loaded->HasNarrativeLoadError());
+
+	// The compact block is the last thing written: cutting its tail makes it malformed.
+	TArray<uint8> Truncated = Bytes;
+	Truncated.SetNum(Truncated.Num() - 4);
+	// Ours, and the memory reader's own overrun error.
+	AddExpectedError(TEXT("Compact save data is malformed|bytes when|enough data"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	const USGCatalystSaveGame* Broken = Cast<USGCatalystSaveGame>(UGameplayStatics::LoadGameFromMemory(Truncated));
+	if (TestNotNull(TEXT("LoadGameFromMemory (truncated)"), Broken))
+	{
+		TestTrue(TEXT("Load error reported"), Broken->HasNarrativeLoadError());
+		TestFalse(TEXT("Story state reset"), Broken->StoryState.HasFlag(TEXT("sgtest_compact_flag")));
+		TestEqual(TEXT("Journal reset"), Broken->Journal.Entries.Num(), 0);
+		TestEqual(TEXT("Quests reset"), Broken->QuestProgress.Num(), 0);
+		TestTrue(TEXT("Dialogue id reset"), Broken->CurrentDialogueId.IsNone());
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
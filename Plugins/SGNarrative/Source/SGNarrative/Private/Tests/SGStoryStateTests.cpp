@@ -0,0 +1,112 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SGStateKeyRegistry.h"
+#include "SGStoryState.h"
+
+namespace
+{
+	/** The incrementally kept hash must match one computed from scratch. */
+	void TestHashConsistent(FAutomationTestBase& Test, const TCHAR* After, const FSGStoryState& State)
+	{
+		Test.TestEqual(FString::Printf(TEXT("Hash after %s"), After), State.GetContentHash(), State.ComputeContentHash());
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGStoryStateContentHashTest, "SGNarrative.StoryState.ContentHash",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSGStoryStateContentHashTest::RunTest(const FString& Parameters)
+{
+	FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	const int32 FlagSlot = Registry.RegisterFlag(TEXT("sgtest_hash_reg_flag"));
+	const int32 IntSlot = Registry.RegisterInt(TEXT("sgtest_hash_reg_int"));
+
+	FSGStoryState State;
+	TestHashConsistent(*this, TEXT("construction"), State);
+
+	// Flags by name, registered and ad-hoc, and by slot.
+	State.AddFlag(TEXT("sgtest_hash_flag"));
+	TestHashConsistent(*this, TEXT("AddFlag (ad-hoc)"), State);
+	State.AddFlag(TEXT("sgtest_hash_reg_flag"));
+	TestHashConsistent(*this, TEXT("AddFlag (registered)"), State);
+	State.RemoveFlag(TEXT("sgtest_hash_flag"));
+	TestHashConsistent(*this, TEXT("RemoveFlag (ad-hoc)"), State);
+	State.RemoveFlagSlot(FlagSlot);
+	TestHashConsistent(*this, TEXT("RemoveFlagSlot"), State);
+	State.AddFlagSlot(FlagSlot);
+	TestHashConsistent(*this, TEXT("AddFlagSlot"), State);
+
+	// Ints by name: new and existing keys, ad-hoc and registered.
+	State.AddInt(TEXT("sgtest_hash_new_int"), 3);
+	TestHashConsistent(*this, TEXT("AddInt (new ad-hoc key)"), State);
+	State.AddInt(TEXT("sgtest_hash_new_int"), -5);
+	TestHashConsistent(*this, TEXT("AddInt (existing ad-hoc key)"), State);
+	State.AddInt(TEXT("sgtest_hash_zero_int"), 0);
+	TestHashConsistent(*this, TEXT("AddInt (new key, zero delta)"), State);
+	State.SetInt(TEXT("sgtest_hash_set_int"), 9);
+	TestHashConsistent(*this, TEXT("SetInt (new ad-hoc key)"), State);
+	State.SetInt(TEXT("sgtest_hash_set_int"), 4);
+	TestHashConsistent(*this, TEXT("SetInt (existing ad-hoc key)"), State);
+	State.SetInt(TEXT("sgtest_hash_reg_int"), 2);
+	TestHashConsistent(*this, TEXT("SetInt (registered)"), State);
+	State.AddInt(TEXT("sgtest_hash_reg_int"), 6);
+	TestHashConsistent(*this, TEXT("AddInt (registered)"), State);
+	State.RemoveInt(TEXT("sgtest_hash_set_int"));
+	TestHashConsistent(*this, TEXT("RemoveInt (ad-hoc)"), State);
+	State.RemoveInt(TEXT("sgtest_hash_reg_int"));
+	TestHashConsistent(*this, TEXT("RemoveInt (registered)"), State);
+
+	// Ints by slot.
+	State.SetIntSlot(IntSlot, 11);
+	TestHashConsistent(*this, TEXT("SetIntSlot"), State);
+	State.AddIntSlot(IntSlot, -1);
+	TestHashConsistent(*this, TEXT("AddIntSlot"), State);
+
+	// Written by name first, registered afterwards, then adopted into slots.
+	State.AddFlag(TEXT("sgtest_hash_late_flag"));
+	State.SetInt(TEXT("sgtest_hash_late_int"), 8);
+	Registry.RegisterFlag(TEXT("sgtest_hash_late_flag"));
+	Registry.RegisterInt(TEXT("sgtest_hash_late_int"));
+	TestEqual(TEXT("Late int by slot before adopting"), State.GetIntSlot(Registry.FindInt(TEXT("sgtest_hash_late_int"))), 8);
+	const uint64 HashBeforeAdopting = State.GetContentHash();
+	State.AdoptRegisteredKeys();
+	TestHashConsistent(*this, TEXT("AdoptRegisteredKeys"), State);
+	TestEqual(TEXT("Adopting keeps the hash"), State.GetContentHash(), HashBeforeAdopting);
+	TestTrue(TEXT("Adopted flag"), State.HasFlag(TEXT("sgtest_hash_late_flag")));
+	TestEqual(TEXT("Adopted int"), State.GetIntSlot(Registry.FindInt(TEXT("sgtest_hash_late_int"))), 8);
+
+	// Copies share chunks; a write to the copy must not disturb either hash.
+	FSGStoryState Copy = State;
+	Copy.AddFlagSlot(Registry.RegisterFlag(TEXT("sgtest_hash_copy_flag")));
+	TestHashConsistent(*this, TEXT("write to a copy (copy)"), Copy);
+	TestHashConsistent(*this, TEXT("write to a copy (original)"), State);
+	TestTrue(TEXT("Copies differ"), State.GetContentHash() != Copy.GetContentHash());
+
+	// Equal contents reached in a different order hash the same.
+	FSGStoryState Other;
+	Other.AddIntSlot(IntSlot, 10);
+	Other.SetInt(TEXT("sgtest_hash_late_int"), 8);
+	Other.AddFlag(TEXT("sgtest_hash_late_flag"));
+	Other.SetInt(TEXT("sgtest_hash_zero_int"), 0);
+	Other.SetInt(TEXT("sgtest_hash_new_int"), -2);
+	Other.AddFlag(TEXT("sgtest_hash_reg_flag"));
+	TestTrue(TEXT("Same contents are Identical"), Other.Identical(&State, 0));
+	TestEqual(TEXT("Same contents, same hash"), Other.GetContentHash(), State.GetContentHash());
+
+	// The same keys held by name (a direct write) and in their slots are the same contents.
+	FSGStoryState BySlot;
+	BySlot.AddFlag(TEXT("sgtest_hash_late_flag"));
+	BySlot.SetInt(TEXT("sgtest_hash_late_int"), 8);
+	FSGStoryState ByName;
+	ByName.Flags.Add(TEXT("sgtest_hash_late_flag"));
+	ByName.Ints.Add(TEXT("sgtest_hash_late_int"), 8);
+	ByName.RecomputeContentHash();
+	TestTrue(TEXT("Storage does not affect Identical"), ByName.Identical(&BySlot, 0));
+	TestEqual(TEXT("Storage does not affect the hash"), ByName.GetContentHash(), BySlot.GetContentHash());
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -4,8 +4,11 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Engine/DataTable.h"
 #include "SGDialogueTypes.h"
+#include "SGNarrativeAsync.h"
 #include "SGCinematicsSubsystem.generated.h"
 
+class FSGNarrativeDatabase;
+
 /**
  * Simple helper subsystem to query the cinematics shotlist DataTable.
  * This does NOT attempt to drive Level Sequences automatically (that becomes project-specific fast).
@@ -21,12 +24,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Cinematics")
 	void Reload();
 
+	/** Stream the shotlist and index it on a worker; the current index stays live until OnReady. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Cinematics")
+	void ReloadAsync();
+
+	/** Rebuild from Table instead of the configured shotlist, ignoring the cooked database (tools, perf tests). */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Cinematics")
+	void ReloadFromTable(UDataTable* Table);
+
+	/** True once the latest Reload / ReloadAsync has completed; false while a ReloadAsync is in flight. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Cinematics")
+	bool IsReady() const { return bReady; }
+
+	/** Broadcast on the game thread each time a reload swaps in a new index. */
+	UPROPERTY(BlueprintAssignable, Category="Shattered Gods|Cinematics")
+	FSGNarrativeReadySignature OnReady;
+
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Cinematics")
 	bool GetShotsForScene(const FString& Questline, const FString& SceneId, TArray<FSGCinematicShotRow>& OutShots) const;
 
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Cinematics")
 	UDataTable* GetShotlistTable() const { return ShotlistTable; }
 
+	/**
+	 * Group copies of the table rows (FSGNarrativeAsync::CopyRows) by Questline|SceneId, sorted by shot
+	 * number; the rows are moved into OutShots. Safe off the game thread; also used by the narrative cook.
+	 */
+	static void BuildIndexFromRows(TArray<FSGCinematicShotRow>&& Rows, TMap<FString, TArray<FSGCinematicShotRow>>& OutShots);
+
+	static FString MakeSceneKey(const FString& Questline, const FString& SceneId) { return Questline + TEXT("|") + SceneId; }
+
 private:
 	UPROPERTY()
 	UDataTable* ShotlistTable = nullptr;
@@ -34,5 +61,16 @@ private:
 	/** Cache key: Questline|SceneId */
 	TMap<FString, TArray<FSGCinematicShotRow>> ShotsByScene;
 
+	/** Cooked database serving lookups in place of ShotsByScene, when mounted. */
+	TSharedPtr<const FSGNarrativeDatabase> Database;
+
+	/** Bumped per reload so a slower, older ReloadAsync never overwrites a newer result. */
+	uint32 LoadRequest = 0;
+	bool bReady = false;
+
 	void BuildIndex();
+	void FinishLoad();
+
+	/** Use the cooked database if it has the shotlist; clears the source-table state. */
+	bool UseDatabase();
 };
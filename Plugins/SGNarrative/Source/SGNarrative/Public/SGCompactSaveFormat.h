@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "SGStoryState.h"
+#include "SGStoryJournal.h"
+#include "SGQuestSubsystem.h"
+
+/** Custom version of USGCatalystSaveGame data. */
+struct SGNARRATIVE_API FSGSaveGameVersion
+{
+	enum Type
+	{
+		BeforeCustomVersionWasAdded = 0,
+
+		/** Story state, journal and quest progress are written by FSGCompactSaveFormat, not as tagged properties. */
+		CompactNarrative,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+/** What FSGCompactSaveFormat writes: the narrative part of a save. */
+struct FSGCompactSaveData
+{
+	FSGStoryState* StoryState = nullptr;
+	FSGStoryJournal* Journal = nullptr;
+	TMap<FName, FSGQuestProgress>* QuestProgress = nullptr;
+	FName* CurrentDialogueId = nullptr;
+};
+
+/**
+ * Compact binary encoding of story state, journal and quest progress.
+ *
+ * Every name (flags, int keys, row ids, quest codes) is written once, in a sorted symbol table;
+ * the rest are unsigned LEB128 varints: flags as gaps between sorted symbol indices, ints as
+ * (symbol gap, zigzag value), journal int writes as (symbol, old value, new - old) and quest
+ * progress as packed (branch, objective, completed) records. Loading is one forward pass with
+ * no property tags or reflection.
+ *
+ * Names are stored as strings, so saves survive FSGStateKeyRegistry changes between builds.
+ */
+struct SGNARRATIVE_API FSGCompactSaveFormat
+{
+	static void Write(FArchive& Ar, const FSGCompactSaveData& Data);
+
+	/** False (and Ar.IsError()) on malformed data; the outputs are then left partially filled (USGCatalystSaveGame resets them). */
+	static bool Read(FArchive& Ar, const FSGCompactSaveData& Data);
+
+	static void WriteVarUInt(FArchive& Ar, uint64 Value);
+	static uint64 ReadVarUInt(FArchive& Ar);
+
+	/** Zigzag, so small negative values stay short too. */
+	static void WriteVarInt(FArchive& Ar, int32 Value);
+	static int32 ReadVarInt(FArchive& Ar);
+};
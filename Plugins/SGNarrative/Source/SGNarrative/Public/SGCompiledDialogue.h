@@ -0,0 +1,360 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGDialogueTypes.h"
+#include "SGStoryState.h"
+#include "SGNarrativeStringPool.h"
+#include "SGStoryJournal.h"
+
+class FSGNarrativeDatabase;
+
+/** Opcodes for compiled `conditions` and `checks` entries. */
+enum class ESGPredicateOp : uint8
+{
+	HasFlag,
+	NotFlag,
+	IntGreaterEqual,
+	IntLessEqual,
+	IntEqual,
+	IntNotEqual,
+	IntGreater,
+	IntLess,
+
+	/** `ga.*` / `!ga.*`: any set flag under SG.Flag.ga (Key is the tag name, Tag the resolved tag). */
+	HasFlagTag,
+	NotFlagTag,
+};
+
+/** One predicate instruction: opcode, pre-resolved key and immediate operand. */
+struct FSGPredicateInstr
+{
+	ESGPredicateOp Op = ESGPredicateOp::HasFlag;
+	int32 Operand = 0;
+	FName Key;
+
+	/** FSGStateKeyRegistry slot for Key, when the compiler resolved one. */
+	int32 Slot = INDEX_NONE;
+
+	/** Flag tag ops: the gameplay tag Key names, resolved when compiled; invalid if it is not declared. */
+	FGameplayTag Tag;
+
+	bool operator==(const FSGPredicateInstr& Other) const
+	{
+		return Op == Other.Op && Operand == Other.Operand && Key == Other.Key && Slot == Other.Slot && Tag == Other.Tag;
+	}
+};
+
+/** Opcodes for compiled `set_flags` and `grants` effects. */
+enum class ESGEffectOp : uint8
+{
+	AddFlag,
+	AddInt,
+};
+
+/** One effect instruction: opcode, pre-resolved key and delta (AddInt only). */
+struct FSGEffectInstr
+{
+	ESGEffectOp Op = ESGEffectOp::AddFlag;
+	int32 Delta = 0;
+	FName Key;
+
+	/** FSGStateKeyRegistry slot for Key, when the compiler resolved one. */
+	int32 Slot = INDEX_NONE;
+};
+
+/** One deduplicated predicate (a row's conditions, or its checks); rows with identical sources share it. */
+struct FSGCompiledPredicate
+{
+	/** Flag conditions as bitsets: Required words at MaskStart, Forbidden words right after. */
+	int32 MaskStart = 0;
+	int32 MaskWords = 0;
+
+	/** Instructions that could not be folded into the masks (checks, unresolved keys). */
+	int32 InstrStart = 0;
+	int32 InstrNum = 0;
+};
+
+/** Programs of one compiled row. */
+struct FSGCompiledRow
+{
+	/** Index into the predicate table; INDEX_NONE == always true. */
+	int32 Condition = INDEX_NONE;
+	int32 Check = INDEX_NONE;
+
+	int32 EffectStart = 0;
+	int32 EffectNum = 0;
+};
+
+/** Contiguous run of rows sharing one narrative id. */
+struct FSGRowRange
+{
+	int32 Start = 0;
+	int32 Num = 0;
+};
+
+/**
+ * Index-resident form of FSGDialogueDecisionRow: the text fields are FSGNarrativeStringPool handles,
+ * so speaker/emotion/anim/quest/hub strings shared by hundreds of rows are stored once.
+ * Field names match FSGDialogueDecisionRow.
+ */
+struct SGNARRATIVE_API FSGDialogueRowData
+{
+	FName id;
+	FName next;
+
+	FSGNarrativeString quest;
+	FSGNarrativeString hub;
+	FSGNarrativeString type;
+	FSGNarrativeString speaker;
+	FSGNarrativeString title;
+	FSGNarrativeString emotion;
+	FSGNarrativeString anim;
+	FSGNarrativeString line_or_prompt;
+	FSGNarrativeString option_key;
+	FSGNarrativeString option_text;
+	FSGNarrativeString checks;
+	FSGNarrativeString conditions;
+	FSGNarrativeString set_flags;
+	FSGNarrativeString grants;
+
+	/** Intern every text field of Source. */
+	void Intern(const FSGDialogueDecisionRow& Source);
+
+	/** Copy the pooled strings back out (not the compile stamp; see FSGCompiledDialogue::MaterializeRow). */
+	void Materialize(FSGDialogueDecisionRow& Out) const;
+};
+
+/** Row fields with a secondary index: a posting list of row slots per distinct value. */
+enum class ESGDialogueRowField : uint8
+{
+	Quest,
+	Hub,
+	Speaker,
+
+	Num
+};
+
+/**
+ * Rows matching every term (AND). Values are resolved to pool handles when the term is added,
+ * so running a query only walks posting lists. An empty value matches rows where the field is empty.
+ */
+struct SGNARRATIVE_API FSGDialogueQuery
+{
+	struct FTerm
+	{
+		ESGDialogueRowField Field = ESGDialogueRowField::Quest;
+		FSGNarrativeString Value;
+	};
+
+	TArray<FTerm, TInlineAllocator<4>> Terms;
+
+	/** Set when a term names a string no row was ever interned with. */
+	bool bMatchesNothing = false;
+
+	FSGDialogueQuery& Where(ESGDialogueRowField Field, FStringView Value);
+	FSGDialogueQuery& Where(ESGDialogueRowField Field, FSGNarrativeString Value);
+
+	FSGDialogueQuery& Quest(FStringView Value) { return Where(ESGDialogueRowField::Quest, Value); }
+	FSGDialogueQuery& Hub(FStringView Value) { return Where(ESGDialogueRowField::Hub, Value); }
+	FSGDialogueQuery& Speaker(FStringView Value) { return Where(ESGDialogueRowField::Speaker, Value); }
+};
+
+/**
+ * Dialogue table compiled once per Reload.
+ *
+ * Rows are stored flat and grouped by narrative id, so a node is a contiguous range that can be
+ * handed out as a view or as slot handles without copying. Row text lives in FSGNarrativeStringPool;
+ * MaterializeRow builds the Blueprint row struct for the rows a caller actually asks for.
+ *
+ * The graph is a structure-of-arrays node table: each narrative id gets a node index, `type` is
+ * resolved to ESGDialogueRowType, and edges (row -> next node, decision -> option rows) are stored
+ * as indices, so walking a conversation never hashes or compares strings. Dangling `next` ids and
+ * decisions without options are reported as compile diagnostics.
+ *
+ * Each row's JSON-like `conditions` / `checks` strings are parsed a single time into a flat
+ * instruction array, so evaluation never touches JSON, trims strings or builds FNames.
+ * Flag conditions are folded into required/forbidden bitmasks over FSGStateKeyRegistry slots.
+ * `set_flags` / `grants` become flat effect lists the same way.
+ *
+ * Identical predicates (many rows share `["ga_briefed"]` or `["academy_clearance>=1"]`) are compiled
+ * once, and on the game thread each predicate's result is cached against FSGStoryState::GetCacheVersion,
+ * so options sharing a predicate cost one evaluation per state change.
+ *
+ * A reverse index maps every flag and int slot to the rows whose conditions or checks read it,
+ * so a state change only has to re-evaluate those rows.
+ *
+ * Secondary indices map each quest, hub and speaker value to its rows as a sorted slot list;
+ * Query intersects them, starting from the shortest list.
+ */
+class SGNARRATIVE_API FSGCompiledDialogue
+{
+public:
+	FSGCompiledDialogue();
+
+	/** Drop all compiled rows. Rows stamped by a previous build stop resolving. */
+	void Reset();
+
+	/** Copy, group and compile table rows. Table order is kept within each id. */
+	void Build(const TArray<FSGDialogueDecisionRow*>& SourceRows);
+
+	/**
+	 * Materialize rows from a cooked database and take its precompiled programs (no JSON parsing).
+	 * Falls back to compiling the rows when the database carries no programs. False if it has no dialogue.
+	 */
+	bool BuildFromDatabase(const FSGNarrativeDatabase& Database);
+
+	/** Rows of a narrative id (prompt + options), viewing the index. Empty if unknown. */
+	TConstArrayView<FSGDialogueRowData> GetRows(FName Id) const;
+
+	const FSGDialogueRowData& GetRow(int32 Slot) const { return Rows[Slot]; }
+
+	/** Fill a Blueprint row from the pool and stamp it with Slot, so the Row-taking API resolves it. */
+	void MaterializeRow(int32 Slot, FSGDialogueDecisionRow& Out) const;
+
+	bool IsValidSlot(int32 Slot) const { return Rows.IsValidIndex(Slot); }
+	int32 NumRows() const { return Rows.Num(); }
+	int32 NumPredicates() const { return Predicates.Num(); }
+	uint32 GetSerial() const { return Serial; }
+
+	/** Heap held by the index containers (row text is in FSGNarrativeStringPool and not counted). */
+	SIZE_T GetAllocatedSize() const;
+
+	// --- Graph (all O(1)) ---
+
+	/** Node index for a narrative id, or INDEX_NONE. The only hashed lookup in a traversal. */
+	int32 FindNode(FName Id) const;
+
+	int32 NumNodes() const { return NodeIds.Num(); }
+	FName GetNodeId(int32 Node) const { return NodeIds[Node]; }
+	TConstArrayView<FSGDialogueRowData> GetNodeRows(int32 Node) const;
+	FSGRowRange GetNodeRange(int32 Node) const { return NodeRows[Node]; }
+
+	/** First non-option row of the node, else its first row. */
+	int32 GetNodePrimarySlot(int32 Node) const { return NodePrimarySlot[Node]; }
+
+	/** DECISION_OPTION row slots of the node, in table order. */
+	TConstArrayView<int32> GetNodeOptionSlots(int32 Node) const;
+
+	ESGDialogueRowType GetRowType(int32 Slot) const { return RowTypes[Slot]; }
+	int32 GetRowNode(int32 Slot) const { return RowNodes[Slot]; }
+
+	/** Node the row's `next` resolves to, or INDEX_NONE (no next, or dangling). */
+	int32 GetNextNode(int32 Slot) const { return RowNextNodes[Slot]; }
+
+	/** Rows whose conditions read a FSGStateKeyRegistry flag slot, in slot order. */
+	TConstArrayView<int32> GetFlagReaders(int32 FlagSlot) const { return GetReaders(FlagReaders, FlagSlot); }
+
+	/** Rows whose checks read a FSGStateKeyRegistry int slot, in slot order. */
+	TConstArrayView<int32> GetIntReaders(int32 IntSlot) const { return GetReaders(IntReaders, IntSlot); }
+
+	// --- Secondary indices ---
+
+	/** Slots of the rows whose Field equals Value, ascending. Empty if no row has it. */
+	TConstArrayView<int32> GetRowsWhere(ESGDialogueRowField Field, FSGNarrativeString Value) const;
+
+	/** Slots of the rows matching every term of Query, ascending. A query without terms returns every row. */
+	void Query(const FSGDialogueQuery& Query, TArray<int32>& OutSlots) const;
+
+	static FSGNarrativeString GetField(const FSGDialogueRowData& Row, ESGDialogueRowField Field);
+
+	/** Problems found while building (dangling next ids, decisions without options). */
+	const TArray<FString>& GetDiagnostics() const { return Diagnostics; }
+
+	static ESGDialogueRowType ParseRowType(const FString& Type);
+
+	/** Hierarchical tag conditions: keyed by tag name, with no registry slot. */
+	static bool IsFlagTagOp(ESGPredicateOp Op) { return Op == ESGPredicateOp::HasFlagTag || Op == ESGPredicateOp::NotFlagTag; }
+
+	/** Slot for a row that was stamped by this build and still matches its compiled source, or INDEX_NONE. */
+	int32 ResolveSlot(const FSGDialogueDecisionRow& Row) const;
+
+	bool EvalConditions(int32 Slot, const FSGStoryState& State) const;
+	bool EvalChecks(int32 Slot, const FSGStoryState& State) const;
+	void ApplyEffects(int32 Slot, FSGStoryState& State) const;
+
+	/** ApplyEffects, recording into OutEntry what actually changed (flags newly set, int old/new values). */
+	void ApplyEffects(int32 Slot, FSGStoryState& State, FSGStoryJournalEntry& OutEntry) const;
+
+	/** Slow path for rows that did not come out of this index (hand-built in Blueprint, stale after Reload). */
+	static bool EvalConditionsUncompiled(const FSGDialogueDecisionRow& Row, const FSGStoryState& State);
+	static bool EvalChecksUncompiled(const FSGDialogueDecisionRow& Row, const FSGStoryState& State);
+	static void ApplyEffectsUncompiled(const FSGDialogueDecisionRow& Row, FSGStoryState& State);
+
+	// --- Parsing helpers (compile time only) ---
+
+	static void ParseStringArrayJson(const FString& JsonLikeArray, TArray<FString>& Out);
+	static int32 ParseDelta(const FString& DeltaStr);
+
+	/** "flag" / "!flag". Returns false for empty entries. */
+	static bool CompileCondition(const FString& Raw, FSGPredicateInstr& Out);
+
+	/** key>=N, key<=N, key==N, key!=N, key>N, key<N. Returns false for unknown expressions (treated as permissive). */
+	static bool CompileCheck(const FString& Expr, FSGPredicateInstr& Out);
+
+	/** Parse one row's conditions, checks and effects into unfolded instruction lists (what the cook stores). */
+	static void CompileRowSource(const FSGDialogueDecisionRow& Row, TArray<FSGPredicateInstr>& OutConditions, TArray<FSGPredicateInstr>& OutChecks, TArray<FSGEffectInstr>& OutEffects);
+
+	/** Append the effects of `set_flags` then `grants` (rep, trust, xp, item, other numeric keys). */
+	static void CompileEffects(const FSGDialogueDecisionRow& Row, TArray<FSGEffectInstr>& Out);
+
+	static bool EvalInstr(const FSGPredicateInstr& Instr, const FSGStoryState& State);
+	static void ApplyInstr(const FSGEffectInstr& Instr, FSGStoryState& State);
+	static void ApplyInstr(const FSGEffectInstr& Instr, FSGStoryState& State, FSGStoryJournalEntry& OutEntry);
+
+private:
+	/** Cached rows, grouped by id; index == slot. */
+	TArray<FSGDialogueRowData> Rows;
+
+	// Per-row arrays, parallel to Rows.
+	TArray<FSGCompiledRow> Programs;
+	TArray<ESGDialogueRowType> RowTypes;
+	TArray<int32> RowNodes;
+	TArray<int32> RowNextNodes;
+
+	// Per-node arrays.
+	TMap<FName, int32> NodeByName;
+	TArray<FName> NodeIds;
+	TArray<FSGRowRange> NodeRows;
+	TArray<int32> NodePrimarySlot;
+	TArray<FSGRowRange> NodeOptions;
+
+	/** Option slots; NodeOptions ranges index into this. */
+	TArray<int32> OptionSlots;
+
+	/** Reverse index: registry slot -> range of ReaderSlots (rows reading that key). */
+	TArray<FSGRowRange> FlagReaders;
+	TArray<FSGRowRange> IntReaders;
+	TArray<int32> ReaderSlots;
+
+	/** Secondary indices: field value -> range of FieldSlots (rows with that value, ascending). */
+	TMap<FSGNarrativeString, FSGRowRange> FieldRows[(int32)ESGDialogueRowField::Num];
+	TArray<int32> FieldSlots;
+
+	TArray<FString> Diagnostics;
+
+	TArray<FSGCompiledPredicate> Predicates;
+	TArray<FSGPredicateInstr> Instrs;
+	TArray<FSGEffectInstr> Effects;
+	TArray<uint32> MaskWords;
+
+	/** Build only: predicate content hash -> predicates with that hash. */
+	TMultiMap<uint32, int32> PredicatesByHash;
+
+	/** Per predicate: state version the cached result belongs to (0 == none), and the result. Game thread only. */
+	mutable TArray<uint64> PredicateVersions;
+	mutable TBitArray<> PredicateResults;
+
+	/** Unique per build; rows carry it so stale copies are detected after Reload. */
+	uint32 Serial = 0;
+
+	void CompileRow(int32 Slot, const FSGDialogueDecisionRow& Source);
+	void EmitRow(int32 Slot, TConstArrayView<FSGPredicateInstr> Conditions, TConstArrayView<FSGPredicateInstr> Checks, TConstArrayView<FSGEffectInstr> RowEffects);
+	int32 AddPredicate(TConstArrayView<uint32> Required, TConstArrayView<uint32> Forbidden, TConstArrayView<FSGPredicateInstr> PredicateInstrs);
+	bool EvalPredicate(int32 Index, const FSGStoryState& State) const;
+	void FinishBuild();
+	void LinkGraph();
+	void IndexReaders();
+	void IndexFields();
+	TConstArrayView<int32> GetReaders(const TArray<FSGRowRange>& Readers, int32 KeySlot) const;
+	bool EvalRange(int32 Start, int32 Num, const FSGStoryState& State) const;
+};
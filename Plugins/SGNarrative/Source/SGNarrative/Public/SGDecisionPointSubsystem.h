@@ -4,8 +4,11 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Engine/DataTable.h"
 #include "SGDialogueTypes.h"
+#include "SGNarrativeAsync.h"
 #include "SGDecisionPointSubsystem.generated.h"
 
+class FSGNarrativeDatabase;
+
 /**
  * Decision Point helper: loads DT_DecisionPoints_v2_UE.csv (imported as a DataTable) and allows lookup by dp_id.
  */
@@ -20,6 +23,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|DecisionPoints")
 	void Reload();
 
+	/** Stream the table (or read the JSON fallback) and index it on a worker; current data stays live until OnReady. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|DecisionPoints")
+	void ReloadAsync();
+
+	/** Rebuild from Table instead of the configured table / JSON, ignoring the cooked database (tools, perf tests). */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|DecisionPoints")
+	void ReloadFromTable(UDataTable* Table);
+
+	/** True once the latest Reload / ReloadAsync has completed; false while a ReloadAsync is in flight. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|DecisionPoints")
+	bool IsReady() const { return bReady; }
+
+	/** Broadcast on the game thread each time a reload swaps in a new index. */
+	UPROPERTY(BlueprintAssignable, Category="Shattered Gods|DecisionPoints")
+	FSGNarrativeReadySignature OnReady;
+
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|DecisionPoints")
 	bool GetPrompt(const FString& DpId, FSGDecisionPointRow& OutPrompt) const;
 
@@ -29,6 +48,19 @@ public:
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|DecisionPoints")
 	UDataTable* GetDecisionPointsTable() const { return DecisionPointsTable; }
 
+	/** Prompt / option maps; built on a worker by ReloadAsync and by the narrative cook. */
+	struct FIndex
+	{
+		TMap<FString, FSGDecisionPointRow> PromptById;
+		TMap<FString, TArray<FSGDecisionPointRow>> OptionsById;
+	};
+
+	/** Index copies of the table rows (FSGNarrativeAsync::CopyRows), moved into Out. Options are sorted by option_key. Safe off the game thread. */
+	static void BuildIndexFromRows(TArray<FSGDecisionPointRow>&& Rows, FIndex& Out);
+
+	/** Fallback when no DataTable is configured: index the parsed JSON (DecisionPointsJson) directly. */
+	static void BuildIndexFromJson(const FString& RelPath, FIndex& Out);
+
 private:
 	UPROPERTY()
 	UDataTable* DecisionPointsTable = nullptr;
@@ -36,5 +68,16 @@ private:
 	TMap<FString, FSGDecisionPointRow> PromptById;
 	TMap<FString, TArray<FSGDecisionPointRow>> OptionsById;
 
+	/** Cooked database serving lookups in place of the maps above, when mounted. */
+	TSharedPtr<const FSGNarrativeDatabase> Database;
+
+	/** Bumped per reload so a slower, older ReloadAsync never overwrites a newer result. */
+	uint32 LoadRequest = 0;
+	bool bReady = false;
+
 	void BuildIndex();
+	void FinishLoad();
+
+	/** Use the cooked database if it has decision points; clears the source-table state. */
+	bool UseDatabase();
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "SGNarrativeStringPool.h"
+
+class FSGCompiledDialogue;
+
+/**
+ * Loads the assets a conversation is about to need before it gets there.
+ *
+ * From the current node it walks `next` edges and decision options (USGNarrativeSettings::PrefetchDepth
+ * edges deep) and requests each reachable row's `emotion` / `anim` asset and voice line through
+ * FStreamableManager, nearest nodes first. Requests stop at PrefetchBudgetMB: loaded assets count
+ * their measured size, pending ones the size seen last time (or the average so far). Assets of
+ * nodes that are no longer reachable, i.e. branches the player did not take, are released.
+ * Voice paths come from a format, so most rows may have none: only paths the asset registry knows
+ * are requested.
+ *
+ * Game thread only.
+ */
+class SGNARRATIVE_API FSGDialoguePrefetcher
+{
+public:
+	~FSGDialoguePrefetcher();
+
+	/** Hold the assets of the nodes reachable from Node and release all others. */
+	void Prefetch(const FSGCompiledDialogue& Compiled, int32 Node);
+
+	/** Cancel pending loads and release every handle (on Reload, since node indices change). */
+	void ReleaseAll();
+
+	/** Assets held (loading or loaded). */
+	int32 NumHeld() const { return Held.Num(); }
+
+	/** Measured size of the loaded held assets. */
+	int64 GetResidentBytes() const;
+
+	/** Asset paths of one row: emotion, anim and voice line (if the asset exists), as configured. */
+	void GetRowAssets(const FSGCompiledDialogue& Compiled, int32 Slot, TArray<FSoftObjectPath>& OutAssets);
+
+private:
+	struct FHeld
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+
+		/** Resource size once loaded, else -1. */
+		int64 Bytes = -1;
+	};
+
+	FStreamableManager Streamable;
+	TMap<FSoftObjectPath, FHeld> Held;
+
+	/** Sizes measured by earlier loads, used to budget requests before they complete. */
+	TMap<FSoftObjectPath, int64> KnownSizes;
+	int64 KnownBytesTotal = 0;
+
+	/**
+	 * USGNarrativeSettings emotion / anim assets per pooled row value (invalid path: none), filled as
+	 * values are first seen, so later rows are matched without hashing text.
+	 */
+	TMap<FSGNarrativeString, FSoftObjectPath> EmotionAssets;
+	TMap<FSGNarrativeString, FSoftObjectPath> AnimAssets;
+
+	/** Asset registry answers for formatted voice paths; cleared with the asset maps. */
+	TMap<FSoftObjectPath, bool> VoiceAssetExists;
+
+	/** Asset configured in Source for a row value; case-insensitive, like FName keys. Null if none. */
+	static const FSoftObjectPath* FindValueAsset(TMap<FSGNarrativeString, FSoftObjectPath>& Cache, const TMap<FName, FSoftObjectPath>& Source, FSGNarrativeString Value);
+	bool DoesVoiceAssetExist(const FSoftObjectPath& Path);
+	int64 EstimateBytes(const FSoftObjectPath& Path) const;
+	void OnLoaded(FSoftObjectPath Path);
+	void UpdateStats() const;
+};
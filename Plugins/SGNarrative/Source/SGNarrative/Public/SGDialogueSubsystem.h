@@ -5,8 +5,14 @@
 #include "Engine/DataTable.h"
 #include "SGDialogueTypes.h"
 #include "SGStoryState.h"
+#include "SGCompiledDialogue.h"
+#include "SGDialoguePrefetcher.h"
+#include "SGStorySnapshot.h"
+#include "SGNarrativeAsync.h"
 #include "SGDialogueSubsystem.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSGDecisionOptionsChangedSignature, FName, DecisionId);
+
 /**
  * Minimal, Blueprint-friendly dialogue/decision runtime.
  *
@@ -15,6 +21,14 @@
  * - Call GetRowsByNarrativeId(...) to fetch a node group.
  * - Present DIALOGUE rows to the player; when you hit a DECISION, call GetDecisionOptions(...)
  * - ApplyRowEffects(...) when a line/option is taken.
+ * - Decision widgets can WatchDecision(...) and bind OnDecisionOptionsChanged instead of polling;
+ *   call RefreshWatchedDecisions(...) after changing story state.
+ * - PublishStoryState(...) after each batch of effects lets other threads read the state
+ *   through GetStorySnapshot / MakeStoryReader.
+ *
+ * Native code should prefer the view/handle API (GetRowsView, FindNodeRow, GetDecisionOptionRows):
+ * it reads the index in place, with row text as FSGNarrativeStringPool handles. The Blueprint
+ * functions build FSGDialogueDecisionRow copies, and only for the rows they return.
  */
 UCLASS()
 class SGNARRATIVE_API USGDialogueSubsystem : public UGameInstanceSubsystem
@@ -28,6 +42,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
 	void Reload();
 
+	/** Stream the table and compile the index on a worker; the old index stays live until OnReady. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void ReloadAsync();
+
+	/** Rebuild from Table instead of the configured sources, ignoring the cooked database (tools, perf tests). */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void ReloadFromTable(UDataTable* Table);
+
+	/** True once the latest Reload / ReloadAsync has completed; false while a ReloadAsync is in flight. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
+	bool IsReady() const { return bReady; }
+
+	/** Broadcast on the game thread each time a reload swaps in a new index. */
+	UPROPERTY(BlueprintAssignable, Category="Shattered Gods|Dialogue")
+	FSGNarrativeReadySignature OnReady;
+
 	// --- Lookup ---
 
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
@@ -39,6 +69,128 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
 	bool GetDecisionOptions(FName DecisionId, const FSGStoryState& State, TArray<FSGDialogueDecisionRow>& OutOptions) const;
 
+	// --- Handle lookup (copies only the row you resolve) ---
+
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
+	int32 GetRowCount(FName Id) const { return GetRowsView(Id).Num(); }
+
+	/** True if at least one option of the decision passes conditions + checks. Copies nothing. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool HasDecisionOptions(FName DecisionId, const FSGStoryState& State) const;
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool GetDecisionOptionHandles(FName DecisionId, const FSGStoryState& State, TArray<FSGDialogueRowHandle>& OutHandles) const;
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool GetNodeRowHandle(FName Id, FSGDialogueRowHandle& OutHandle) const;
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool GetRowByHandle(const FSGDialogueRowHandle& Handle, FSGDialogueDecisionRow& OutRow) const;
+
+	/** Node type of an id (type of its node row); Unknown if the id is missing. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
+	ESGDialogueRowType GetNodeType(FName Id) const;
+
+	/** Apply a row's effects and follow its pre-resolved `next` edge to the next node row. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool ApplyRowAndGetNextNode(const FSGDialogueRowHandle& Row, UPARAM(ref) FSGStoryState& State, FSGDialogueRowHandle& OutNextNode) const;
+
+	/** Apply a row's effects and append what changed to Journal (for undo / replay). */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool ApplyRowJournaled(const FSGDialogueRowHandle& Row, UPARAM(ref) FSGStoryState& State, UPARAM(ref) FSGStoryJournal& Journal) const;
+
+	/** What-if: State after taking Row, leaving State untouched. Only the story-state chunks the row writes are copied. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool PreviewRowEffects(const FSGDialogueRowHandle& Row, const FSGStoryState& State, FSGStoryState& OutPreview) const;
+
+	// --- Secondary indices (quest / hub / speaker) ---
+
+	/**
+	 * Rows whose quest, hub and speaker match, in index order. An empty argument matches any value.
+	 * Answered from posting lists built at Reload; nothing scans the table.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool QueryRowHandles(const FString& Quest, const FString& Hub, const FString& Speaker, TArray<FSGDialogueRowHandle>& OutHandles) const;
+
+	/** Dangling `next` ids and decisions without options found by the last Reload. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
+	TArray<FString> GetCompileDiagnostics() const { return Compiled.GetDiagnostics(); }
+
+	// --- Asset prefetch ---
+
+	/**
+	 * Call when a conversation reaches Id: starts loading the emotion / anim / VO assets of the nodes
+	 * reachable from it (USGNarrativeSettings::PrefetchDepth) and releases those of branches not taken.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void PrefetchFromNode(FName Id);
+
+	/** Release every prefetched asset (e.g. when a conversation ends). */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void ReleasePrefetchedAssets() { Prefetcher.ReleaseAll(); }
+
+	// --- Watched decisions (incremental availability) ---
+
+	/** Cache which options of a decision are available in State; later changes are reported by OnDecisionOptionsChanged. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void WatchDecision(FName DecisionId, const FSGStoryState& State);
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void UnwatchDecision(FName DecisionId);
+
+	/**
+	 * Take State's pending changes and re-evaluate only the watched options whose conditions or checks
+	 * read a changed key, then broadcast OnDecisionOptionsChanged for each decision whose available set
+	 * changed. Always pass the same state the decisions were watched with.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void RefreshWatchedDecisions(UPARAM(ref) FSGStoryState& State);
+
+	/** Cached available options of a watched decision, without evaluating anything. False if not watched. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	bool GetWatchedOptionHandles(FName DecisionId, TArray<FSGDialogueRowHandle>& OutHandles) const;
+
+	UPROPERTY(BlueprintAssignable, Category="Shattered Gods|Dialogue")
+	FSGDecisionOptionsChangedSignature OnDecisionOptionsChanged;
+
+	// --- Published story state (reads from any thread) ---
+
+	/**
+	 * Make State the snapshot other threads read: call after each batch of ApplyRowEffects on the
+	 * live state (a row, a conversation step, a load). Cheap when nothing changed since the last call.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
+	void PublishStoryState(const FSGStoryState& State) { StoryPublisher->Publish(State); }
+
+	/** Copy of the last published state. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
+	FSGStoryState GetPublishedStoryState() const { return *StoryPublisher->Get(); }
+
+	/** Any thread: the last published state, immutable while held. */
+	FSGStoryStateSnapshot GetStorySnapshot() const { return StoryPublisher->Get(); }
+
+	/** A cached reader for one worker; it keeps the publisher alive, so it may outlive this subsystem. */
+	FSGStorySnapshotReader MakeStoryReader() const { return FSGStorySnapshotReader(StoryPublisher); }
+
+	// --- Native zero-copy access (valid until the next Reload) ---
+
+	/** All rows of a narrative id, viewing the index. */
+	TConstArrayView<FSGDialogueRowData> GetRowsView(FName Id) const { return Compiled.GetRows(Id); }
+
+	/** The node row for an id: first non-option row, else the first row. */
+	const FSGDialogueRowData* FindNodeRow(FName Id) const;
+
+	/** Available options of a decision, as pointers into the index. */
+	bool GetDecisionOptionRows(FName DecisionId, const FSGStoryState& State, TArray<const FSGDialogueRowData*>& OutOptions) const;
+
+	const FSGDialogueRowData* ResolveHandle(const FSGDialogueRowHandle& Handle) const;
+
+	/** Row slots matching every term of Query (see FSGDialogueQuery), ascending. */
+	void QueryRows(const FSGDialogueQuery& Query, TArray<int32>& OutSlots) const { Compiled.Query(Query, OutSlots); }
+
+	/** The compiled index (node table, edges, programs). Valid until the next Reload. */
+	const FSGCompiledDialogue& GetCompiled() const { return Compiled; }
+
 	// --- Evaluation / application ---
 
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
@@ -54,7 +206,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Dialogue")
 	bool ApplyRowAndGetNext(const FSGDialogueDecisionRow& Row, UPARAM(ref) FSGStoryState& State, FName& OutNextId) const;
 
-	/** Data access for UI debugging. */
+	/** Data access for UI debugging. Null when rows come from the cooked narrative database. */
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Dialogue")
 	UDataTable* GetDialogueDecisionTable() const { return DialogueDecisionTable; }
 
@@ -62,12 +214,42 @@ private:
 	UPROPERTY()
 	UDataTable* DialogueDecisionTable = nullptr;
 
-	/** Cache: narrative id -> rows (including prompt + options). */
-	TMap<FName, TArray<FSGDialogueDecisionRow>> RowsById;
+	/** Cache: rows grouped by narrative id (prompt + options), plus their compiled programs. */
+	FSGCompiledDialogue Compiled;
 
-	void BuildIndex();
+	/** Assets requested for the nodes ahead of the last PrefetchFromNode. */
+	FSGDialoguePrefetcher Prefetcher;
+
+	/** Shared so worker readers can hold it past Deinitialize. */
+	TSharedRef<FSGStorySnapshotPublisher, ESPMode::ThreadSafe> StoryPublisher = MakeShared<FSGStorySnapshotPublisher, ESPMode::ThreadSafe>();
 
-	static void ParseStringArrayJson(const FString& JsonLikeArray, TArray<FString>& Out);
-	static bool EvalSimpleCheck(const FString& Expr, const FSGStoryState& State);
-	static int32 ParseDelta(const FString& DeltaStr);
+	/** Bumped per reload so a slower, older ReloadAsync never overwrites a newer result. */
+	uint32 LoadRequest = 0;
+	bool bReady = false;
+
+	/** Watched decision ids; nodes are re-resolved against each new index. */
+	TArray<FName> WatchedDecisions;
+
+	/** Bit per node: watched. Bit per row slot: cached availability of a watched option. */
+	TBitArray<> WatchedNodes;
+	TBitArray<> OptionAvailable;
+
+	/** Set when a reload replaced the index; the next refresh re-evaluates and reports every watched decision. */
+	bool bWatchesStale = false;
+
+	/** Set when a reload may have registered new keys; the next refresh adopts them into the state's slots. */
+	bool bAdoptKeys = false;
+
+	void FinishLoad();
+	bool IsAvailableOption(int32 Slot, const FSGStoryState& State) const;
+
+	/** Apply a compiled row's effects, with stats and a trace event. */
+	void ApplySlot(int32 Slot, FSGStoryState& State) const;
+	FSGDialogueRowHandle MakeHandle(int32 Slot) const;
+
+	/** Re-evaluate one watched option; true if its cached availability flipped. */
+	bool UpdateWatchedOption(int32 Slot, const FSGStoryState& State);
+	void ResetWatches();
+
+	void BuildIndex();
 };
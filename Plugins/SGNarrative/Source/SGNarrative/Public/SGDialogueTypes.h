@@ -4,6 +4,16 @@
 #include "Engine/DataTable.h"
 #include "SGDialogueTypes.generated.h"
 
+/** Resolved form of FSGDialogueDecisionRow::type. */
+UENUM(BlueprintType)
+enum class ESGDialogueRowType : uint8
+{
+	Dialogue,
+	Decision,
+	DecisionOption,
+	Unknown,
+};
+
 /**
  * Dialogue + decision table row.
  * Property names intentionally match the CSV headers for easy import.
@@ -51,7 +61,7 @@ struct SGNARRATIVE_API FSGDialogueDecisionRow : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	FString checks;
 
-	/** Stored as JSON-like string array in the CSV */
+	/** Stored as JSON-like string array in the CSV (ex: ["flag_a", "!flag_b", "ga.*"]; `x.*` is any flag under SG.Flag.x) */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	FString conditions;
 
@@ -65,6 +75,31 @@ struct SGNARRATIVE_API FSGDialogueDecisionRow : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	FName next;
+
+	/**
+	 * Runtime only (not serialized): slot in the compiled dialogue index this copy came from.
+	 * Copies keep it, so FSGCompiledDialogue::ResolveSlot also checks id, conditions, checks,
+	 * set_flags and grants against the compiled row; an edited copy is evaluated uncompiled.
+	 */
+	int32 CompiledSlot = INDEX_NONE;
+
+	/** Runtime only (not serialized): build serial of the index that assigned CompiledSlot. */
+	uint32 CompiledSerial = 0;
+};
+
+/**
+ * Lightweight handle to a row inside USGDialogueSubsystem's index.
+ * Resolve with GetRowByHandle; handles go stale on Reload.
+ */
+USTRUCT(BlueprintType)
+struct SGNARRATIVE_API FSGDialogueRowHandle
+{
+	GENERATED_BODY()
+
+	int32 Slot = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsSet() const { return Slot != INDEX_NONE; }
 };
 
 USTRUCT(BlueprintType)
@@ -0,0 +1,116 @@
+// Generated by the SGNarrativeKeys commandlet from the narrative data. Do not edit by hand; re-run
+//   UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeKeys
+// after adding or renaming story keys.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGStoryState.h"
+
+/** Story keys known at compile time. Each constant is the key's FSGStateKeyRegistry slot. */
+namespace SGKeys
+{
+	inline constexpr int32 NumFlags = 30;
+
+	inline constexpr const TCHAR* FlagNames[NumFlags > 0 ? NumFlags : 1] =
+	{
+		TEXT("as_hook"),
+		TEXT("as_public_expose"),
+		TEXT("as_quiet_expose"),
+		TEXT("ga_briefed"),
+		TEXT("ga_ghost_route"),
+		TEXT("ga_help_clean"),
+		TEXT("ga_help_dirty"),
+		TEXT("ga_published_full"),
+		TEXT("ga_published_partial"),
+		TEXT("ga_refused"),
+		TEXT("ga_sold_file"),
+		TEXT("kv_hook"),
+		TEXT("kv_saghir_carry"),
+		TEXT("kv_to_academy"),
+		TEXT("kv_to_palace"),
+		TEXT("kv_to_underbelly"),
+		TEXT("kv_xal_carry"),
+		TEXT("lk_hook"),
+		TEXT("lk_public"),
+		TEXT("lk_quiet"),
+		TEXT("oo_blood_paid"),
+		TEXT("oo_memory_paid"),
+		TEXT("oo_seen"),
+		TEXT("pp_hook"),
+		TEXT("saghir_praised"),
+		TEXT("sm_bribe"),
+		TEXT("sm_fight"),
+		TEXT("sm_hook"),
+		TEXT("sm_lorin"),
+		TEXT("sm_vessa"),
+	};
+
+	inline constexpr FSGFlagKey as_hook{ 0 };
+	inline constexpr FSGFlagKey as_public_expose{ 1 };
+	inline constexpr FSGFlagKey as_quiet_expose{ 2 };
+	inline constexpr FSGFlagKey ga_briefed{ 3 };
+	inline constexpr FSGFlagKey ga_ghost_route{ 4 };
+	inline constexpr FSGFlagKey ga_help_clean{ 5 };
+	inline constexpr FSGFlagKey ga_help_dirty{ 6 };
+	inline constexpr FSGFlagKey ga_published_full{ 7 };
+	inline constexpr FSGFlagKey ga_published_partial{ 8 };
+	inline constexpr FSGFlagKey ga_refused{ 9 };
+	inline constexpr FSGFlagKey ga_sold_file{ 10 };
+	inline constexpr FSGFlagKey kv_hook{ 11 };
+	inline constexpr FSGFlagKey kv_saghir_carry{ 12 };
+	inline constexpr FSGFlagKey kv_to_academy{ 13 };
+	inline constexpr FSGFlagKey kv_to_palace{ 14 };
+	inline constexpr FSGFlagKey kv_to_underbelly{ 15 };
+	inline constexpr FSGFlagKey kv_xal_carry{ 16 };
+	inline constexpr FSGFlagKey lk_hook{ 17 };
+	inline constexpr FSGFlagKey lk_public{ 18 };
+	inline constexpr FSGFlagKey lk_quiet{ 19 };
+	inline constexpr FSGFlagKey oo_blood_paid{ 20 };
+	inline constexpr FSGFlagKey oo_memory_paid{ 21 };
+	inline constexpr FSGFlagKey oo_seen{ 22 };
+	inline constexpr FSGFlagKey pp_hook{ 23 };
+	inline constexpr FSGFlagKey saghir_praised{ 24 };
+	inline constexpr FSGFlagKey sm_bribe{ 25 };
+	inline constexpr FSGFlagKey sm_fight{ 26 };
+	inline constexpr FSGFlagKey sm_hook{ 27 };
+	inline constexpr FSGFlagKey sm_lorin{ 28 };
+	inline constexpr FSGFlagKey sm_vessa{ 29 };
+
+	inline constexpr int32 NumInts = 15;
+
+	inline constexpr const TCHAR* IntNames[NumInts > 0 ? NumInts : 1] =
+	{
+		TEXT("academy_clearance"),
+		TEXT("arena_rank"),
+		TEXT("item_arena_pass_vip"),
+		TEXT("item_coin_purse_heavy"),
+		TEXT("item_coin_purse_light"),
+		TEXT("item_promissory_guild"),
+		TEXT("rep_academy"),
+		TEXT("rep_arena"),
+		TEXT("rep_city"),
+		TEXT("rep_guild"),
+		TEXT("rep_palace"),
+		TEXT("rep_temples"),
+		TEXT("rep_underbelly"),
+		TEXT("trust_saghir"),
+		TEXT("xp"),
+	};
+
+	inline constexpr FSGIntKey academy_clearance{ 0 };
+	inline constexpr FSGIntKey arena_rank{ 1 };
+	inline constexpr FSGIntKey item_arena_pass_vip{ 2 };
+	inline constexpr FSGIntKey item_coin_purse_heavy{ 3 };
+	inline constexpr FSGIntKey item_coin_purse_light{ 4 };
+	inline constexpr FSGIntKey item_promissory_guild{ 5 };
+	inline constexpr FSGIntKey rep_academy{ 6 };
+	inline constexpr FSGIntKey rep_arena{ 7 };
+	inline constexpr FSGIntKey rep_city{ 8 };
+	inline constexpr FSGIntKey rep_guild{ 9 };
+	inline constexpr FSGIntKey rep_palace{ 10 };
+	inline constexpr FSGIntKey rep_temples{ 11 };
+	inline constexpr FSGIntKey rep_underbelly{ 12 };
+	inline constexpr FSGIntKey trust_saghir{ 13 };
+	inline constexpr FSGIntKey xp{ 14 };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "SGNarrativeAsync.generated.h"
+
+/** Fired by the narrative subsystems when a Reload / ReloadAsync has swapped in fresh data. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FSGNarrativeReadySignature);
+
+/**
+ * Async Reload plumbing shared by the narrative subsystems.
+ *
+ * The pattern is: stream the DataTable on the game thread, parse/index on a background task,
+ * then swap the finished index in on the game thread. Only the swap touches subsystem state.
+ */
+struct SGNARRATIVE_API FSGNarrativeAsync
+{
+	typedef TFunction<void(UDataTable* /*Table*/)> FOnTableLoaded;
+
+	/**
+	 * Stream a soft DataTable reference. OnLoaded runs on the game thread with the table, or null if
+	 * unset or missing. Pin the table (TStrongObjectPtr) if rows are read after OnLoaded returns.
+	 */
+	static void LoadTable(const TSoftObjectPtr<UDataTable>& Table, FOnTableLoaded OnLoaded);
+
+	/**
+	 * Copy every row of Table (empty if null). Call on the game thread and hand the copies to the
+	 * worker: an edit or reimport can change the table's row memory while the worker runs.
+	 */
+	template <typename RowType>
+	static TArray<RowType> CopyRows(const UDataTable* Table, const TCHAR* Context)
+	{
+		TArray<RowType> Copies;
+		if (Table)
+		{
+			TArray<RowType*> TableRows;
+			Table->GetAllRows(FString(Context), TableRows);
+
+			Copies.Reserve(TableRows.Num());
+			for (const RowType* Row : TableRows)
+			{
+				Copies.Add(*Row);
+			}
+		}
+		return Copies;
+	}
+
+	/** Run Work on a background task, then Finish on the game thread. */
+	static void Run(TUniqueFunction<void()>&& Work, TUniqueFunction<void()>&& Finish);
+
+	/** Read a ProjectDir-relative text file (empty path or missing file -> false). Safe off the game thread. */
+	static bool LoadProjectFile(const FString& RelPath, FString& OutText);
+};
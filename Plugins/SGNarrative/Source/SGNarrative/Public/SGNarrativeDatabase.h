@@ -0,0 +1,233 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGCompiledDialogue.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Cooked narrative database (.sgdb) layout.
+ *
+ * One little-endian blob written by the SGNarrativeCook commandlet: a header, a section table and
+ * 8-byte aligned sections. Everything is plain offsets and indices so the runtime can read it
+ * straight out of a memory-mapped file.
+ *
+ * - Strings: every distinct string once (UTF-16), addressed by id; id 0 is the empty string.
+ * - Lists: string-id lists for TArray<FString> fields ([Count, Id...] runs).
+ * - Tables: fixed-width rows (one uint32 cell per field) plus a prebuilt key -> row range hash index.
+ * - Dialogue programs: the FSGCompiledDialogue predicate/effect programs, keys stored as string ids.
+ */
+enum class ESGNarrativeDbSection : uint32
+{
+	Strings,
+	Lists,
+	DialogueTable,
+	DecisionPromptTable,
+	DecisionOptionTable,
+	CinematicShotTable,
+	QuestSummaryTable,
+	QuestDetailsTable,
+	QuestBranchTable,
+	DialoguePrograms,
+	DialogueInstrs,
+	DialogueEffects,
+	Count,
+};
+
+/** How a table cell is stored; cells are always 4 bytes. */
+enum class ESGNarrativeDbField : uint32
+{
+	String,		// string id (FString)
+	Name,		// string id (FName)
+	Int,		// int32
+	Float,		// float bits
+	Bool,		// 0 / 1
+	StringList,	// offset into Lists (TArray<FString>)
+};
+
+struct FSGNarrativeDbHeader
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 TotalSize = 0;
+	uint32 NumSections = 0;
+	uint32 Reserved = 0;
+};
+
+struct FSGNarrativeDbSection
+{
+	uint32 Type = 0;
+	uint32 Reserved = 0;
+	uint64 Offset = 0;
+	uint64 Size = 0;
+};
+
+struct FSGNarrativeDbStrings
+{
+	uint32 NumStrings = 0;
+	uint32 Reserved = 0;
+	// uint32 Offsets[NumStrings + 1] (in characters), then UTF-16 character data.
+};
+
+struct FSGNarrativeDbTableHeader
+{
+	uint32 NumFields = 0;
+	uint32 NumRows = 0;
+	uint32 NumKeys = 0;
+	uint32 NumBuckets = 0;
+	// uint32 FieldNames[NumFields], ESGNarrativeDbField FieldKinds[NumFields], uint32 Cells[NumRows * NumFields],
+	// FSGNarrativeDbKey Keys[NumKeys], uint32 Buckets[NumBuckets] (key index + 1, 0 == empty; power of two).
+};
+
+struct FSGNarrativeDbKey
+{
+	uint32 Key = 0;
+	uint32 Hash = 0;
+	uint32 Start = 0;
+	uint32 Num = 0;
+};
+
+/** Per dialogue row, in DialogueTable row order. */
+struct FSGNarrativeDbProgram
+{
+	uint32 ConditionStart = 0;
+	uint32 ConditionNum = 0;
+	uint32 CheckStart = 0;
+	uint32 CheckNum = 0;
+	uint32 EffectStart = 0;
+	uint32 EffectNum = 0;
+};
+
+/** Predicate or effect instruction; Value is the operand / delta, Key a string id. */
+struct FSGNarrativeDbInstr
+{
+	uint32 Op = 0;
+	int32 Value = 0;
+	uint32 Key = 0;
+};
+
+/**
+ * Read-only view of one cooked table. Rows are materialized into the matching UStruct on demand;
+ * fields are matched by property name, so a schema change only leaves the new fields defaulted.
+ * The match is made once, when the database is mounted, for the struct the table was cooked from.
+ */
+class SGNARRATIVE_API FSGNarrativeDbTable
+{
+public:
+	bool IsValid() const { return Header != nullptr; }
+	int32 Num() const { return Header ? (int32)Header->NumRows : 0; }
+
+	/** Row range stored under Key (case-insensitive), or an empty range. */
+	FSGRowRange Find(FStringView Key) const;
+	FSGRowRange Find(FName Key) const;
+
+	/** Copy row Index into a struct of the type the table was cooked from. */
+	void ReadRow(int32 Index, const UScriptStruct* Struct, void* OutRow) const;
+
+	template <typename RowType>
+	void ReadRow(int32 Index, RowType& OutRow) const
+	{
+		ReadRow(Index, RowType::StaticStruct(), &OutRow);
+	}
+
+	/** Raw cell access for native readers that don't need the full struct. */
+	uint32 GetCell(int32 Index, int32 Field) const { return Cells[Index * Header->NumFields + Field]; }
+	int32 FindField(FName FieldName) const;
+
+	/** A struct property and the field it is read from; the property type fits the field kind. */
+	struct FFieldBinding
+	{
+		FProperty* Property = nullptr;
+		int32 Field = INDEX_NONE;
+		ESGNarrativeDbField Kind = ESGNarrativeDbField::String;
+	};
+
+	/** Match Struct's properties to fields by name. Fields whose kind does not fit the property are skipped with a warning. */
+	void BindFields(const UScriptStruct* Struct, TArray<FFieldBinding>& OutBindings) const;
+
+private:
+	friend class FSGNarrativeDatabase;
+
+	/** Row struct the table was cooked from, and its bindings (built at mount). */
+	const UScriptStruct* BoundStruct = nullptr;
+	TArray<FFieldBinding> Bindings;
+
+	void ReadCells(const uint32* Row, TConstArrayView<FFieldBinding> RowBindings, void* OutRow) const;
+
+	const class FSGNarrativeDatabase* Database = nullptr;
+	const FSGNarrativeDbTableHeader* Header = nullptr;
+	const uint32* FieldNames = nullptr;
+	const uint32* FieldKinds = nullptr;
+	const uint32* Cells = nullptr;
+	const FSGNarrativeDbKey* Keys = nullptr;
+	const uint32* Buckets = nullptr;
+};
+
+/**
+ * Memory-mapped cooked narrative database.
+ *
+ * Mounting validates the header and section bounds and nothing else: strings, rows and indices are
+ * read in place, so there is no parse step and no second copy of the data on the heap. Subsystems
+ * use it in place of their DataTables + JSON when USGNarrativeSettings::NarrativeDatabaseFile exists.
+ */
+class SGNARRATIVE_API FSGNarrativeDatabase
+{
+public:
+	static constexpr uint32 Magic = 0x42444753; // "SGDB"
+	static constexpr uint32 Version = 1;
+
+	~FSGNarrativeDatabase();
+
+	/** Case-insensitive FNV-1a over a table key, matching FName comparison rules. */
+	static uint32 HashKey(FStringView Key);
+
+	/** Map (or, where mapping is unsupported, read) a database file. Null if missing or invalid. */
+	static TSharedPtr<const FSGNarrativeDatabase> Mount(const FString& AbsPath);
+
+	/** Database named by USGNarrativeSettings, mounted on first use and shared by all subsystems. */
+	static TSharedPtr<const FSGNarrativeDatabase> GetProjectDatabase();
+
+	/** Drop the shared database so the next GetProjectDatabase remounts (after a re-cook). */
+	static void ResetProjectDatabase();
+
+	int32 NumStrings() const { return Strings ? (int32)Strings->NumStrings : 0; }
+	FStringView GetString(uint32 Id) const;
+
+	/** A TArray<FString> cell: Count followed by string ids. */
+	TConstArrayView<uint32> GetList(uint32 Offset) const;
+
+	const FSGNarrativeDbTable& GetTable(ESGNarrativeDbSection Table) const { return Tables[(int32)Table]; }
+
+	TConstArrayView<FSGNarrativeDbProgram> GetDialoguePrograms() const { return Programs; }
+	TConstArrayView<FSGNarrativeDbInstr> GetDialogueInstrs() const { return Instrs; }
+	TConstArrayView<FSGNarrativeDbInstr> GetDialogueEffects() const { return Effects; }
+
+private:
+	FSGNarrativeDatabase() = default;
+
+	bool Init(const uint8* InData, uint64 InSize);
+	bool InitTable(ESGNarrativeDbSection Type, const uint8* SectionData, uint64 SectionSize);
+
+	// Exactly one of Mapped/Loaded backs Data.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> Loaded;
+
+	const uint8* Data = nullptr;
+	uint64 Size = 0;
+
+	const FSGNarrativeDbStrings* Strings = nullptr;
+	const uint32* StringOffsets = nullptr;
+	const TCHAR* StringChars = nullptr;
+	uint32 NumStringChars = 0;
+
+	const uint32* Lists = nullptr;
+	uint32 NumListWords = 0;
+
+	FSGNarrativeDbTable Tables[(int32)ESGNarrativeDbSection::Count];
+
+	TConstArrayView<FSGNarrativeDbProgram> Programs;
+	TConstArrayView<FSGNarrativeDbInstr> Instrs;
+	TConstArrayView<FSGNarrativeDbInstr> Effects;
+};
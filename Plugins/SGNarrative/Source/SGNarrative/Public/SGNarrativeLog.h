@@ -0,0 +1,5 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+SGNARRATIVE_API DECLARE_LOG_CATEGORY_EXTERN(LogSGNarrative, Log, All);
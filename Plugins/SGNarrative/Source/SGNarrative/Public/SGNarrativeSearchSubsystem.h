@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "SGNarrativeTextIndex.h"
+#include "SGNarrativeSearchSubsystem.generated.h"
+
+class UDataTable;
+
+/**
+ * Full-text search over every narrative table, for writers and QA (editor, PIE, commandlets).
+ *
+ * Indexes `line_or_prompt` / `option_text` (dialogue), `dialogue` (main quest lines, optional prompts)
+ * and `prompt_text` / `option_text` (decision points) from the tables in USGNarrativeSettings.
+ * Nothing is indexed until the first search. Reload, and in the editor any edit to one of the tables,
+ * re-reads the sources and re-tokenizes only the lines that changed.
+ *
+ * Console: `SGNarrative.Search <words>` and `SGNarrative.SearchText <substring>`.
+ */
+UCLASS()
+class SGNARRATIVE_API USGNarrativeSearchSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Re-read every source now, updating only lines that were added, edited or removed. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Search")
+	void Reload();
+
+	/** Lines containing every word of Query, case-insensitive. MaxHits <= 0: no limit. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Search")
+	void FindWords(const FString& Query, int32 MaxHits, TArray<FSGNarrativeSearchHit>& OutHits);
+
+	/** Lines containing Query anywhere (case-insensitive), answered from the trigram index. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Search")
+	void FindSubstring(const FString& Query, int32 MaxHits, TArray<FSGNarrativeSearchHit>& OutHits);
+
+	/** The index, brought up to date first. */
+	const FSGNarrativeTextIndex& GetIndex();
+
+	/** Searchable lines of one source, read from the configured table (decision points fall back to DecisionPointsJson). */
+	static void CollectEntries(ESGNarrativeTextSource Source, TArray<FSGNarrativeTextEntry>& OutEntries, UDataTable** OutTable = nullptr);
+
+private:
+	FSGNarrativeTextIndex Index;
+
+	/** Bit per ESGNarrativeTextSource: re-read before the next search. All set until the first search. */
+	uint32 StaleSources = ~0u;
+
+	void RefreshStale();
+
+#if WITH_EDITOR
+	/** Tables whose change delegate we are bound to, per source. */
+	TWeakObjectPtr<UDataTable> WatchedTables[(int32)ESGNarrativeTextSource::Num];
+	FDelegateHandle WatchHandles[(int32)ESGNarrativeTextSource::Num];
+
+	void WatchTable(ESGNarrativeTextSource Source, UDataTable* Table);
+	void UnwatchTables();
+#endif
+};
@@ -51,5 +51,52 @@ public:
     UPROPERTY(config, EditAnywhere, Category="Data")
     FString DecisionPointsJson;
 
+    /** Markdown notes file (relative to ProjectDir) listing known story keys; seeds FSGStateKeyRegistry. */
+    UPROPERTY(config, EditAnywhere, Category="Data")
+    FString StateKeysFile;
+
+    /**
+     * Keep each story state's set flags mirrored as SG.Flag.* gameplay tags (FSGStoryState::FlagTags), so
+     * hierarchical flag conditions (`ga.*`) and tag queries are a container lookup instead of a walk over
+     * every set flag. Costs a tag add/remove per flag write and the container in every state copy.
+     */
+    UPROPERTY(config, EditAnywhere, Category="Data")
+    bool bMirrorFlagsToGameplayTags = false;
+
+    /**
+     * Cooked narrative database (relative to ProjectDir), written by the SGNarrativeCook commandlet.
+     * When the file exists it replaces the DataTables and JSON files above; otherwise they are used as before.
+     */
+    UPROPERTY(config, EditAnywhere, Category="Data")
+    FString NarrativeDatabaseFile;
+
+    /** Editor sessions keep reading the source tables unless this is set, so edits are not hidden by a stale cook. */
+    UPROPERTY(config, EditAnywhere, Category="Data")
+    bool bUseNarrativeDatabaseInEditor = false;
+
+    /** Load and index narrative data off the game thread at startup; subsystems fire OnReady when done. */
+    UPROPERTY(config, EditAnywhere, Category="Loading")
+    bool bLoadAsync = true;
+
+    /** Dialogue prefetch: how many `next` / option edges past the current node to load assets for (0 disables). */
+    UPROPERTY(config, EditAnywhere, Category="Prefetch", meta=(ClampMin="0"))
+    int32 PrefetchDepth = 2;
+
+    /** Memory prefetched assets may hold, in MB. Nearer nodes are requested first; the rest wait for the next node. */
+    UPROPERTY(config, EditAnywhere, Category="Prefetch", meta=(ClampMin="0"))
+    int32 PrefetchBudgetMB = 64;
+
+    /** Asset to load for each `emotion` value (face pose, montage...). Keys match row values case-insensitively. */
+    UPROPERTY(config, EditAnywhere, Category="Prefetch")
+    TMap<FName, FSoftObjectPath> EmotionAssets;
+
+    /** Asset to load for each `anim` value. Keys match row values case-insensitively. */
+    UPROPERTY(config, EditAnywhere, Category="Prefetch")
+    TMap<FName, FSoftObjectPath> AnimAssets;
+
+    /** Object path of a row's voice line, with {id} and {option_key} filled in (e.g. /Game/Audio/VO/{id}.{id}). Empty: no VO. */
+    UPROPERTY(config, EditAnywhere, Category="Prefetch")
+    FString VoiceAssetPathFormat;
+
     virtual FName GetCategoryName() const override { return FName("Project"); }
 };
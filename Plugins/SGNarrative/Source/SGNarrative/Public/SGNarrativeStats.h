@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+/** `stat SGNarrative`: where narrative frame time and memory go. */
+DECLARE_STATS_GROUP(TEXT("SGNarrative"), STATGROUP_SGNarrative, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Index"), STAT_SGNarrative_BuildIndex, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate Options"), STAT_SGNarrative_EvalOptions, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Effects"), STAT_SGNarrative_ApplyEffects, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Quest JSON Load"), STAT_SGNarrative_QuestJsonLoad, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cinematics Lookup"), STAT_SGNarrative_CinematicsLookup, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish State"), STAT_SGNarrative_PublishState, STATGROUP_SGNarrative, SGNARRATIVE_API);
+
+/** Container memory of each index, set when a load finishes (row text in FStrings is not counted). */
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Dialogue Index"), STAT_SGNarrative_DialogueIndexMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("String Pool"), STAT_SGNarrative_StringPoolMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Cinematics Index"), STAT_SGNarrative_CinematicsIndexMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Decision Points Index"), STAT_SGNarrative_DecisionPointsIndexMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Quest Details"), STAT_SGNarrative_QuestDetailsMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Text Search Index"), STAT_SGNarrative_TextIndexMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Prefetched Assets"), STAT_SGNarrative_PrefetchMemory, STATGROUP_SGNarrative, SGNARRATIVE_API);
+
+#if UE_TRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(SGNarrativeChannel, SGNARRATIVE_API);
+#endif
+
+/**
+ * Events on the SGNarrative trace channel (`-trace=default,SGNarrative`): one per row applied and
+ * one per decision shown, each with FPlatformTime::Cycles64 start/end stamps, so narrative hitches
+ * line up with everything else in an Insights capture.
+ *
+ * Begin() returns 0 while the channel is off, and the event functions do nothing for a 0 start,
+ * so call sites cost one branch when nobody is tracing.
+ */
+class SGNARRATIVE_API FSGNarrativeTrace
+{
+public:
+#if UE_TRACE_ENABLED
+	static uint64 Begin() { return UE_TRACE_CHANNELEXPR_IS_ENABLED(SGNarrativeChannel) ? FPlatformTime::Cycles64() : 0; }
+
+	static void RowApplied(uint64 StartCycle, FName RowId, FStringView OptionKey);
+	static void DecisionShown(uint64 StartCycle, FName DecisionId, int32 NumOptions, int32 NumAvailable);
+#else
+	static uint64 Begin() { return 0; }
+
+	static void RowApplied(uint64 StartCycle, FName RowId, FStringView OptionKey) {}
+	static void DecisionShown(uint64 StartCycle, FName DecisionId, int32 NumOptions, int32 NumAvailable) {}
+#endif
+};
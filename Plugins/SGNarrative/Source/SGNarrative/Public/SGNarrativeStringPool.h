@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+#include <atomic>
+
+/**
+ * Handle to a string in FSGNarrativeStringPool. Id 0 is the empty string.
+ *
+ * Interning is exact (case-sensitive), so two handles are equal iff their strings are.
+ */
+struct FSGNarrativeString
+{
+	uint32 Id = 0;
+
+	bool IsEmpty() const { return Id == 0; }
+	bool operator==(FSGNarrativeString Other) const { return Id == Other.Id; }
+	bool operator!=(FSGNarrativeString Other) const { return Id != Other.Id; }
+
+	/** The pooled characters (null-terminated); valid for the lifetime of the process. */
+	SGNARRATIVE_API FStringView View() const;
+	SGNARRATIVE_API FString ToString() const;
+
+	friend uint32 GetTypeHash(FSGNarrativeString Handle) { return Handle.Id; }
+};
+
+/**
+ * Process-wide pool for the narrative text that repeats across rows (quest, hub, speaker,
+ * emotion, anim...).
+ *
+ * Each distinct string is stored once in append-only character blocks, so handles and the views
+ * they resolve to stay valid across Reloads, like FSGStateKeyRegistry slots. Indexed rows hold
+ * handles; Blueprint-facing row structs are filled from the pool only when a caller asks for one.
+ *
+ * Nothing is ever freed, so the pool is bounded by the distinct strings interned over the whole
+ * process, not by the current tables. A Reload of unchanged data adds nothing; only strings edited
+ * in (editor reimports, hot-reloaded databases) accumulate, which is why the pool is not reset.
+ *
+ * Resolve takes no lock: views live in fixed pages that are published once and never move.
+ */
+class SGNARRATIVE_API FSGNarrativeStringPool
+{
+public:
+	static FSGNarrativeStringPool& Get();
+
+	/** Handle for Str, adding it on first use. Thread-safe. */
+	FSGNarrativeString Intern(FStringView Str);
+
+	/** Handle for an already pooled string, or the empty handle. */
+	FSGNarrativeString Find(FStringView Str) const;
+
+	FStringView Resolve(FSGNarrativeString Handle) const;
+
+	/** Distinct strings, including the empty string. */
+	int32 Num() const;
+
+	/** Character blocks + index, for memory reports. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	FSGNarrativeStringPool();
+
+	/** Characters per block; longer strings get a block of their own. */
+	static constexpr int32 BlockChars = 32 * 1024;
+
+	/** Views per page, and pages: room for 16M distinct strings. */
+	static constexpr int32 PageViews = 4096;
+	static constexpr int32 MaxPages = 4096;
+
+	/** Keys view pooled characters, so lookups never build an FString. Case-sensitive. */
+	struct FViewKeyFuncs : TDefaultMapKeyFuncs<FStringView, uint32, false>
+	{
+		static bool Matches(FStringView A, FStringView B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(FStringView Key) { return FCrc::MemCrc32(Key.GetData(), Key.Len() * sizeof(TCHAR)); }
+	};
+
+	/** Guards Ids, Blocks and appends; readers of published views do not take it. */
+	mutable FRWLock Lock;
+	TMap<FStringView, uint32, FDefaultSetAllocator, FViewKeyFuncs> Ids;
+
+	/** View of id N at Pages[N / PageViews][N % PageViews]; ids below NumViews are published. */
+	std::atomic<FStringView*> Pages[MaxPages] = {};
+	std::atomic<uint32> NumViews{ 0 };
+	TArray<TUniquePtr<FStringView[]>> OwnedPages;
+
+	TArray<TUniquePtr<TCHAR[]>> Blocks;
+	int32 CurrentBlock = INDEX_NONE;
+	int32 BlockUsed = BlockChars;
+	SIZE_T BlockBytes = 0;
+
+	const TCHAR* Store(FStringView Str);
+
+	/** Append a view under the write lock and publish it; returns its id. */
+	uint32 AddView(FStringView View);
+};
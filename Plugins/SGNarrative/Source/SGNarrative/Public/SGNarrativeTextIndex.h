@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGNarrativeTextIndex.generated.h"
+
+/** Narrative table a searchable line comes from. */
+UENUM(BlueprintType)
+enum class ESGNarrativeTextSource : uint8
+{
+	Dialogue,
+	MainQuest,
+	OptionalPrompts,
+	DecisionPoints,
+
+	Num UMETA(Hidden)
+};
+
+/** One searchable text field of one row. */
+struct FSGNarrativeTextEntry
+{
+	FName Row;
+	FName Field;
+	FString Text;
+};
+
+/** A line matching a search. */
+USTRUCT(BlueprintType)
+struct SGNARRATIVE_API FSGNarrativeSearchHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Search")
+	ESGNarrativeTextSource Source = ESGNarrativeTextSource::Dialogue;
+
+	/** DataTable row name (decision points from JSON use dp_id:option_key). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Search")
+	FName Row;
+
+	/** Column the text came from (line_or_prompt, option_text, dialogue, prompt_text...). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Search")
+	FName Field;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Search")
+	FString Text;
+};
+
+/**
+ * Inverted index over narrative lines, for writer and QA search.
+ *
+ * Text is case-folded and split into alphanumeric words, and every lowercase three-character window
+ * is kept as a trigram. Word queries intersect word posting lists; substring queries intersect
+ * trigram posting lists and confirm each candidate with a case-insensitive compare.
+ * Posting lists are sorted document ids.
+ *
+ * UpdateSource diffs a table against what is indexed, so a reload only re-tokenizes the lines that
+ * were added, edited or removed. Not thread-safe; tooling uses it from the game thread.
+ */
+class SGNARRATIVE_API FSGNarrativeTextIndex
+{
+public:
+	/** Counts from one UpdateSource. */
+	struct FUpdateStats
+	{
+		int32 Added = 0;
+		int32 Changed = 0;
+		int32 Removed = 0;
+	};
+
+	/** Make the lines of Source exactly Entries (keyed by Row + Field); unchanged lines are left alone. */
+	FUpdateStats UpdateSource(ESGNarrativeTextSource Source, TConstArrayView<FSGNarrativeTextEntry> Entries);
+
+	/** Lines containing every word of Query (any order). Stops after MaxHits (<= 0: no limit). */
+	void FindWords(FStringView Query, TArray<FSGNarrativeSearchHit>& OutHits, int32 MaxHits = 0) const;
+
+	/** Lines containing Query as a case-insensitive substring. Stops after MaxHits (<= 0: no limit). */
+	void FindSubstring(FStringView Query, TArray<FSGNarrativeSearchHit>& OutHits, int32 MaxHits = 0) const;
+
+	void Reset();
+
+	/** Indexed lines. */
+	int32 Num() const { return DocByKey.Num(); }
+
+	SIZE_T GetAllocatedSize() const;
+
+	/** Lowercase alphanumeric words of Text, in order, repeats kept. */
+	static void Tokenize(FStringView Text, TArray<FString>& OutWords);
+
+private:
+	struct FDoc
+	{
+		ESGNarrativeTextSource Source = ESGNarrativeTextSource::Dialogue;
+		FName Row;
+		FName Field;
+		FString Text;
+		bool bLive = false;
+	};
+
+	struct FDocKey
+	{
+		ESGNarrativeTextSource Source;
+		FName Row;
+		FName Field;
+
+		bool operator==(const FDocKey& Other) const { return Source == Other.Source && Row == Other.Row && Field == Other.Field; }
+		friend uint32 GetTypeHash(const FDocKey& Key) { return HashCombine(HashCombine(GetTypeHash(Key.Row), GetTypeHash(Key.Field)), (uint32)Key.Source); }
+	};
+
+	TArray<FDoc> Docs;
+	TArray<int32> FreeDocs;
+	TMap<FDocKey, int32> DocByKey;
+
+	TMap<FString, TArray<int32>> WordPostings;
+	TMap<uint64, TArray<int32>> TrigramPostings;
+
+	int32 AddDoc(ESGNarrativeTextSource Source, FName Row, FName Field, const FString& Text);
+	void RemoveDoc(int32 DocId);
+	void IndexDoc(int32 DocId);
+	void UnindexDoc(int32 DocId);
+
+	void AddHit(int32 DocId, TArray<FSGNarrativeSearchHit>& OutHits) const;
+
+	/** Distinct trigrams of the case-folded Text. */
+	static void GetTrigrams(FStringView Text, TArray<uint64>& OutTrigrams);
+
+	/** Sorted intersection of posting lists, shortest first. */
+	static void Intersect(TArray<const TArray<int32>*>& Lists, TArray<int32>& OutDocs);
+};
@@ -4,8 +4,11 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Engine/DataTable.h"
 #include "SGDialogueTypes.h"
+#include "SGNarrativeAsync.h"
 #include "SGQuestSubsystem.generated.h"
 
+class FSGNarrativeDatabase;
+
 /** Parsed quest branch details (from BranchQuestOutlines_Expanded.parsed.json). */
 USTRUCT(BlueprintType)
 struct SGNARRATIVE_API FSGBranchQuestBranch
@@ -59,7 +62,7 @@ struct SGNARRATIVE_API FSGBranchQuestDetails
 };
 
 USTRUCT()
-struct FSGBranchQuestDetailsFile
+struct SGNARRATIVE_API FSGBranchQuestDetailsFile
 {
 	GENERATED_BODY()
 
@@ -104,6 +107,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Quests")
 	void Reload();
 
+	/** Stream the summary table and parse the details JSON on a worker; current data stays live until OnReady. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Quests")
+	void ReloadAsync();
+
+	/** True once the latest Reload / ReloadAsync has completed; false while a ReloadAsync is in flight. */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Quests")
+	bool IsReady() const { return bReady; }
+
+	/** Broadcast on the game thread each time a reload swaps in new data. */
+	UPROPERTY(BlueprintAssignable, Category="Shattered Gods|Quests")
+	FSGNarrativeReadySignature OnReady;
+
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Quests")
 	bool GetQuestSummary(FName Code, FSGBranchQuestSummaryRow& OutRow) const;
 
@@ -128,14 +143,34 @@ public:
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Quests")
 	TMap<FName, FSGQuestProgress> GetAllProgress() const { return ProgressByCode; }
 
+	/** Parse BranchQuestDetailsJson into a code -> details map. Safe off the game thread; also used by the narrative cook. */
+	static void ParseDetailsJson(const FString& RelPath, TMap<FName, FSGBranchQuestDetails>& OutDetails);
+
 private:
 	UPROPERTY()
 	UDataTable* BranchQuestSummaryTable = nullptr;
 
 	TMap<FName, FSGBranchQuestDetails> DetailsByCode;
 
+	/** Cooked database serving summaries and details in place of the table / map, when mounted. */
+	TSharedPtr<const FSGNarrativeDatabase> Database;
+
 	UPROPERTY(EditAnywhere)
 	TMap<FName, FSGQuestProgress> ProgressByCode;
 
+	/** Bumped per reload so a slower, older ReloadAsync never overwrites a newer result. */
+	uint32 LoadRequest = 0;
+	bool bReady = false;
+
 	void LoadDetailsJson();
+	void FinishLoad();
+
+	/** Use the cooked database if it has quest data; clears the source-table state. */
+	bool UseDatabase();
+
+	/** Number of branches in the quest's details, or INDEX_NONE without details. */
+	int32 GetBranchCount(FName Code) const;
+
+	/** One branch of the quest's details: points into DetailsByCode, or at Scratch when read from the database. */
+	const FSGBranchQuestBranch* FindBranch(FName Code, int32 BranchIndex, FSGBranchQuestBranch& Scratch) const;
 };
@@ -3,12 +3,18 @@
 #include "CoreMinimal.h"
 #include "GameFramework/SaveGame.h"
 #include "SGStoryState.h"
+#include "SGStoryJournal.h"
 #include "SGQuestSubsystem.h"
 #include "SGSaveGame.generated.h"
 
 /**
  * Minimal SaveGame payload for narrative state + quest progress.
  * Extend freely (inventory, world state, checkpoints, etc).
+ *
+ * The narrative properties below are written by FSGCompactSaveFormat after the tagged properties,
+ * in every archive that saves data (SaveGameToSlot / SaveGameToMemory included). Whether a load
+ * reads that block is decided by the archive's FSGSaveGameVersion: saves from before
+ * CompactNarrative load the properties from their tags.
  */
 UCLASS()
 class SGNARRATIVE_API USGCatalystSaveGame : public USaveGame
@@ -16,13 +22,30 @@ class SGNARRATIVE_API USGCatalystSaveGame : public USaveGame
 	GENERATED_BODY()
 
 public:
+	/** Full story state, or the base the journal tail replays onto. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shattered Gods|Save")
 	FSGStoryState StoryState;
 
+	/** Optional: rows applied after StoryState. Use USGSaveGameLibrary::GetStoryState to read the result. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shattered Gods|Save")
+	FSGStoryJournal Journal;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shattered Gods|Save")
 	TMap<FName, FSGQuestProgress> QuestProgress;
 
 	/** The current narrative node id (if you want to resume mid-conversation). */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shattered Gods|Save")
 	FName CurrentDialogueId;
+
+	/**
+	 * The last load found a malformed narrative block: Ar.IsError() was set, and the four narrative
+	 * properties were reset to their defaults. The engine's LoadGameFrom* ignore archive errors, so
+	 * USGSaveGameLibrary::LoadFromSlot checks this instead.
+	 */
+	bool HasNarrativeLoadError() const { return bNarrativeLoadFailed; }
+
+	virtual void Serialize(FArchive& Ar) override;
+
+private:
+	bool bNarrativeLoadFailed = false;
 };
@@ -17,6 +17,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Save")
 	static bool SaveToSlot(USGCatalystSaveGame* SaveObj, const FString& SlotName, int32 UserIndex = 0);
 
+	/** Null if the slot is missing, holds another save class, or its narrative data is malformed. */
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Save")
 	static USGCatalystSaveGame* LoadFromSlot(const FString& SlotName, int32 UserIndex = 0);
+
+	/** The saved story state: StoryState with the journal tail replayed onto it. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Save")
+	static bool GetStoryState(const USGCatalystSaveGame* SaveObj, FSGStoryState& OutState);
+
+	/** Store only the journal entries after BasePosition; older entries are folded into the saved base state. */
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Save")
+	static void WriteJournalTail(USGCatalystSaveGame* SaveObj, const FSGStoryState& BaseState, const FSGStoryJournal& Journal, int32 BasePosition);
 };
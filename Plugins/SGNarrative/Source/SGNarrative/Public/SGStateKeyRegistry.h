@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Misc/ScopeRWLock.h"
+
+#include <atomic>
+
+/**
+ * Process-wide table of known story keys, each with a dense slot.
+ *
+ * Slots are append-only for the lifetime of the process, so a FSGStoryState built before a
+ * Reload stays valid afterwards. Keys are registered from the dialogue table (at compile time),
+ * the SG.Flag.* gameplay tags and the state keys notes file (RegisterProjectKeys).
+ *
+ * The keys generated into SGKeys.h take the first slots, in their table order, when the registry
+ * is created; that is what lets SGKeys::ga_briefed be a compile-time slot.
+ */
+class SGNARRATIVE_API FSGStateKeyRegistry
+{
+public:
+	static FSGStateKeyRegistry& Get();
+
+	/** Slot of a registered flag, or INDEX_NONE. */
+	int32 FindFlag(FName Flag) const { return Flags.Find(Flag); }
+
+	/** Slot of the flag, registering it if needed. NAME_None never gets a slot. */
+	int32 RegisterFlag(FName Flag) { return Flags.Register(Flag); }
+
+	/** Name of a flag slot, NAME_None if out of range. Lock-free. */
+	FName GetFlagName(int32 Slot) const { return Flags.GetName(Slot); }
+	int32 NumFlags() const { return Flags.Num(); }
+
+	/** Slot of a registered int key (rep_*, trust_*, xp, item_*, ranks...), or INDEX_NONE. */
+	int32 FindInt(FName Key) const { return Ints.Find(Key); }
+
+	/** Slot of the int key, registering it if needed. NAME_None never gets a slot. */
+	int32 RegisterInt(FName Key) { return Ints.Register(Key); }
+
+	/** Name of an int slot, NAME_None if out of range. Lock-free. */
+	FName GetIntName(int32 Slot) const { return Ints.GetName(Slot); }
+	int32 NumInts() const { return Ints.Num(); }
+
+	/** Register keys from SG.Flag.* gameplay tags and USGNarrativeSettings::StateKeysFile. */
+	void RegisterProjectKeys();
+
+	/** The keys RegisterProjectKeys would register, without registering them (tools). */
+	static void CollectProjectKeys(TArray<FName>& OutFlags, TArray<FName>& OutInts);
+
+	/**
+	 * MakeFlagTagName tag of a flag slot; invalid when no such gameplay tag is declared. Cached, and
+	 * re-resolved once native tags are done and whenever the editor refreshes the tag tree. States
+	 * mirrored before such a refresh keep their tags until RebuildFlagTags.
+	 */
+	FGameplayTag GetFlagTag(int32 Slot) const;
+
+	/** Tag of any flag: GetFlagTag for registered ones, else looked up (uncached) by MakeFlagTagName. */
+	FGameplayTag FindFlagTag(FName Flag) const;
+
+	/**
+	 * Flag -> tag, with the prefix before the first '_' as the parent: "ga_briefed" -> SG.Flag.ga.briefed,
+	 * "ga" -> SG.Flag.ga. Names already under SG.Flag are kept as they are.
+	 */
+	static FName MakeFlagTagName(FStringView Flag);
+
+	/** USGNarrativeSettings::bMirrorFlagsToGameplayTags, latched by RegisterProjectKeys. */
+	bool IsMirroringFlagTags() const { return bMirrorFlagTags; }
+
+private:
+	FSGStateKeyRegistry();
+
+	struct FKeyTable
+	{
+		int32 Find(FName Key) const;
+		int32 Register(FName Key);
+		FName GetName(int32 Slot) const;
+		int32 Num() const;
+
+	private:
+		/** Names per page, and pages: room for 1M keys. */
+		static constexpr int32 PageNames = 1024;
+		static constexpr int32 MaxPages = 1024;
+
+		/** Guards Slots and appends; name reads of published slots do not take it. */
+		mutable FRWLock Lock;
+		TMap<FName, int32> Slots;
+
+		/** Name of slot N at Pages[N / PageNames][N % PageNames]; slots below NumNames are published. */
+		std::atomic<FName*> Pages[MaxPages] = {};
+		std::atomic<int32> NumNames{ 0 };
+		TArray<TUniquePtr<FName[]>> OwnedPages;
+	};
+
+	FKeyTable Flags;
+	FKeyTable Ints;
+
+	/** Tag per flag slot, resolved on first use; slots past the end are resolved together. */
+	mutable FRWLock TagLock;
+	mutable TArray<FGameplayTag> FlagTags;
+
+	/** Native tags are done; a tag missing since then stays missing until the tree is refreshed. Under TagLock. */
+	bool bTagTreeComplete = false;
+
+	/** RegisterProjectKeys bound OnTagTreeChanged (game thread only). */
+	bool bWatchingTagTree = false;
+
+	bool bMirrorFlagTags = false;
+
+	/** Forget the resolved tags: the gameplay tag tree is complete, or was rebuilt. */
+	void OnTagTreeChanged();
+
+	static void CollectGameplayTagFlags(TArray<FName>& OutFlags);
+	static void CollectStateKeysFile(const FString& RelPath, TArray<FName>& OutFlags, TArray<FName>& OutInts);
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SGStoryState.h"
+#include "SGStoryJournal.generated.h"
+
+/** One int write: key, value before and after. */
+USTRUCT(BlueprintType)
+struct SGNARRATIVE_API FSGStoryIntDelta
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	FName Key;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	int32 OldValue = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	int32 NewValue = 0;
+
+	/** False if the key did not exist before, so undo removes it instead of writing OldValue. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	bool bWasSet = false;
+};
+
+/** What applying one row actually changed. Keys are stored by name, like FSGStoryState saves. */
+USTRUCT(BlueprintType)
+struct SGNARRATIVE_API FSGStoryJournalEntry
+{
+	GENERATED_BODY()
+
+	/** Narrative id and option_key of the applied row (for logs; replay does not need them). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	FName RowId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	FName OptionKey;
+
+	/** Flags that were not set before the row. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	TArray<FName> FlagsAdded;
+
+	/** Int writes in application order (one key may appear more than once). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	TArray<FSGStoryIntDelta> Ints;
+
+	bool IsEmpty() const { return FlagsAdded.Num() == 0 && Ints.Num() == 0; }
+
+	/** Apply NewValues / added flags. */
+	void Redo(FSGStoryState& State) const;
+
+	/** Restore OldValues / remove added flags, in reverse order. */
+	void Undo(FSGStoryState& State) const;
+};
+
+/**
+ * Optional record of applied rows as deltas.
+ *
+ * Positions are absolute: entry N is the N-th row applied since the journal started, and stays N
+ * after older entries are folded into a base state (Rebase). Undo is O(delta) and needs the same
+ * state the entries were recorded against, with no unrecorded writes in between. Replay only
+ * writes recorded values, so it is deterministic and does not depend on the dialogue data.
+ */
+USTRUCT(BlueprintType)
+struct SGNARRATIVE_API FSGStoryJournal
+{
+	GENERATED_BODY()
+
+	/** Entries after the base state, oldest first. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	TArray<FSGStoryJournalEntry> Entries;
+
+	/** Position of Entries[0]: entries before it were folded into the base state. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Story")
+	int32 BasePosition = 0;
+
+	/** Position after the newest entry; pass to UndoTo later to come back here. */
+	int32 GetPosition() const { return BasePosition + Entries.Num(); }
+
+	/** Append an entry (empty entries are kept too, so positions match applied rows). */
+	void Add(FSGStoryJournalEntry&& Entry) { Entries.Add(MoveTemp(Entry)); }
+
+	/** Undo and drop entries back to Position. False if Position is before the base or past the end. */
+	bool UndoTo(FSGStoryState& State, int32 Position);
+
+	/** Apply every entry to State, which must hold the base state. */
+	void Replay(FSGStoryState& State) const;
+
+	/** Fold entries before Position into BaseState and drop them (e.g. when a save writes a new base). */
+	void Rebase(FSGStoryState& BaseState, int32 Position);
+};
+
+/** Blueprint helpers for FSGStoryJournal. */
+UCLASS()
+class SGNARRATIVE_API USGStoryJournalLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
+	static int32 GetJournalPosition(const FSGStoryJournal& Journal) { return Journal.GetPosition(); }
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
+	static bool UndoJournalTo(UPARAM(ref) FSGStoryJournal& Journal, UPARAM(ref) FSGStoryState& State, int32 Position) { return Journal.UndoTo(State, Position); }
+
+	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
+	static void ReplayJournal(const FSGStoryJournal& Journal, UPARAM(ref) FSGStoryState& State) { Journal.Replay(State); }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeRWLock.h"
+#include "SGStoryState.h"
+
+/** Immutable copy of a story state, safe to read from any thread while it is held. */
+using FSGStoryStateSnapshot = TSharedRef<const FSGStoryState, ESPMode::ThreadSafe>;
+
+/**
+ * Publishes story state for readers on other threads (AI, UI, audio): read-copy-update.
+ *
+ * The game thread owns the live FSGStoryState and calls Publish after each batch of writes
+ * (e.g. a row's ApplyRowEffects); that copies the state and swaps the new snapshot in. Copies
+ * share every registry chunk, so publishing costs one pointer per chunk plus the ad-hoc keys,
+ * and the game thread's next write to a shared chunk copies only that chunk. Readers never see a
+ * half-applied row, and a snapshot never changes while they hold it.
+ *
+ * The lock guards only the pointer swap / copy; use FSGStorySnapshotReader to skip even that
+ * while nothing new has been published.
+ */
+class SGNARRATIVE_API FSGStorySnapshotPublisher
+{
+public:
+	FSGStorySnapshotPublisher();
+
+	/** Game thread only. Publishes a copy of State unless that exact version is already out; true if it did. */
+	bool Publish(const FSGStoryState& State);
+
+	/** Publish an empty state (e.g. when the game instance resets). Game thread only. */
+	void Reset();
+
+	/** Any thread. The latest snapshot; an empty state before the first Publish. */
+	FSGStoryStateSnapshot Get() const;
+
+	/** Any thread. Changes with every Publish. */
+	int32 GetSerial() const { return Serial.GetValue(); }
+
+private:
+	mutable FRWLock Lock;
+	FSGStoryStateSnapshot Current;
+	FThreadSafeCounter Serial;
+
+	/** FSGStoryState::GetCacheVersion of Current; game thread only. */
+	uint64 PublishedVersion = 0;
+};
+
+/**
+ * One reader's cached view of a publisher. Get() is one atomic load while nothing new has been
+ * published, and refreshes the cached snapshot otherwise. Not shared between threads: give each
+ * worker / task its own reader.
+ */
+class FSGStorySnapshotReader
+{
+public:
+	explicit FSGStorySnapshotReader(TSharedRef<const FSGStorySnapshotPublisher, ESPMode::ThreadSafe> InPublisher)
+		: Publisher(MoveTemp(InPublisher))
+		, Serial(Publisher->GetSerial())
+		, Snapshot(Publisher->Get())
+	{
+	}
+
+	/** Valid until the next Get() on this reader. */
+	const FSGStoryState& Get()
+	{
+		// Serial first: a publish in between only costs another refresh next time.
+		const int32 Latest = Publisher->GetSerial();
+		if (Latest != Serial)
+		{
+			Serial = Latest;
+			Snapshot = Publisher->Get();
+		}
+		return *Snapshot;
+	}
+
+private:
+	TSharedRef<const FSGStorySnapshotPublisher, ESPMode::ThreadSafe> Publisher;
+
+	/** Declared (so initialized) before Snapshot: serial first, as in Get(). */
+	int32 Serial = 0;
+	FSGStoryStateSnapshot Snapshot;
+};
@@ -1,27 +1,350 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Misc/Guid.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "SGStoryState.generated.h"
 
+/**
+ * Registry slots whose value changed, as bitsets (bit N == slot N).
+ * Only registered keys are tracked: compiled rows read nothing else.
+ */
+struct FSGStoryStateChanges
+{
+	TArray<uint32, TInlineAllocator<4>> FlagWords;
+	TArray<uint32, TInlineAllocator<1>> IntWords;
+
+	/** The whole state was replaced (loaded), so every key must be treated as changed. */
+	bool bAll = false;
+
+	bool IsEmpty() const { return !bAll && FlagWords.Num() == 0 && IntWords.Num() == 0; }
+
+	void Reset()
+	{
+		FlagWords.Reset();
+		IntWords.Reset();
+		bAll = false;
+	}
+};
+
+/** 256 registry flag bits; shared between states until one of them writes it. */
+struct FSGStoryFlagChunk
+{
+	static constexpr int32 Words = 8;
+	uint32 Bits[Words] = {};
+};
+
+/** 32 registry int slots plus their written bits; shared between states until one of them writes it. */
+struct FSGStoryIntChunk
+{
+	static constexpr int32 Slots = 32;
+	int32 Values[Slots] = {};
+	uint32 Present = 0;
+};
+
+/** Compile-time flag key: a FSGStateKeyRegistry slot reserved at startup (see SGKeys.h). */
+struct FSGFlagKey
+{
+	int32 Slot = INDEX_NONE;
+};
+
+/** Compile-time int key: a FSGStateKeyRegistry slot reserved at startup (see SGKeys.h). */
+struct FSGIntKey
+{
+	int32 Slot = INDEX_NONE;
+};
+
+/** Custom version of FSGStoryState data (saves, packages, anything else that persists the struct). */
+struct SGNARRATIVE_API FSGStoryStateVersion
+{
+	enum Type
+	{
+		/** Flags and Ints written as tagged properties. */
+		BeforeCustomVersionWasAdded = 0,
+
+		/** FSGStoryState::Serialize: flags and ints by name, including registered keys. */
+		NativeSerializer,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
 /**
  * Simple, engine-friendly story state store.
  *
- * Flags are stored as FName for easy interop with CSV/JSON.
- * If you prefer GameplayTags, you can mirror these into tags at runtime.
+ * Flags are FNames for easy interop with CSV/JSON. Flags known to FSGStateKeyRegistry live in a
+ * packed bitset (one bit per registry slot); unknown flags fall back to the Flags name set.
+ * Ints work the same way: registered keys live in dense chunks indexed by registry slot, and
+ * only ad-hoc keys go to the Ints map.
+ *
+ * Registered storage is chunked copy-on-write: copying a state (a Blueprint pin, a save, a
+ * quicksave history entry, an option preview) shares every chunk, and a write copies only the
+ * chunk it touches. Copies are therefore cheap snapshots that never see each other's writes.
+ * Always read state through the member API / USGStoryStateLibrary, which see both.
+ *
+ * With USGNarrativeSettings::bMirrorFlagsToGameplayTags, set flags that have an SG.Flag.* gameplay
+ * tag (in a slot or by name) are also kept in FlagTags, updated by every flag write (so by
+ * ApplyRowEffects too).
  */
 USTRUCT(BlueprintType)
 struct SGNARRATIVE_API FSGStoryState
 {
 	GENERATED_BODY()
 
-	/** One-way flags toggled by decisions / quest progress. */
+	/**
+	 * One-way flags held by name: ad-hoc names, and whatever Blueprint or the editor writes here
+	 * directly. Flags written through the member API with a registry slot live in FlagChunks.
+	 * Direct writes are seen by every reader and by GetCacheVersion; call RecomputeContentHash
+	 * after them if GetContentHash must be exact.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Story")
 	TSet<FName> Flags;
 
-	/** Numeric state: reputation, ranks, trust, etc. */
+	/** Numeric state held by name, like Flags. Ints written through the member API with a registry slot live in IntChunks. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Story")
 	TMap<FName, int32> Ints;
+
+	/** Registry flag bits, FSGStoryFlagChunk::Words words per chunk. Null chunks read as all clear. */
+	TArray<TSharedPtr<FSGStoryFlagChunk>, TInlineAllocator<4>> FlagChunks;
+
+	/** Registry int slots (reputation, ranks, trust, items...). Null chunks and unwritten slots read as 0. */
+	TArray<TSharedPtr<FSGStoryIntChunk>, TInlineAllocator<4>> IntChunks;
+
+	/** Slots changed since the last TakeChanges. Runtime only: not serialized or compared. */
+	FSGStoryStateChanges Changes;
+
+	/**
+	 * Stamp of the current contents, drawn from a process-wide counter on every change, so two
+	 * states with the same non-zero version hold the same values (one is a copy of the other).
+	 * 0 == never written through the API (e.g. a default-constructed state); such states are never cached against.
+	 */
+	uint64 Version = 0;
+
+	/** Order-independent sum of per-entry hashes; see GetContentHash. Runtime only, like Changes. */
+	uint64 ContentHash = 0;
+
+	/** SG.Flag.* tags of the set flags, while FSGStateKeyRegistry::IsMirroringFlagTags; else empty. Runtime only. */
+	FGameplayTagContainer FlagTags;
+
+	// --- Flags ---
+
+	bool HasFlag(FName Flag) const;
+	void AddFlag(FName Flag);
+	void RemoveFlag(FName Flag);
+
+	bool HasFlagSlot(int32 Slot) const
+	{
+		return (GetFlagWord(Slot >> 5) & (1u << (Slot & 31))) != 0;
+	}
+
+	/** Word N of the registry flag bitset (slots N*32 .. N*32+31). */
+	uint32 GetFlagWord(int32 Word) const
+	{
+		const int32 Chunk = Word / FSGStoryFlagChunk::Words;
+		return FlagChunks.IsValidIndex(Chunk) && FlagChunks[Chunk].IsValid() ? FlagChunks[Chunk]->Bits[Word % FSGStoryFlagChunk::Words] : 0u;
+	}
+
+	/** Number of flag words that may be non-zero. */
+	int32 NumFlagWords() const { return FlagChunks.Num() * FSGStoryFlagChunk::Words; }
+
+	void AddFlagSlot(int32 Slot);
+	void RemoveFlagSlot(int32 Slot);
+
+	/** Generated keys (SGKeys::ga_briefed): straight to the slot, no name hashing. */
+	bool HasFlag(FSGFlagKey Key) const { return HasFlagSlot(Key.Slot); }
+	void AddFlag(FSGFlagKey Key) { AddFlagSlot(Key.Slot); }
+	void RemoveFlag(FSGFlagKey Key) { RemoveFlagSlot(Key.Slot); }
+
+	/**
+	 * Word-at-a-time multi-flag test: every Required bit set and no Forbidden bit set.
+	 * Both masks hold NumWords words in registry slot order.
+	 */
+	bool MatchesFlagMasks(const uint32* Required, const uint32* Forbidden, int32 NumWords) const;
+
+	/** Every set flag (bitset + name set), unordered. */
+	void GetAllFlags(TArray<FName>& OutFlags) const;
+
+	// --- Flag tags ---
+
+	/**
+	 * Hierarchical flag test: true if any set flag's SG.Flag tag is Tag or under it (SG.Flag.ga matches
+	 * SG.Flag.ga.briefed). A container lookup with the mirror on, a walk over the set flags without.
+	 */
+	bool HasFlagTag(const FGameplayTag& Tag) const;
+	bool MatchesFlagTagQuery(const FGameplayTagQuery& Query) const;
+
+	/** Tags of the set flags: the mirror when it is on, else built now. */
+	void GetFlagTags(FGameplayTagContainer& OutTags) const;
+
+	/** Rebuild FlagTags from the flags (e.g. for a state whose Flags were written directly). */
+	void RebuildFlagTags();
+
+	// --- Ints ---
+
+	bool FindInt(FName Key, int32& OutValue) const;
+	int32 GetInt(FName Key, int32 DefaultValue = 0) const;
+	void SetInt(FName Key, int32 Value);
+	void AddInt(FName Key, int32 Delta);
+
+	/** Forget a key entirely (FindInt fails afterwards), e.g. to undo its creation. */
+	void RemoveInt(FName Key);
+
+	bool HasIntSlot(int32 Slot) const
+	{
+		const FSGStoryIntChunk* Chunk = FindIntChunk(Slot);
+		return Chunk && (Chunk->Present & (1u << (Slot % FSGStoryIntChunk::Slots))) != 0;
+	}
+
+	/**
+	 * Value of a registry int slot, 0 if unset. A single indexed read unless the key is unset and
+	 * ad-hoc keys are present: then a value written by name before the key was registered is used.
+	 */
+	int32 GetIntSlot(int32 Slot) const
+	{
+		const FSGStoryIntChunk* Chunk = FindIntChunk(Slot);
+		const int32 Index = Slot % FSGStoryIntChunk::Slots;
+		if (Chunk && (Chunk->Present & (1u << Index)) != 0)
+		{
+			return Chunk->Values[Index];
+		}
+		return Ints.Num() > 0 ? GetLooseIntForSlot(Slot) : 0;
+	}
+
+	void SetIntSlot(int32 Slot, int32 Value);
+	void AddIntSlot(int32 Slot, int32 Delta);
+
+	int32 GetInt(FSGIntKey Key) const { return GetIntSlot(Key.Slot); }
+	void SetInt(FSGIntKey Key, int32 Value) { SetIntSlot(Key.Slot, Value); }
+	void AddInt(FSGIntKey Key, int32 Delta) { AddIntSlot(Key.Slot, Delta); }
+
+	/** Every written int (slots + ad-hoc map). */
+	void GetAllInts(TMap<FName, int32>& OutInts) const;
+
+	// --- Registration ---
+
+	/**
+	 * Move flags / ints stored by name into their slots for keys registered since they were written.
+	 * Slot reads still find them by name without this; adopting only takes them off that slower path.
+	 * Loading adopts on its own, and USGDialogueSubsystem::RefreshWatchedDecisions adopts after a Reload.
+	 */
+	void AdoptRegisteredKeys();
+
+	// --- Change tracking ---
+
+	/**
+	 * Move the keys changed since the previous call into Out and start a new change set.
+	 * Writes that leave a value as it was are not recorded. Meant for one consumer per state
+	 * (e.g. USGDialogueSubsystem::RefreshWatchedDecisions).
+	 */
+	void TakeChanges(FSGStoryStateChanges& Out)
+	{
+		Out = MoveTemp(Changes);
+		Changes.Reset();
+	}
+
+	bool HasChanges() const { return !Changes.IsEmpty(); }
+
+	uint64 GetVersion() const { return Version; }
+
+	/**
+	 * Key for caching results computed from this state (0 == do not cache). Version while Flags and
+	 * Ints are empty; otherwise Version mixed with their contents, because direct writes to them
+	 * (Blueprint Set Members, the details panel) do not take a new Version. O(Flags + Ints).
+	 */
+	uint64 GetCacheVersion() const;
+
+	// --- Hash ---
+
+	/**
+	 * 64-bit hash of the contents, kept up to date by every write through the member API (a sum of
+	 * one hash per set flag and per int key/value, so it is order-independent and O(1) to update).
+	 * States that are Identical always have equal hashes, so unequal hashes prove the states differ:
+	 * use it to key caches, dedupe states, or reject inequality without a walk.
+	 * Every entry hashes by key name, whether it sits in a registry slot or in Flags / Ints, so the
+	 * same contents hash the same before and after their keys are registered. FName hashes are only
+	 * meaningful within one process; do not persist it.
+	 * Code that writes Flags / Ints directly must call RecomputeContentHash afterwards.
+	 */
+	uint64 GetContentHash() const { return ContentHash; }
+
+	/** Hash from scratch; equals GetContentHash unless Flags / Ints were written directly. */
+	uint64 ComputeContentHash() const;
+
+	/** After a direct write to Flags / Ints: recompute the hash and take a new Version, so caches keyed on either see it. */
+	void RecomputeContentHash()
+	{
+		ContentHash = ComputeContentHash();
+		BumpVersion();
+	}
+
+	/** Hash compare first, then the full compare only when the hashes match. */
+	bool Equals(const FSGStoryState& Other) const { return ContentHash == Other.ContentHash && Identical(&Other, 0); }
+
+	// --- Storage ---
+
+	/** Chunks this state shares with no other copy; the rest are shared snapshots. For memory reports. */
+	int32 NumUniqueChunks() const;
+
+	// --- Struct ops ---
+
+	/**
+	 * Writes flags by name so saves survive registry changes between builds. Data from before
+	 * FSGStoryStateVersion::NativeSerializer is left to the tagged path and rebuilt in PostSerialize.
+	 */
+	bool Serialize(FArchive& Ar);
+	void PostSerialize(const FArchive& Ar);
+	bool Identical(const FSGStoryState* Other, uint32 PortFlags) const;
+
+	/** Blueprint Make / script construction filled Flags / Ints directly: rehash, re-mirror and take a Version. */
+	void PostScriptConstruct()
+	{
+		RebuildFlagTags();
+		RecomputeContentHash();
+	}
+
+private:
+	/** Replace the contents with these names, routing registered keys to their slots. */
+	void LoadFromNames(const TArray<FName>& AllFlags, const TMap<FName, int32>& AllInts);
+
+	/** Value stored by name before the key was registered (0 if none). */
+	int32 GetLooseIntForSlot(int32 Slot) const;
+
+	/**
+	 * Make slot writable; folds in any value stored by name before the key was registered.
+	 * bOutExisted: the key was set, in the slot or by name (else it reads 0 and is not hashed yet).
+	 */
+	int32& TouchIntSlot(int32 Slot, bool& bOutExisted);
+
+	/** Identical for states holding keys by name: compares every flag and int by key. */
+	bool IdenticalByName(const FSGStoryState& Other) const;
+
+	const FSGStoryIntChunk* FindIntChunk(int32 Slot) const
+	{
+		const int32 Chunk = Slot / FSGStoryIntChunk::Slots;
+		return IntChunks.IsValidIndex(Chunk) ? IntChunks[Chunk].Get() : nullptr;
+	}
+
+	/** Writable chunk for a slot: created if missing, copied first if another state shares it. */
+	FSGStoryFlagChunk& MutableFlagChunk(int32 Slot);
+	FSGStoryIntChunk& MutableIntChunk(int32 Slot);
+
+	void BumpVersion();
+};
+
+template<>
+struct TStructOpsTypeTraits<FSGStoryState> : public TStructOpsTypeTraitsBase2<FSGStoryState>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithPostSerialize = true,
+		WithIdentical = true,
+		WithPostScriptConstruct = true,
+	};
 };
 
 /** Blueprint helpers for FSGStoryState. */
@@ -32,42 +355,50 @@ class SGNARRATIVE_API USGStoryStateLibrary : public UBlueprintFunctionLibrary
 
 public:
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
-	static bool HasFlag(const FSGStoryState& State, FName Flag) { return State.Flags.Contains(Flag); }
+	static bool HasFlag(const FSGStoryState& State, FName Flag) { return State.HasFlag(Flag); }
 
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
-	static void AddFlag(UPARAM(ref) FSGStoryState& State, FName Flag) { State.Flags.Add(Flag); }
+	static void AddFlag(UPARAM(ref) FSGStoryState& State, FName Flag) { State.AddFlag(Flag); }
 
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
-	static void RemoveFlag(UPARAM(ref) FSGStoryState& State, FName Flag) { State.Flags.Remove(Flag); }
+	static void RemoveFlag(UPARAM(ref) FSGStoryState& State, FName Flag) { State.RemoveFlag(Flag); }
+
+	/** Any set flag at or under Tag (e.g. SG.Flag.ga). */
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
+	static bool HasFlagTag(const FSGStoryState& State, FGameplayTag Tag) { return State.HasFlagTag(Tag); }
+
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
+	static bool MatchesFlagTagQuery(const FSGStoryState& State, const FGameplayTagQuery& Query) { return State.MatchesFlagTagQuery(Query); }
 
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
-	static int32 GetInt(const FSGStoryState& State, FName Key, int32 DefaultValue = 0)
+	static FGameplayTagContainer GetFlagTags(const FSGStoryState& State)
 	{
-		if (const int32* Found = State.Ints.Find(Key))
-		{
-			return *Found;
-		}
-		return DefaultValue;
+		FGameplayTagContainer Tags;
+		State.GetFlagTags(Tags);
+		return Tags;
 	}
 
+	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
+	static int32 GetInt(const FSGStoryState& State, FName Key, int32 DefaultValue = 0) { return State.GetInt(Key, DefaultValue); }
+
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
-	static void SetInt(UPARAM(ref) FSGStoryState& State, FName Key, int32 Value) { State.Ints.Add(Key, Value); }
+	static void SetInt(UPARAM(ref) FSGStoryState& State, FName Key, int32 Value) { State.SetInt(Key, Value); }
 
 	UFUNCTION(BlueprintCallable, Category="Shattered Gods|Story")
-	static void AddInt(UPARAM(ref) FSGStoryState& State, FName Key, int32 Delta)
-	{
-		const int32 Current = GetInt(State, Key, 0);
-		State.Ints.Add(Key, Current + Delta);
-	}
+	static void AddInt(UPARAM(ref) FSGStoryState& State, FName Key, int32 Delta) { State.AddInt(Key, Delta); }
 
 	UFUNCTION(BlueprintPure, Category="Shattered Gods|Story")
 	static FString ToDebugString(const FSGStoryState& State)
 	{
-		TArray<FName> SortedFlags = State.Flags.Array();
+		TArray<FName> SortedFlags;
+		State.GetAllFlags(SortedFlags);
 		SortedFlags.Sort(FNameLexicalLess());
 
+		TMap<FName, int32> AllInts;
+		State.GetAllInts(AllInts);
+
 		TArray<FName> Keys;
-		State.Ints.GetKeys(Keys);
+		AllInts.GetKeys(Keys);
 		Keys.Sort(FNameLexicalLess());
 
 		FString Out;
@@ -80,7 +411,7 @@ public:
 		Out += TEXT("Ints:\n");
 		for (const FName& K : Keys)
 		{
-			Out += FString::Printf(TEXT("- %s = %d\n"), *K.ToString(), State.Ints[K]);
+			Out += FString::Printf(TEXT("- %s = %d\n"), *K.ToString(), AllInts[K]);
 		}
 
 		return Out;
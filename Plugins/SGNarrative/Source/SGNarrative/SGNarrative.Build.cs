@@ -14,10 +14,16 @@ public class SGNarrative : ModuleRules
 				"Engine",
 				"Json",
 				"JsonUtilities",
-				"DeveloperSettings"
+				"DeveloperSettings",
+				"GameplayTags"
 			}
 		);
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"AssetRegistry"
+			}
+		);
 	}
 }
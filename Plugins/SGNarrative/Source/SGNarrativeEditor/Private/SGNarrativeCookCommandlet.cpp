@@ -0,0 +1,197 @@
+#include "SGNarrativeCookCommandlet.h"
+#include "SGNarrativeDatabaseWriter.h"
+
+#include "SGCinematicsSubsystem.h"
+#include "SGCompiledDialogue.h"
+#include "SGDecisionPointSubsystem.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGQuestSubsystem.h"
+
+#include "Misc/Paths.h"
+
+USGNarrativeCookCommandlet::USGNarrativeCookCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USGNarrativeCookCommandlet::Main(const FString& Params)
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+
+	FString OutPath;
+	if (!FParse::Value(*Params, TEXT("Out="), OutPath))
+	{
+		OutPath = Settings->NarrativeDatabaseFile.TrimStartAndEnd();
+	}
+	if (OutPath.IsEmpty())
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeCook: no output path (pass -Out= or set NarrativeDatabaseFile)."));
+		return 1;
+	}
+	if (FPaths::IsRelative(OutPath))
+	{
+		OutPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), OutPath));
+	}
+
+	FSGNarrativeDatabaseWriter Writer;
+	typedef FSGNarrativeDatabaseWriter::FTableKey FTableKey;
+
+	// 1) Dialogue: rows grouped by id exactly as FSGCompiledDialogue lays them out, plus their programs.
+	if (UDataTable* Table = Settings->DialogueDecisionTable.LoadSynchronous())
+	{
+		static const FString Context = TEXT("USGNarrativeCookCommandlet::Dialogue");
+		TArray<FSGDialogueDecisionRow*> SourceRows;
+		Table->GetAllRows(Context, SourceRows);
+
+		FSGCompiledDialogue Compiled;
+		Compiled.Build(SourceRows);
+
+		// The index keeps pooled text; the table is written from materialized rows.
+		TArray<FSGDialogueDecisionRow> Materialized;
+		Materialized.SetNum(Compiled.NumRows());
+
+		TArray<const void*> Rows;
+		for (int32 Slot = 0; Slot < Compiled.NumRows(); ++Slot)
+		{
+			Compiled.MaterializeRow(Slot, Materialized[Slot]);
+			Rows.Add(&Materialized[Slot]);
+		}
+
+		TArray<FTableKey> Keys;
+		for (int32 Node = 0; Node < Compiled.NumNodes(); ++Node)
+		{
+			const FSGRowRange Range = Compiled.GetNodeRange(Node);
+			Keys.Add({ Compiled.GetNodeId(Node).ToString(), Range.Start, Range.Num });
+		}
+
+		Writer.AddTable(ESGNarrativeDbSection::DialogueTable, FSGDialogueDecisionRow::StaticStruct(), Rows, Keys);
+		Writer.AddDialoguePrograms(Compiled);
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeCook: %d dialogue rows, %d nodes."), Compiled.NumRows(), Compiled.NumNodes());
+	}
+
+	// 2) Decision points: the DataTable, else the parsed JSON (same precedence as the subsystem).
+	{
+		USGDecisionPointSubsystem::FIndex Index;
+		if (UDataTable* Table = Settings->DecisionPointsTable.LoadSynchronous())
+		{
+			USGDecisionPointSubsystem::BuildIndexFromRows(FSGNarrativeAsync::CopyRows<FSGDecisionPointRow>(Table, TEXT("USGNarrativeCookCommandlet::DecisionPoints")), Index);
+		}
+		else
+		{
+			USGDecisionPointSubsystem::BuildIndexFromJson(Settings->DecisionPointsJson, Index);
+		}
+
+		TArray<const void*> Prompts;
+		TArray<FTableKey> PromptKeys;
+		for (const auto& Pair : Index.PromptById)
+		{
+			PromptKeys.Add({ Pair.Key, Prompts.Num(), 1 });
+			Prompts.Add(&Pair.Value);
+		}
+		Writer.AddTable(ESGNarrativeDbSection::DecisionPromptTable, FSGDecisionPointRow::StaticStruct(), Prompts, PromptKeys);
+
+		TArray<const void*> Options;
+		TArray<FTableKey> OptionKeys;
+		for (const auto& Pair : Index.OptionsById)
+		{
+			OptionKeys.Add({ Pair.Key, Options.Num(), Pair.Value.Num() });
+			for (const FSGDecisionPointRow& Option : Pair.Value)
+			{
+				Options.Add(&Option);
+			}
+		}
+		Writer.AddTable(ESGNarrativeDbSection::DecisionOptionTable, FSGDecisionPointRow::StaticStruct(), Options, OptionKeys);
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeCook: %d decision points, %d options."), Prompts.Num(), Options.Num());
+	}
+
+	// 3) Cinematics: shots grouped per Questline|SceneId, in shot order.
+	{
+		TMap<FString, TArray<FSGCinematicShotRow>> ShotsByScene;
+		if (UDataTable* Table = Settings->CinematicsShotlistTable.LoadSynchronous())
+		{
+			USGCinematicsSubsystem::BuildIndexFromRows(FSGNarrativeAsync::CopyRows<FSGCinematicShotRow>(Table, TEXT("USGNarrativeCookCommandlet::Cinematics")), ShotsByScene);
+		}
+
+		TArray<const void*> Shots;
+		TArray<FTableKey> Keys;
+		for (const auto& Pair : ShotsByScene)
+		{
+			Keys.Add({ Pair.Key, Shots.Num(), Pair.Value.Num() });
+			for (const FSGCinematicShotRow& Shot : Pair.Value)
+			{
+				Shots.Add(&Shot);
+			}
+		}
+		Writer.AddTable(ESGNarrativeDbSection::CinematicShotTable, FSGCinematicShotRow::StaticStruct(), Shots, Keys);
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeCook: %d shots in %d scenes."), Shots.Num(), Keys.Num());
+	}
+
+	// 4) Quests: summaries under row name and code, details under code, branches as a grouped side table.
+	{
+		TArray<const void*> Summaries;
+		TArray<FTableKey> SummaryKeys;
+		if (UDataTable* Table = Settings->BranchQuestSummaryTable.LoadSynchronous())
+		{
+			static const FString Context = TEXT("USGNarrativeCookCommandlet::QuestSummary");
+			for (const FName& RowName : Table->GetRowNames())
+			{
+				if (const FSGBranchQuestSummaryRow* Row = Table->FindRow<FSGBranchQuestSummaryRow>(RowName, Context))
+				{
+					SummaryKeys.Add({ RowName.ToString(), Summaries.Num(), 1 });
+					if (!Row->code.IsNone())
+					{
+						SummaryKeys.Add({ Row->code.ToString(), Summaries.Num(), 1 });
+					}
+					Summaries.Add(Row);
+				}
+			}
+		}
+		Writer.AddTable(ESGNarrativeDbSection::QuestSummaryTable, FSGBranchQuestSummaryRow::StaticStruct(), Summaries, SummaryKeys);
+
+		TMap<FName, FSGBranchQuestDetails> DetailsByCode;
+		USGQuestSubsystem::ParseDetailsJson(Settings->BranchQuestDetailsJson, DetailsByCode);
+
+		TArray<const void*> Details;
+		TArray<FTableKey> DetailKeys;
+		TArray<const void*> Branches;
+		TArray<FTableKey> BranchKeys;
+		for (const auto& Pair : DetailsByCode)
+		{
+			DetailKeys.Add({ Pair.Key.ToString(), Details.Num(), 1 });
+			Details.Add(&Pair.Value);
+
+			BranchKeys.Add({ Pair.Key.ToString(), Branches.Num(), Pair.Value.branches.Num() });
+			for (const FSGBranchQuestBranch& Branch : Pair.Value.branches)
+			{
+				Branches.Add(&Branch);
+			}
+		}
+		Writer.AddTable(ESGNarrativeDbSection::QuestDetailsTable, FSGBranchQuestDetails::StaticStruct(), Details, DetailKeys);
+		Writer.AddTable(ESGNarrativeDbSection::QuestBranchTable, FSGBranchQuestBranch::StaticStruct(), Branches, BranchKeys);
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeCook: %d quest summaries, %d quest details."), Summaries.Num(), Details.Num());
+	}
+
+	if (!Writer.Save(OutPath))
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeCook: failed to write %s."), *OutPath);
+		return 1;
+	}
+
+	// Round-trip through the runtime reader so a bad cook fails here, not at game start.
+	if (!FSGNarrativeDatabase::Mount(OutPath).IsValid())
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeCook: %s does not mount."), *OutPath);
+		return 1;
+	}
+
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeCook: wrote %s (%d strings)."), *OutPath, Writer.NumStrings());
+	return 0;
+}
@@ -0,0 +1,314 @@
+#include "SGNarrativeDatabaseWriter.h"
+#include "SGCompiledDialogue.h"
+
+#include "Misc/FileHelper.h"
+
+FSGNarrativeDatabaseWriter::FSGNarrativeDatabaseWriter()
+{
+	// Id 0 is the empty string, so zeroed cells read back as "".
+	AddString(FStringView());
+}
+
+uint32 FSGNarrativeDatabaseWriter::AddString(FStringView Str)
+{
+	const FString Key(Str);
+	if (const uint32* Found = StringIds.Find(Key))
+	{
+		return *Found;
+	}
+
+	const uint32 Id = (uint32)Strings.Add(Key);
+	StringIds.Add(Key, Id);
+	return Id;
+}
+
+uint32 FSGNarrativeDatabaseWriter::AddList(const TArray<FString>& Values)
+{
+	const uint32 Offset = (uint32)Lists.Num();
+	Lists.Add((uint32)Values.Num());
+	for (const FString& Value : Values)
+	{
+		Lists.Add(AddString(Value));
+	}
+	return Offset;
+}
+
+void FSGNarrativeDatabaseWriter::AddTable(ESGNarrativeDbSection Section, const UScriptStruct* Struct, const TArray<const void*>& Rows, const TArray<FTableKey>& Keys)
+{
+	// 1) Schema: every property we know how to store as a 4-byte cell.
+	TArray<const FProperty*> Properties;
+	TArray<ESGNarrativeDbField> Kinds;
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		const FProperty* Property = *It;
+		if (Property->IsA<FStrProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::String);
+		}
+		else if (Property->IsA<FNameProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::Name);
+		}
+		else if (Property->IsA<FIntProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::Int);
+		}
+		else if (Property->IsA<FFloatProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::Float);
+		}
+		else if (Property->IsA<FBoolProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::Bool);
+		}
+		else if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Property); ArrayProp && ArrayProp->Inner->IsA<FStrProperty>())
+		{
+			Kinds.Add(ESGNarrativeDbField::StringList);
+		}
+		else
+		{
+			continue;
+		}
+		Properties.Add(Property);
+	}
+
+	// 2) Cells, row-major.
+	TArray<uint32> Cells;
+	Cells.Reserve(Rows.Num() * Properties.Num());
+
+	for (const void* Row : Rows)
+	{
+		for (int32 Field = 0; Field < Properties.Num(); ++Field)
+		{
+			const FProperty* Property = Properties[Field];
+			const void* Value = Property->ContainerPtrToValuePtr<void>(Row);
+
+			uint32 Cell = 0;
+			switch (Kinds[Field])
+			{
+			case ESGNarrativeDbField::String:
+				Cell = AddString(CastFieldChecked<FStrProperty>(Property)->GetPropertyValue(Value));
+				break;
+			case ESGNarrativeDbField::Name:
+			{
+				const FName Name = CastFieldChecked<FNameProperty>(Property)->GetPropertyValue(Value);
+				Cell = Name.IsNone() ? 0 : AddString(Name.ToString());
+				break;
+			}
+			case ESGNarrativeDbField::Int:
+				Cell = (uint32)CastFieldChecked<FIntProperty>(Property)->GetPropertyValue(Value);
+				break;
+			case ESGNarrativeDbField::Float:
+			{
+				const float Float = CastFieldChecked<FFloatProperty>(Property)->GetPropertyValue(Value);
+				FMemory::Memcpy(&Cell, &Float, sizeof(Cell));
+				break;
+			}
+			case ESGNarrativeDbField::Bool:
+				Cell = CastFieldChecked<FBoolProperty>(Property)->GetPropertyValue(Value) ? 1u : 0u;
+				break;
+			case ESGNarrativeDbField::StringList:
+				Cell = AddList(*reinterpret_cast<const TArray<FString>*>(Value));
+				break;
+			}
+			Cells.Add(Cell);
+		}
+	}
+
+	// 3) Key index: open addressing, load factor <= 1/2.
+	TArray<FSGNarrativeDbKey> DbKeys;
+	DbKeys.Reserve(Keys.Num());
+
+	TSet<FString> SeenKeys;
+	for (const FTableKey& Key : Keys)
+	{
+		bool bSeen = false;
+		SeenKeys.Add(Key.Key, &bSeen);
+		if (bSeen || Key.Key.IsEmpty())
+		{
+			continue;
+		}
+
+		FSGNarrativeDbKey& DbKey = DbKeys.AddDefaulted_GetRef();
+		DbKey.Key = AddString(Key.Key);
+		DbKey.Hash = FSGNarrativeDatabase::HashKey(Key.Key);
+		DbKey.Start = (uint32)Key.Start;
+		DbKey.Num = (uint32)Key.Num;
+	}
+
+	const uint32 NumBuckets = DbKeys.Num() > 0 ? FMath::RoundUpToPowerOfTwo((uint32)DbKeys.Num() * 2) : 0;
+	TArray<uint32> Buckets;
+	Buckets.SetNumZeroed(NumBuckets);
+
+	for (int32 KeyIdx = 0; KeyIdx < DbKeys.Num(); ++KeyIdx)
+	{
+		uint32 Bucket = DbKeys[KeyIdx].Hash & (NumBuckets - 1);
+		while (Buckets[Bucket] != 0)
+		{
+			Bucket = (Bucket + 1) & (NumBuckets - 1);
+		}
+		Buckets[Bucket] = (uint32)KeyIdx + 1;
+	}
+
+	// 4) Section bytes.
+	FSection& Out = Sections.AddDefaulted_GetRef();
+	Out.Type = Section;
+
+	FSGNarrativeDbTableHeader Header;
+	Header.NumFields = (uint32)Properties.Num();
+	Header.NumRows = (uint32)Rows.Num();
+	Header.NumKeys = (uint32)DbKeys.Num();
+	Header.NumBuckets = NumBuckets;
+	Append(Out.Bytes, Header);
+
+	for (const FProperty* Property : Properties)
+	{
+		Append(Out.Bytes, AddString(Property->GetName()));
+	}
+	for (const ESGNarrativeDbField Kind : Kinds)
+	{
+		Append(Out.Bytes, (uint32)Kind);
+	}
+	Append(Out.Bytes, Cells.GetData(), Cells.Num());
+	Append(Out.Bytes, DbKeys.GetData(), DbKeys.Num());
+	Append(Out.Bytes, Buckets.GetData(), Buckets.Num());
+}
+
+void FSGNarrativeDatabaseWriter::AddDialoguePrograms(const FSGCompiledDialogue& Compiled)
+{
+	TArray<FSGNarrativeDbProgram> Programs;
+	TArray<FSGNarrativeDbInstr> Instrs;
+	TArray<FSGNarrativeDbInstr> Effects;
+
+	TArray<FSGPredicateInstr> Conditions;
+	TArray<FSGPredicateInstr> Checks;
+	TArray<FSGEffectInstr> RowEffects;
+	FSGDialogueDecisionRow Row;
+
+	auto AddPredicates = [this, &Instrs](const TArray<FSGPredicateInstr>& Source)
+	{
+		for (const FSGPredicateInstr& Instr : Source)
+		{
+			FSGNarrativeDbInstr& Out = Instrs.AddDefaulted_GetRef();
+			Out.Op = (uint32)Instr.Op;
+			Out.Value = Instr.Operand;
+			Out.Key = Instr.Key.IsNone() ? 0 : AddString(Instr.Key.ToString());
+		}
+	};
+
+	for (int32 Slot = 0; Slot < Compiled.NumRows(); ++Slot)
+	{
+		Compiled.MaterializeRow(Slot, Row);
+		FSGCompiledDialogue::CompileRowSource(Row, Conditions, Checks, RowEffects);
+
+		FSGNarrativeDbProgram& Program = Programs.AddDefaulted_GetRef();
+		Program.ConditionStart = (uint32)Instrs.Num();
+		AddPredicates(Conditions);
+		Program.ConditionNum = (uint32)Instrs.Num() - Program.ConditionStart;
+
+		Program.CheckStart = (uint32)Instrs.Num();
+		AddPredicates(Checks);
+		Program.CheckNum = (uint32)Instrs.Num() - Program.CheckStart;
+
+		Program.EffectStart = (uint32)Effects.Num();
+		for (const FSGEffectInstr& Instr : RowEffects)
+		{
+			FSGNarrativeDbInstr& Out = Effects.AddDefaulted_GetRef();
+			Out.Op = (uint32)Instr.Op;
+			Out.Value = Instr.Delta;
+			Out.Key = Instr.Key.IsNone() ? 0 : AddString(Instr.Key.ToString());
+		}
+		Program.EffectNum = (uint32)Effects.Num() - Program.EffectStart;
+	}
+
+	FSection& ProgramSection = Sections.AddDefaulted_GetRef();
+	ProgramSection.Type = ESGNarrativeDbSection::DialoguePrograms;
+	Append(ProgramSection.Bytes, Programs.GetData(), Programs.Num());
+
+	FSection& InstrSection = Sections.AddDefaulted_GetRef();
+	InstrSection.Type = ESGNarrativeDbSection::DialogueInstrs;
+	Append(InstrSection.Bytes, Instrs.GetData(), Instrs.Num());
+
+	FSection& EffectSection = Sections.AddDefaulted_GetRef();
+	EffectSection.Type = ESGNarrativeDbSection::DialogueEffects;
+	Append(EffectSection.Bytes, Effects.GetData(), Effects.Num());
+}
+
+void FSGNarrativeDatabaseWriter::Serialize(TArray<uint8>& Out) const
+{
+	// Strings and lists are only final once every table has been added.
+	FSection StringSection;
+	StringSection.Type = ESGNarrativeDbSection::Strings;
+	{
+		FSGNarrativeDbStrings Header;
+		Header.NumStrings = (uint32)Strings.Num();
+		Append(StringSection.Bytes, Header);
+
+		uint32 Offset = 0;
+		for (const FString& Str : Strings)
+		{
+			Append(StringSection.Bytes, Offset);
+			Offset += (uint32)Str.Len();
+		}
+		Append(StringSection.Bytes, Offset);
+
+		for (const FString& Str : Strings)
+		{
+			Append(StringSection.Bytes, *Str, Str.Len());
+		}
+	}
+
+	FSection ListSection;
+	ListSection.Type = ESGNarrativeDbSection::Lists;
+	Append(ListSection.Bytes, Lists.GetData(), Lists.Num());
+
+	TArray<const FSection*> All;
+	All.Add(&StringSection);
+	All.Add(&ListSection);
+	for (const FSection& Section : Sections)
+	{
+		All.Add(&Section);
+	}
+
+	auto PadTo8 = [&Out]()
+	{
+		Out.AddZeroed(Align(Out.Num(), 8) - Out.Num());
+	};
+
+	Out.Reset();
+
+	FSGNarrativeDbHeader Header;
+	Header.Magic = FSGNarrativeDatabase::Magic;
+	Header.Version = FSGNarrativeDatabase::Version;
+	Header.NumSections = (uint32)All.Num();
+	Append(Out, Header);
+
+	const int32 TableOffset = Out.Num();
+	Out.AddZeroed(All.Num() * sizeof(FSGNarrativeDbSection));
+
+	TArray<FSGNarrativeDbSection> Table;
+	for (const FSection* Section : All)
+	{
+		PadTo8();
+
+		FSGNarrativeDbSection& Entry = Table.AddDefaulted_GetRef();
+		Entry.Type = (uint32)Section->Type;
+		Entry.Offset = (uint64)Out.Num();
+		Entry.Size = (uint64)Section->Bytes.Num();
+		Out.Append(Section->Bytes);
+	}
+	PadTo8();
+
+	FMemory::Memcpy(Out.GetData() + TableOffset, Table.GetData(), Table.Num() * sizeof(FSGNarrativeDbSection));
+
+	Header.TotalSize = (uint64)Out.Num();
+	FMemory::Memcpy(Out.GetData(), &Header, sizeof(Header));
+}
+
+bool FSGNarrativeDatabaseWriter::Save(const FString& AbsPath) const
+{
+	TArray<uint8> Bytes;
+	Serialize(Bytes);
+	return FFileHelper::SaveArrayToFile(Bytes, *AbsPath);
+}
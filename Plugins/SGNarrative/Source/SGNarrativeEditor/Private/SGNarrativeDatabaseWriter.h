@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGNarrativeDatabase.h"
+
+class FSGCompiledDialogue;
+
+/**
+ * Builds a cooked narrative database (see SGNarrativeDatabase.h for the layout).
+ *
+ * Strings are interned across all tables. Tables are written from UStruct rows by reflection:
+ * FString, FName, int32, float, bool and TArray<FString> properties become cells, anything else
+ * (nested struct arrays) is left to a separate table.
+ */
+class FSGNarrativeDatabaseWriter
+{
+public:
+	/** A contiguous run of rows stored under one lookup key. */
+	struct FTableKey
+	{
+		FString Key;
+		int32 Start = 0;
+		int32 Num = 0;
+	};
+
+	FSGNarrativeDatabaseWriter();
+
+	uint32 AddString(FStringView Str);
+
+	/** Rows must already be in their final order; keys index runs of them. Later duplicate keys are dropped. */
+	void AddTable(ESGNarrativeDbSection Section, const UScriptStruct* Struct, const TArray<const void*>& Rows, const TArray<FTableKey>& Keys);
+
+	/** Store the unfolded predicate/effect program of every row of Compiled, in slot order. */
+	void AddDialoguePrograms(const FSGCompiledDialogue& Compiled);
+
+	void Serialize(TArray<uint8>& Out) const;
+	bool Save(const FString& AbsPath) const;
+
+	int32 NumStrings() const { return Strings.Num(); }
+
+private:
+	/** String ids must be case-sensitive; the default FString map key is not. */
+	struct FStringIdKeyFuncs : TDefaultMapKeyFuncs<FString, uint32, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
+
+	struct FSection
+	{
+		ESGNarrativeDbSection Type = ESGNarrativeDbSection::Count;
+		TArray<uint8> Bytes;
+	};
+
+	TMap<FString, uint32, FDefaultSetAllocator, FStringIdKeyFuncs> StringIds;
+	TArray<FString> Strings;
+	TArray<uint32> Lists;
+	TArray<FSection> Sections;
+
+	uint32 AddList(const TArray<FString>& Values);
+
+	template <typename T>
+	static void Append(TArray<uint8>& Out, const T* Data, int32 Num)
+	{
+		Out.Append(reinterpret_cast<const uint8*>(Data), Num * (int32)sizeof(T));
+	}
+
+	template <typename T>
+	static void Append(TArray<uint8>& Out, const T& Value)
+	{
+		Append(Out, &Value, 1);
+	}
+};
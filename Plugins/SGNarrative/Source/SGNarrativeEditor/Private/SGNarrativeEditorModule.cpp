@@ -0,0 +1,10 @@
+#include "Modules/ModuleManager.h"
+
+class FSGNarrativeEditorModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override {}
+	virtual void ShutdownModule() override {}
+};
+
+IMPLEMENT_MODULE(FSGNarrativeEditorModule, SGNarrativeEditor)
@@ -0,0 +1,419 @@
+#include "SGNarrativeGenerateCommandlet.h"
+
+#include "SGCinematicsSubsystem.h"
+#include "SGCompiledDialogue.h"
+#include "SGDecisionPointSubsystem.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGQuestSubsystem.h"
+
+#include "Engine/DataTable.h"
+#include "JsonObjectConverter.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Source rows split into the groups that are copied whole. */
+	template <typename RowType>
+	using TRowGroups = TArray<TArray<const RowType*>>;
+
+	/**
+	 * Draw random groups and append renamed copies until Out has TargetRows rows.
+	 * Rename(Row, Group, Copy) is called on every copied row; Copy is unique per emitted group.
+	 */
+	template <typename RowType, typename RenameType>
+	void Resample(const TRowGroups<RowType>& Groups, int32 TargetRows, FRandomStream& Rng, RenameType&& Rename, TArray<RowType>& Out)
+	{
+		if (Groups.Num() == 0)
+		{
+			return;
+		}
+
+		for (int32 Copy = 0; Out.Num() < TargetRows; ++Copy)
+		{
+			const int32 Group = Rng.RandHelper(Groups.Num());
+			for (const RowType* Source : Groups[Group])
+			{
+				RowType& Row = Out.Add_GetRef(*Source);
+				Rename(Row, Group, Copy);
+			}
+		}
+	}
+
+	/** Group rows by Key(Row), groups in order of first appearance. */
+	template <typename RowType, typename KeyFuncType>
+	void GroupRows(const TArray<RowType*>& Rows, KeyFuncType&& Key, TRowGroups<RowType>& Out)
+	{
+		TMap<FString, int32> GroupByKey;
+		for (const RowType* Row : Rows)
+		{
+			if (!Row)
+			{
+				continue;
+			}
+
+			const FString RowKey = Key(*Row);
+			int32* Group = GroupByKey.Find(RowKey);
+			if (!Group)
+			{
+				Group = &GroupByKey.Add(RowKey, Out.Num());
+				Out.AddDefaulted();
+			}
+			Out[*Group].Add(Row);
+		}
+	}
+
+	bool IsEmptyList(const FString& JsonLike)
+	{
+		const FString Trim = JsonLike.TrimStartAndEnd();
+		return Trim.IsEmpty() || Trim == TEXT("[]") || Trim == TEXT("{}");
+	}
+
+	/** Rewrite a `["flag", "!flag"]` list, suffixing the flags in Local. */
+	FString RenameFlags(const FString& JsonLikeArray, const TSet<FString>& Local, const FString& Suffix)
+	{
+		TArray<FString> Parts;
+		FSGCompiledDialogue::ParseStringArrayJson(JsonLikeArray, Parts);
+		if (Parts.Num() == 0)
+		{
+			return JsonLikeArray;
+		}
+
+		TArray<FString> Quoted;
+		for (const FString& Part : Parts)
+		{
+			const FString Trim = Part.TrimStartAndEnd();
+			const bool bNot = Trim.StartsWith(TEXT("!"));
+			const FString Flag = bNot ? Trim.Mid(1).TrimStartAndEnd() : Trim;
+			Quoted.Add(FString::Printf(TEXT("\"%s%s%s\""), bNot ? TEXT("!") : TEXT(""), *Flag, Local.Contains(Flag) ? *Suffix : TEXT("")));
+		}
+		return TEXT("[") + FString::Join(Quoted, TEXT(", ")) + TEXT("]");
+	}
+
+	/** Row shape counts, logged for source and output so the two can be compared. */
+	struct FDialogueShape
+	{
+		int32 Rows = 0;
+		int32 Decisions = 0;
+		int32 Options = 0;
+		int32 WithConditions = 0;
+		int32 WithChecks = 0;
+		int32 WithFlags = 0;
+		int32 WithGrants = 0;
+
+		void Add(const FSGDialogueDecisionRow& Row)
+		{
+			++Rows;
+			const ESGDialogueRowType Type = FSGCompiledDialogue::ParseRowType(Row.type);
+			Decisions += Type == ESGDialogueRowType::Decision;
+			Options += Type == ESGDialogueRowType::DecisionOption;
+			WithConditions += !IsEmptyList(Row.conditions);
+			WithChecks += !IsEmptyList(Row.checks);
+			WithFlags += !IsEmptyList(Row.set_flags);
+			WithGrants += !IsEmptyList(Row.grants);
+		}
+
+		void Log(const TCHAR* Label) const
+		{
+			const double Num = FMath::Max(Rows, 1);
+			UE_LOG(LogSGNarrative, Display, TEXT("  %s: %d rows, %.2f options/decision, conditions %.1f%%, checks %.1f%%, set_flags %.1f%%, grants %.1f%%"),
+				Label, Rows, Decisions > 0 ? (double)Options / Decisions : 0.0,
+				100.0 * WithConditions / Num, 100.0 * WithChecks / Num, 100.0 * WithFlags / Num, 100.0 * WithGrants / Num);
+		}
+	};
+
+	/** Write Rows as a DataTable CSV (row names Prefix_000000...), the format the DataTable importer reads. */
+	template <typename RowType>
+	bool WriteTable(const FString& OutDir, const TCHAR* FileName, const TCHAR* Prefix, const TArray<RowType>& Rows)
+	{
+		UDataTable* Table = NewObject<UDataTable>(GetTransientPackage());
+		Table->RowStruct = RowType::StaticStruct();
+		for (int32 Idx = 0; Idx < Rows.Num(); ++Idx)
+		{
+			Table->AddRow(*FString::Printf(TEXT("%s_%06d"), Prefix, Idx), Rows[Idx]);
+		}
+
+		const FString Path = FPaths::Combine(OutDir, FileName);
+		if (!FFileHelper::SaveStringToFile(Table->GetTableAsCSV(), *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeGenerate: failed to write %s."), *Path);
+			return false;
+		}
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeGenerate: %s, %d rows."), *Path, Rows.Num());
+		return true;
+	}
+
+	template <typename RowType>
+	void LoadRows(const TSoftObjectPtr<UDataTable>& Source, TArray<RowType*>& Out)
+	{
+		if (UDataTable* Table = Source.LoadSynchronous())
+		{
+			static const FString Context = TEXT("USGNarrativeGenerateCommandlet");
+			Table->GetAllRows(Context, Out);
+		}
+	}
+
+	/** Conversations: one group per quest. Ids and flags set inside the group get the copy suffix. */
+	bool GenerateDialogue(const USGNarrativeSettings& Settings, int32 Scale, FRandomStream& Rng, const FString& OutDir)
+	{
+		TArray<FSGDialogueDecisionRow*> SourceRows;
+		LoadRows(Settings.DialogueDecisionTable, SourceRows);
+		if (SourceRows.Num() == 0)
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeGenerate: no dialogue rows, skipped."));
+			return true;
+		}
+
+		TRowGroups<FSGDialogueDecisionRow> Groups;
+		GroupRows(SourceRows, [](const FSGDialogueDecisionRow& Row) { return Row.quest; }, Groups);
+
+		// Per group: the ids it defines and the flags it sets. Anything else (END markers, flags
+		// from other quests, rep/trust keys) stays shared between copies.
+		TArray<TSet<FName>> LocalIds;
+		TArray<TSet<FString>> LocalFlags;
+		for (const TArray<const FSGDialogueDecisionRow*>& Group : Groups)
+		{
+			TSet<FName>& Ids = LocalIds.AddDefaulted_GetRef();
+			TSet<FString>& Flags = LocalFlags.AddDefaulted_GetRef();
+
+			TArray<FString> Parts;
+			for (const FSGDialogueDecisionRow* Row : Group)
+			{
+				Ids.Add(Row->id);
+				FSGCompiledDialogue::ParseStringArrayJson(Row->set_flags, Parts);
+				for (const FString& Flag : Parts)
+				{
+					Flags.Add(Flag.TrimStartAndEnd());
+				}
+			}
+		}
+
+		TArray<FSGDialogueDecisionRow> Rows;
+		Resample(Groups, SourceRows.Num() * Scale, Rng, [&](FSGDialogueDecisionRow& Row, int32 Group, int32 Copy)
+		{
+			const FString IdSuffix = FString::Printf(TEXT("_S%d"), Copy);
+			if (LocalIds[Group].Contains(Row.id))
+			{
+				Row.id = *(Row.id.ToString() + IdSuffix);
+			}
+			if (!Row.next.IsNone() && LocalIds[Group].Contains(Row.next))
+			{
+				Row.next = *(Row.next.ToString() + IdSuffix);
+			}
+
+			const FString FlagSuffix = FString::Printf(TEXT("_s%d"), Copy);
+			Row.conditions = RenameFlags(Row.conditions, LocalFlags[Group], FlagSuffix);
+			Row.set_flags = RenameFlags(Row.set_flags, LocalFlags[Group], FlagSuffix);
+			Row.quest = FString::Printf(TEXT("%s #%d"), *Row.quest, Copy);
+		}, Rows);
+
+		FDialogueShape SourceShape;
+		for (const FSGDialogueDecisionRow* Row : SourceRows)
+		{
+			SourceShape.Add(*Row);
+		}
+		FDialogueShape OutShape;
+		for (const FSGDialogueDecisionRow& Row : Rows)
+		{
+			OutShape.Add(Row);
+		}
+		SourceShape.Log(TEXT("dialogue source"));
+		OutShape.Log(TEXT("dialogue output"));
+
+		return WriteTable(OutDir, TEXT("DT_DialogueDecisionSuite_Synthetic.csv"), TEXT("DLG"), Rows);
+	}
+
+	/** Main quest lines and optional prompts: one group per beat, renumbered in output order. */
+	bool GenerateQuestLines(const TSoftObjectPtr<UDataTable>& Source, const TCHAR* FileName, const TCHAR* Prefix, int32 Scale, FRandomStream& Rng, const FString& OutDir)
+	{
+		TArray<FSGMainQuestLineRow*> SourceRows;
+		LoadRows(Source, SourceRows);
+		if (SourceRows.Num() == 0)
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeGenerate: no rows for %s, skipped."), FileName);
+			return true;
+		}
+
+		TRowGroups<FSGMainQuestLineRow> Groups;
+		GroupRows(SourceRows, [](const FSGMainQuestLineRow& Row) { return Row.beat_id.ToString(); }, Groups);
+
+		TArray<FSGMainQuestLineRow> Rows;
+		Resample(Groups, SourceRows.Num() * Scale, Rng, [&](FSGMainQuestLineRow& Row, int32 Group, int32 Copy)
+		{
+			Row.beat_id = *FString::Printf(TEXT("%s_S%d"), *Row.beat_id.ToString(), Copy);
+			Row.seq = Rows.Num();
+		}, Rows);
+
+		return WriteTable(OutDir, FileName, Prefix, Rows);
+	}
+
+	/** Decision points: prompt + options per dp_id (same table/JSON precedence as the subsystem). */
+	bool GenerateDecisionPoints(const USGNarrativeSettings& Settings, int32 Scale, FRandomStream& Rng, const FString& OutDir)
+	{
+		USGDecisionPointSubsystem::FIndex Index;
+		TArray<FSGDecisionPointRow> TableRows = FSGNarrativeAsync::CopyRows<FSGDecisionPointRow>(Settings.DecisionPointsTable.LoadSynchronous(), TEXT("USGNarrativeGenerateCommandlet"));
+		if (TableRows.Num() > 0)
+		{
+			USGDecisionPointSubsystem::BuildIndexFromRows(MoveTemp(TableRows), Index);
+		}
+		else
+		{
+			USGDecisionPointSubsystem::BuildIndexFromJson(Settings.DecisionPointsJson, Index);
+		}
+
+		TArray<FString> Ids;
+		Index.PromptById.GetKeys(Ids);
+		for (const auto& Pair : Index.OptionsById)
+		{
+			Ids.AddUnique(Pair.Key);
+		}
+		Ids.Sort();
+
+		TRowGroups<FSGDecisionPointRow> Groups;
+		int32 NumSourceRows = 0;
+		for (const FString& Id : Ids)
+		{
+			TArray<const FSGDecisionPointRow*>& Group = Groups.AddDefaulted_GetRef();
+			if (const FSGDecisionPointRow* Prompt = Index.PromptById.Find(Id))
+			{
+				Group.Add(Prompt);
+			}
+			if (const TArray<FSGDecisionPointRow>* Options = Index.OptionsById.Find(Id))
+			{
+				for (const FSGDecisionPointRow& Option : *Options)
+				{
+					Group.Add(&Option);
+				}
+			}
+			NumSourceRows += Group.Num();
+		}
+		if (NumSourceRows == 0)
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeGenerate: no decision points, skipped."));
+			return true;
+		}
+
+		TArray<FSGDecisionPointRow> Rows;
+		Resample(Groups, NumSourceRows * Scale, Rng, [](FSGDecisionPointRow& Row, int32 Group, int32 Copy)
+		{
+			Row.dp_id = FString::Printf(TEXT("%s-S%d"), *Row.dp_id, Copy);
+			Row.scene = FString::Printf(TEXT("%s #%d"), *Row.scene, Copy);
+		}, Rows);
+
+		return WriteTable(OutDir, TEXT("DT_DecisionPoints_Synthetic.csv"), TEXT("DP"), Rows);
+	}
+
+	/** Shotlist: one group per Questline|SceneId. */
+	bool GenerateShots(const USGNarrativeSettings& Settings, int32 Scale, FRandomStream& Rng, const FString& OutDir)
+	{
+		TArray<FSGCinematicShotRow*> SourceRows;
+		LoadRows(Settings.CinematicsShotlistTable, SourceRows);
+		if (SourceRows.Num() == 0)
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeGenerate: no shots, skipped."));
+			return true;
+		}
+
+		TRowGroups<FSGCinematicShotRow> Groups;
+		GroupRows(SourceRows, [](const FSGCinematicShotRow& Row) { return USGCinematicsSubsystem::MakeSceneKey(Row.questline, Row.scene_id); }, Groups);
+
+		TArray<FSGCinematicShotRow> Rows;
+		Resample(Groups, SourceRows.Num() * Scale, Rng, [](FSGCinematicShotRow& Row, int32 Group, int32 Copy)
+		{
+			Row.questline = FString::Printf(TEXT("%s #%d"), *Row.questline, Copy);
+			Row.scene_id = FString::Printf(TEXT("%s-S%d"), *Row.scene_id, Copy);
+		}, Rows);
+
+		return WriteTable(OutDir, TEXT("DT_CinematicsShotlist_Synthetic.csv"), TEXT("SHOT"), Rows);
+	}
+
+	/** Quest details JSON: whole quests (all branches and objectives), scaled by quest count. */
+	bool GenerateQuestDetails(const USGNarrativeSettings& Settings, int32 Scale, FRandomStream& Rng, const FString& OutDir)
+	{
+		TMap<FName, FSGBranchQuestDetails> DetailsByCode;
+		USGQuestSubsystem::ParseDetailsJson(Settings.BranchQuestDetailsJson, DetailsByCode);
+		if (DetailsByCode.Num() == 0)
+		{
+			UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeGenerate: no quest details, skipped."));
+			return true;
+		}
+
+		DetailsByCode.KeySort(FNameLexicalLess());
+
+		TRowGroups<FSGBranchQuestDetails> Groups;
+		for (const auto& Pair : DetailsByCode)
+		{
+			Groups.AddDefaulted_GetRef().Add(&Pair.Value);
+		}
+
+		FSGBranchQuestDetailsFile File;
+		File.generated_from = TEXT("SGNarrativeGenerate");
+		Resample(Groups, DetailsByCode.Num() * Scale, Rng, [](FSGBranchQuestDetails& Quest, int32 Group, int32 Copy)
+		{
+			Quest.code = *FString::Printf(TEXT("%s_S%d"), *Quest.code.ToString(), Copy);
+			Quest.title = FString::Printf(TEXT("%s #%d"), *Quest.title, Copy);
+		}, File.quests);
+
+		FString Json;
+		const FString Path = FPaths::Combine(OutDir, TEXT("BranchQuestOutlines_Synthetic.parsed.json"));
+		if (!FJsonObjectConverter::UStructToJsonObjectString(File, Json) || !FFileHelper::SaveStringToFile(Json, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeGenerate: failed to write %s."), *Path);
+			return false;
+		}
+
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeGenerate: %s, %d quests."), *Path, File.quests.Num());
+		return true;
+	}
+}
+
+USGNarrativeGenerateCommandlet::USGNarrativeGenerateCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USGNarrativeGenerateCommandlet::Main(const FString& Params)
+{
+	const USGNarrativeSettings* Settings = GetDefault<USGNarrativeSettings>();
+
+	int32 Scale = 50;
+	int32 Seed = 0;
+	FParse::Value(*Params, TEXT("Scale="), Scale);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	Scale = FMath::Max(Scale, 1);
+
+	FString OutDir;
+	if (!FParse::Value(*Params, TEXT("Out="), OutDir))
+	{
+		OutDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SGNarrativeSynthetic"));
+	}
+	if (FPaths::IsRelative(OutDir))
+	{
+		OutDir = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), OutDir));
+	}
+
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeGenerate: scale %d, seed %d, into %s."), Scale, Seed, *OutDir);
+
+	// One stream per source, so output for one table does not depend on the others being present.
+	FRandomStream DialogueRng(Seed);
+	FRandomStream MainQuestRng(Seed + 1);
+	FRandomStream PromptRng(Seed + 2);
+	FRandomStream DecisionRng(Seed + 3);
+	FRandomStream ShotRng(Seed + 4);
+	FRandomStream QuestRng(Seed + 5);
+
+	bool bOk = GenerateDialogue(*Settings, Scale, DialogueRng, OutDir);
+	bOk &= GenerateQuestLines(Settings->MainQuestDialogueTable, TEXT("DT_MainQuestDialogue_Synthetic.csv"), TEXT("MQ"), Scale, MainQuestRng, OutDir);
+	bOk &= GenerateQuestLines(Settings->OptionalPromptsTable, TEXT("DT_OptionalPrompts_Synthetic.csv"), TEXT("OP"), Scale, PromptRng, OutDir);
+	bOk &= GenerateDecisionPoints(*Settings, Scale, DecisionRng, OutDir);
+	bOk &= GenerateShots(*Settings, Scale, ShotRng, OutDir);
+	bOk &= GenerateQuestDetails(*Settings, Scale, QuestRng, OutDir);
+
+	return bOk ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+#include "SGNarrativeKeysCommandlet.h"
+
+#include "SGCompiledDialogue.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGStateKeyRegistry.h"
+
+#include "Engine/DataTable.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Key name -> C++ identifier: anything but [A-Za-z0-9_] becomes '_', and a leading digit gets one too. */
+	FString MakeIdentifier(const FString& Key)
+	{
+		FString Out;
+		Out.Reserve(Key.Len() + 1);
+		for (const TCHAR C : Key)
+		{
+			Out.AppendChar((FChar::IsAlnum(C) && C < 128) || C == TCHAR('_') ? C : TCHAR('_'));
+		}
+		if (Out.IsEmpty() || FChar::IsDigit(Out[0]))
+		{
+			Out.InsertAt(0, TCHAR('_'));
+		}
+		return Out;
+	}
+
+	FString EscapeLiteral(const FString& Key)
+	{
+		return Key.ReplaceCharWithEscapedChar();
+	}
+
+	void SortKeys(TSet<FName>& Keys, TArray<FName>& Out)
+	{
+		Out = Keys.Array();
+		Out.Sort(FNameLexicalLess());
+	}
+
+	/** One name table plus a constant per key; identifiers already taken are skipped with a warning. */
+	void WriteKeys(const TArray<FName>& Keys, const TCHAR* Kind, const TCHAR* KeyType, TSet<FString>& UsedIdentifiers, FString& Out)
+	{
+		Out += FString::Printf(TEXT("\tinline constexpr int32 Num%s = %d;\n\n"), Kind, Keys.Num());
+
+		// A zero-length array is ill-formed, so an empty table keeps one unused entry.
+		Out += FString::Printf(TEXT("\tinline constexpr const TCHAR* %sNames[Num%s > 0 ? Num%s : 1] =\n\t{\n"), KeyType, Kind, Kind);
+		for (const FName& Key : Keys)
+		{
+			Out += FString::Printf(TEXT("\t\tTEXT(\"%s\"),\n"), *EscapeLiteral(Key.ToString()));
+		}
+		if (Keys.Num() == 0)
+		{
+			Out += TEXT("\t\tTEXT(\"\"),\n");
+		}
+		Out += TEXT("\t};\n\n");
+
+		for (int32 Index = 0; Index < Keys.Num(); ++Index)
+		{
+			const FString Identifier = MakeIdentifier(Keys[Index].ToString());
+
+			bool bTaken = false;
+			UsedIdentifiers.Add(Identifier, &bTaken);
+			if (bTaken)
+			{
+				UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeKeys: %s key '%s' maps to identifier '%s', which is already used; no constant emitted."),
+					KeyType, *Keys[Index].ToString(), *Identifier);
+				continue;
+			}
+
+			Out += FString::Printf(TEXT("\tinline constexpr FSG%sKey %s{ %d };\n"), KeyType, *Identifier, Index);
+		}
+	}
+}
+
+USGNarrativeKeysCommandlet::USGNarrativeKeysCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USGNarrativeKeysCommandlet::Main(const FString& Params)
+{
+	FString OutPath;
+	if (!FParse::Value(*Params, TEXT("Out="), OutPath))
+	{
+		OutPath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("SGNarrative/Source/SGNarrative/Public/SGKeys.h"));
+	}
+	if (FPaths::IsRelative(OutPath))
+	{
+		OutPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), OutPath));
+	}
+	const bool bCheck = FParse::Param(*Params, TEXT("Check"));
+
+	TSet<FName> Flags;
+	TSet<FName> Ints;
+
+	// 1) Project keys: gameplay tags and the state keys notes.
+	{
+		TArray<FName> ProjectFlags;
+		TArray<FName> ProjectInts;
+		FSGStateKeyRegistry::CollectProjectKeys(ProjectFlags, ProjectInts);
+		Flags.Append(ProjectFlags);
+		Ints.Append(ProjectInts);
+	}
+
+	// 2) Every key a dialogue row reads or writes, exactly as the compiler resolves it.
+	// Keys are taken from the instructions, not the registry, which already holds the previous SGKeys.h.
+	UDataTable* Table = GetDefault<USGNarrativeSettings>()->DialogueDecisionTable.LoadSynchronous();
+	if (!Table)
+	{
+		UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeKeys: DialogueDecisionTable is not set; only project keys are written."));
+	}
+	else
+	{
+		static const FString Context = TEXT("USGNarrativeKeysCommandlet");
+		TArray<FSGDialogueDecisionRow*> SourceRows;
+		Table->GetAllRows(Context, SourceRows);
+
+		TArray<FSGPredicateInstr> Conditions;
+		TArray<FSGPredicateInstr> Checks;
+		TArray<FSGEffectInstr> Effects;
+		for (const FSGDialogueDecisionRow* Row : SourceRows)
+		{
+			if (!Row)
+			{
+				continue;
+			}
+
+			FSGCompiledDialogue::CompileRowSource(*Row, Conditions, Checks, Effects);
+			for (const FSGPredicateInstr& Instr : Conditions)
+			{
+				// `ga.*` names a tag, not a flag.
+				if (!FSGCompiledDialogue::IsFlagTagOp(Instr.Op))
+				{
+					Flags.Add(Instr.Key);
+				}
+			}
+			for (const FSGPredicateInstr& Instr : Checks)
+			{
+				Ints.Add(Instr.Key);
+			}
+			for (const FSGEffectInstr& Instr : Effects)
+			{
+				(Instr.Op == ESGEffectOp::AddFlag ? Flags : Ints).Add(Instr.Key);
+			}
+		}
+	}
+
+	Flags.Remove(NAME_None);
+	Ints.Remove(NAME_None);
+
+	TArray<FName> SortedFlags;
+	TArray<FName> SortedInts;
+	SortKeys(Flags, SortedFlags);
+	SortKeys(Ints, SortedInts);
+
+	// 3) Emit.
+	FString Out;
+	Out += TEXT("// Generated by the SGNarrativeKeys commandlet from the narrative data. Do not edit by hand; re-run\n");
+	Out += TEXT("//   UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeKeys\n");
+	Out += TEXT("// after adding or renaming story keys.\n\n");
+	Out += TEXT("#pragma once\n\n");
+	Out += TEXT("#include \"CoreMinimal.h\"\n");
+	Out += TEXT("#include \"SGStoryState.h\"\n\n");
+	Out += TEXT("/** Story keys known at compile time. Each constant is the key's FSGStateKeyRegistry slot. */\n");
+	Out += TEXT("namespace SGKeys\n{\n");
+
+	TSet<FString> UsedIdentifiers = { TEXT("NumFlags"), TEXT("FlagNames"), TEXT("NumInts"), TEXT("IntNames") };
+	WriteKeys(SortedFlags, TEXT("Flags"), TEXT("Flag"), UsedIdentifiers, Out);
+	Out += TEXT("\n");
+	WriteKeys(SortedInts, TEXT("Ints"), TEXT("Int"), UsedIdentifiers, Out);
+	Out += TEXT("}\n");
+
+	FString Existing;
+	const bool bUpToDate = FFileHelper::LoadFileToString(Existing, *OutPath) && Existing == Out;
+
+	if (bCheck)
+	{
+		if (!bUpToDate)
+		{
+			UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeKeys: %s is out of date; run -run=SGNarrativeKeys."), *OutPath);
+			return 1;
+		}
+		UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeKeys: %s is up to date (%d flags, %d ints)."), *OutPath, SortedFlags.Num(), SortedInts.Num());
+		return 0;
+	}
+
+	// Unchanged contents keep the old timestamp, so nothing that includes the header rebuilds.
+	if (!bUpToDate && !FFileHelper::SaveStringToFile(Out, *OutPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeKeys: could not write %s."), *OutPath);
+		return 1;
+	}
+
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeKeys: %d flags, %d ints %s %s."),
+		SortedFlags.Num(), SortedInts.Num(), bUpToDate ? TEXT("already in") : TEXT("written to"), *OutPath);
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "SGNarrativeSearchCommandlet.h"
+
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSearchSubsystem.h"
+#include "SGNarrativeTextIndex.h"
+
+#include "HAL/PlatformTime.h"
+
+USGNarrativeSearchCommandlet::USGNarrativeSearchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USGNarrativeSearchCommandlet::Main(const FString& Params)
+{
+	FString Query;
+	int32 MaxHits = 50;
+	FParse::Value(*Params, TEXT("Query="), Query);
+	FParse::Value(*Params, TEXT("Max="), MaxHits);
+	const bool bSubstring = FParse::Param(*Params, TEXT("Substring"));
+
+	if (Query.IsEmpty())
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeSearch: pass -Query=\"...\"."));
+		return 1;
+	}
+
+	// 1) Index every source.
+	const double BuildStart = FPlatformTime::Seconds();
+
+	FSGNarrativeTextIndex Index;
+	for (int32 SourceIdx = 0; SourceIdx < (int32)ESGNarrativeTextSource::Num; ++SourceIdx)
+	{
+		TArray<FSGNarrativeTextEntry> Entries;
+		USGNarrativeSearchSubsystem::CollectEntries((ESGNarrativeTextSource)SourceIdx, Entries);
+		Index.UpdateSource((ESGNarrativeTextSource)SourceIdx, Entries);
+	}
+
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeSearch: indexed %d lines in %.1f ms (%.1f MB)."),
+		Index.Num(), (FPlatformTime::Seconds() - BuildStart) * 1000.0, Index.GetAllocatedSize() / (1024.0 * 1024.0));
+
+	// 2) Query.
+	const double QueryStart = FPlatformTime::Seconds();
+
+	TArray<FSGNarrativeSearchHit> Hits;
+	if (bSubstring)
+	{
+		Index.FindSubstring(Query, Hits, MaxHits);
+	}
+	else
+	{
+		Index.FindWords(Query, Hits, MaxHits);
+	}
+
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeSearch: \"%s\" (%s): %d hits in %.3f ms."),
+		*Query, bSubstring ? TEXT("substring") : TEXT("words"), Hits.Num(), (FPlatformTime::Seconds() - QueryStart) * 1000.0);
+
+	for (const FSGNarrativeSearchHit& Hit : Hits)
+	{
+		UE_LOG(LogSGNarrative, Display, TEXT("  [%s] %s.%s: %s"),
+			*UEnum::GetDisplayValueAsText(Hit.Source).ToString(), *Hit.Row.ToString(), *Hit.Field.ToString(), *Hit.Text);
+	}
+
+	return 0;
+}
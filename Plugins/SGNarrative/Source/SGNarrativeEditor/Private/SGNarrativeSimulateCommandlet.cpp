@@ -0,0 +1,562 @@
+#include "SGNarrativeSimulateCommandlet.h"
+
+#include "SGCompiledDialogue.h"
+#include "SGNarrativeDatabase.h"
+#include "SGNarrativeLog.h"
+#include "SGNarrativeSettings.h"
+#include "SGStateKeyRegistry.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/DataTable.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Random runs per ParallelFor item. */
+	constexpr int32 RunsPerBatch = 256;
+
+	enum class ESGRunEnd : uint8
+	{
+		/** A row without `next`. */
+		Ended,
+		/** A decision with no available option. */
+		DeadEnd,
+		/** -MaxSteps reached (usually a loop in the graph). */
+		StepLimit,
+	};
+
+	/** Counters for some runs. All sums, so merging per-thread stats in any order gives the same report. */
+	struct FSimStats
+	{
+		int64 Runs = 0;
+		int64 Steps = 0;
+		int64 Ended = 0;
+		int64 DeadEnds = 0;
+		int64 StepLimits = 0;
+
+		/** Exhaustive only: start nodes that hit -MaxPaths before every path was walked. */
+		int64 TruncatedStarts = 0;
+
+		/** Exhaustive -Dedupe only: branches dropped because their (node, state) was already walked. */
+		int64 MergedBranches = 0;
+
+		// Per node.
+		TArray<int64> NodeVisits;
+		TArray<int64> NodeDeadEnds;
+
+		// Per row slot (option rows only).
+		TArray<int64> OptionAvailable;
+		TArray<int64> OptionTaken;
+
+		/** Per outcome key: final value -> runs. */
+		TArray<TMap<int32, int64>> Outcomes;
+
+		void Init(const FSGCompiledDialogue& Dialogue, int32 NumOutcomeKeys)
+		{
+			if (NodeVisits.Num() == 0)
+			{
+				NodeVisits.SetNumZeroed(Dialogue.NumNodes());
+				NodeDeadEnds.SetNumZeroed(Dialogue.NumNodes());
+				OptionAvailable.SetNumZeroed(Dialogue.NumRows());
+				OptionTaken.SetNumZeroed(Dialogue.NumRows());
+				Outcomes.SetNum(NumOutcomeKeys);
+			}
+		}
+
+		void Merge(const FSimStats& Other)
+		{
+			if (Other.NodeVisits.Num() == 0)
+			{
+				return;
+			}
+
+			Runs += Other.Runs;
+			Steps += Other.Steps;
+			Ended += Other.Ended;
+			DeadEnds += Other.DeadEnds;
+			StepLimits += Other.StepLimits;
+			TruncatedStarts += Other.TruncatedStarts;
+			MergedBranches += Other.MergedBranches;
+
+			for (int32 Idx = 0; Idx < NodeVisits.Num(); ++Idx)
+			{
+				NodeVisits[Idx] += Other.NodeVisits[Idx];
+				NodeDeadEnds[Idx] += Other.NodeDeadEnds[Idx];
+			}
+			for (int32 Idx = 0; Idx < OptionAvailable.Num(); ++Idx)
+			{
+				OptionAvailable[Idx] += Other.OptionAvailable[Idx];
+				OptionTaken[Idx] += Other.OptionTaken[Idx];
+			}
+			for (int32 Idx = 0; Idx < Outcomes.Num(); ++Idx)
+			{
+				for (const TPair<int32, int64>& Pair : Other.Outcomes[Idx])
+				{
+					Outcomes[Idx].FindOrAdd(Pair.Key) += Pair.Value;
+				}
+			}
+		}
+	};
+
+	/** Per-thread state for ParallelForWithTaskContext. */
+	struct FSimContext
+	{
+		FSimStats Stats;
+
+		/** Available options of the current decision. */
+		TArray<int32> Options;
+	};
+
+	/** Walks the compiled graph. Const and lock-free, so any number of workers share one. */
+	class FSimulator
+	{
+	public:
+		FSimulator(const FSGCompiledDialogue& InDialogue, const TArray<FName>& InOutcomeKeys, int32 InMaxSteps)
+			: Dialogue(InDialogue)
+			, OutcomeKeys(InOutcomeKeys)
+			, MaxSteps(InMaxSteps)
+		{
+		}
+
+		/** One playthrough from Start, picking uniformly among available options. */
+		void RunRandom(int32 Start, FRandomStream& Rng, FSimContext& Context) const
+		{
+			FSGStoryState State;
+			int32 Node = Start;
+			for (int32 Steps = 0; ; ++Steps)
+			{
+				if (Node == INDEX_NONE)
+				{
+					FinishRun(ESGRunEnd::Ended, Node, Steps, State, Context.Stats);
+					return;
+				}
+				if (Steps >= MaxSteps)
+				{
+					FinishRun(ESGRunEnd::StepLimit, Node, Steps, State, Context.Stats);
+					return;
+				}
+				if (!EnterNode(Node, State, Context))
+				{
+					Node = Dialogue.GetNextNode(Dialogue.GetNodePrimarySlot(Node));
+					continue;
+				}
+				if (Context.Options.Num() == 0)
+				{
+					FinishRun(ESGRunEnd::DeadEnd, Node, Steps, State, Context.Stats);
+					return;
+				}
+
+				const int32 Slot = Context.Options[Rng.RandHelper(Context.Options.Num())];
+				++Context.Stats.OptionTaken[Slot];
+				Dialogue.ApplyEffects(Slot, State);
+				Node = Dialogue.GetNextNode(Slot);
+			}
+		}
+
+		/**
+		 * Every option combination from Start, depth first in table order, up to MaxPaths finished paths.
+		 * With bDedupe, a branch that reaches a (node, state) pair already walked from this start is
+		 * dropped: everything after it would repeat. Keyed by FSGStoryState::GetContentHash and
+		 * confirmed with Equals, so distinct states are never merged.
+		 */
+		void RunExhaustive(int32 Start, int32 MaxPaths, bool bDedupe, FSimContext& Context) const
+		{
+			struct FBranch
+			{
+				int32 Node = INDEX_NONE;
+				int32 Steps = 0;
+
+				/** Branches copy the state at each decision; chunks are shared until written. */
+				FSGStoryState State;
+			};
+
+			TArray<FBranch> Stack;
+			Stack.Add(FBranch{ Start, 0, FSGStoryState() });
+
+			// Walked (node, state hash) -> state. Copies share chunks with the branches, so this is cheap.
+			TMap<TPair<int32, uint64>, FSGStoryState> Walked;
+
+			const int64 FirstRun = Context.Stats.Runs;
+			while (Stack.Num() > 0)
+			{
+				if (Context.Stats.Runs - FirstRun >= MaxPaths)
+				{
+					++Context.Stats.TruncatedStarts;
+					return;
+				}
+
+				FBranch Branch = Stack.Pop(EAllowShrinking::No);
+				for (;; ++Branch.Steps)
+				{
+					if (Branch.Node == INDEX_NONE)
+					{
+						FinishRun(ESGRunEnd::Ended, Branch.Node, Branch.Steps, Branch.State, Context.Stats);
+						break;
+					}
+					if (Branch.Steps >= MaxSteps)
+					{
+						FinishRun(ESGRunEnd::StepLimit, Branch.Node, Branch.Steps, Branch.State, Context.Stats);
+						break;
+					}
+					if (!EnterNode(Branch.Node, Branch.State, Context))
+					{
+						Branch.Node = Dialogue.GetNextNode(Dialogue.GetNodePrimarySlot(Branch.Node));
+						continue;
+					}
+					if (Context.Options.Num() == 0)
+					{
+						FinishRun(ESGRunEnd::DeadEnd, Branch.Node, Branch.Steps, Branch.State, Context.Stats);
+						break;
+					}
+
+					// Pushed in reverse so the first option is walked first.
+					for (int32 Idx = Context.Options.Num() - 1; Idx >= 0; --Idx)
+					{
+						const int32 Slot = Context.Options[Idx];
+						++Context.Stats.OptionTaken[Slot];
+
+						FBranch& Child = Stack.Add_GetRef(FBranch{ Dialogue.GetNextNode(Slot), Branch.Steps + 1, Branch.State });
+						Dialogue.ApplyEffects(Slot, Child.State);
+
+						if (bDedupe && Child.Node != INDEX_NONE)
+						{
+							const TPair<int32, uint64> Key(Child.Node, Child.State.GetContentHash());
+							if (const FSGStoryState* Seen = Walked.Find(Key))
+							{
+								if (Seen->Equals(Child.State))
+								{
+									// Steps differ at most, so only -MaxSteps cut-offs can come out differently.
+									++Context.Stats.MergedBranches;
+									Stack.Pop(EAllowShrinking::No);
+								}
+							}
+							else
+							{
+								Walked.Add(Key, Child.State);
+							}
+						}
+					}
+					break;
+				}
+			}
+		}
+
+	private:
+		const FSGCompiledDialogue& Dialogue;
+		const TArray<FName>& OutcomeKeys;
+		const int32 MaxSteps;
+
+		/** Count the visit and apply the primary row. True for a decision, with its available options in Context.Options. */
+		bool EnterNode(int32 Node, FSGStoryState& State, FSimContext& Context) const
+		{
+			++Context.Stats.NodeVisits[Node];
+
+			const int32 Primary = Dialogue.GetNodePrimarySlot(Node);
+			Dialogue.ApplyEffects(Primary, State);
+
+			const TConstArrayView<int32> OptionSlots = Dialogue.GetNodeOptionSlots(Node);
+			if (OptionSlots.Num() == 0 && Dialogue.GetRowType(Primary) != ESGDialogueRowType::Decision)
+			{
+				return false;
+			}
+
+			// Same availability rule as USGDialogueSubsystem::GetDecisionOptions.
+			Context.Options.Reset();
+			for (const int32 Slot : OptionSlots)
+			{
+				if (Dialogue.EvalConditions(Slot, State) && Dialogue.EvalChecks(Slot, State))
+				{
+					++Context.Stats.OptionAvailable[Slot];
+					Context.Options.Add(Slot);
+				}
+			}
+			return true;
+		}
+
+		void FinishRun(ESGRunEnd End, int32 Node, int32 Steps, const FSGStoryState& State, FSimStats& Stats) const
+		{
+			++Stats.Runs;
+			Stats.Steps += Steps;
+
+			switch (End)
+			{
+			case ESGRunEnd::Ended:
+				++Stats.Ended;
+				break;
+			case ESGRunEnd::DeadEnd:
+				++Stats.DeadEnds;
+				++Stats.NodeDeadEnds[Node];
+				break;
+			case ESGRunEnd::StepLimit:
+				++Stats.StepLimits;
+				break;
+			}
+
+			for (int32 Idx = 0; Idx < OutcomeKeys.Num(); ++Idx)
+			{
+				++Stats.Outcomes[Idx].FindOrAdd(State.GetInt(OutcomeKeys[Idx]));
+			}
+		}
+	};
+
+	/** -Db, else the project database, else the dialogue DataTable (same precedence as the subsystem). */
+	bool BuildDialogue(const FString& Params, FSGCompiledDialogue& Out)
+	{
+		TSharedPtr<const FSGNarrativeDatabase> Database;
+
+		FString DbPath;
+		if (FParse::Value(*Params, TEXT("Db="), DbPath))
+		{
+			if (FPaths::IsRelative(DbPath))
+			{
+				DbPath = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectDir(), DbPath));
+			}
+
+			Database = FSGNarrativeDatabase::Mount(DbPath);
+			if (!Database.IsValid())
+			{
+				UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeSimulate: %s does not mount."), *DbPath);
+				return false;
+			}
+		}
+		else
+		{
+			Database = FSGNarrativeDatabase::GetProjectDatabase();
+		}
+
+		if (Database.IsValid() && Out.BuildFromDatabase(*Database))
+		{
+			return true;
+		}
+
+		if (UDataTable* Table = GetDefault<USGNarrativeSettings>()->DialogueDecisionTable.LoadSynchronous())
+		{
+			static const FString Context = TEXT("USGNarrativeSimulateCommandlet::Dialogue");
+			TArray<FSGDialogueDecisionRow*> SourceRows;
+			Table->GetAllRows(Context, SourceRows);
+
+			Out.Build(SourceRows);
+			return true;
+		}
+		return false;
+	}
+
+	/** -Start ids, else every node that no `next` points to, else node 0. */
+	void FindStartNodes(const FString& Params, const FSGCompiledDialogue& Dialogue, TArray<int32>& Out)
+	{
+		FString StartList;
+		if (FParse::Value(*Params, TEXT("Start="), StartList, false))
+		{
+			TArray<FString> Ids;
+			StartList.ParseIntoArray(Ids, TEXT(","));
+			for (const FString& Id : Ids)
+			{
+				const int32 Node = Dialogue.FindNode(FName(*Id.TrimStartAndEnd()));
+				if (Node == INDEX_NONE)
+				{
+					UE_LOG(LogSGNarrative, Warning, TEXT("SGNarrativeSimulate: unknown start node '%s'."), *Id);
+					continue;
+				}
+				Out.Add(Node);
+			}
+			return;
+		}
+
+		TBitArray<> Targeted(false, Dialogue.NumNodes());
+		for (int32 Slot = 0; Slot < Dialogue.NumRows(); ++Slot)
+		{
+			const int32 Next = Dialogue.GetNextNode(Slot);
+			if (Next != INDEX_NONE)
+			{
+				Targeted[Next] = true;
+			}
+		}
+
+		for (int32 Node = 0; Node < Dialogue.NumNodes(); ++Node)
+		{
+			if (!Targeted[Node])
+			{
+				Out.Add(Node);
+			}
+		}
+		if (Out.Num() == 0 && Dialogue.NumNodes() > 0)
+		{
+			Out.Add(0);
+		}
+	}
+
+	void Report(const FSGCompiledDialogue& Dialogue, const TArray<FName>& OutcomeKeys, const FSimStats& Stats)
+	{
+		// 1) Node coverage.
+		int32 Visited = 0;
+		for (int32 Node = 0; Node < Dialogue.NumNodes(); ++Node)
+		{
+			if (Stats.NodeVisits[Node] > 0)
+			{
+				++Visited;
+			}
+			else
+			{
+				UE_LOG(LogSGNarrative, Display, TEXT("  never visited: %s"), *Dialogue.GetNodeId(Node).ToString());
+			}
+		}
+		UE_LOG(LogSGNarrative, Display, TEXT("  node coverage: %d / %d (%.1f%%)"),
+			Visited, Dialogue.NumNodes(), Dialogue.NumNodes() > 0 ? 100.0 * Visited / Dialogue.NumNodes() : 0.0);
+
+		// 2) Options whose conditions/checks never passed in a visited decision.
+		int32 NumOptions = 0;
+		int32 Unreachable = 0;
+		for (int32 Slot = 0; Slot < Dialogue.NumRows(); ++Slot)
+		{
+			if (Dialogue.GetRowType(Slot) != ESGDialogueRowType::DecisionOption)
+			{
+				continue;
+			}
+
+			++NumOptions;
+			if (Stats.OptionAvailable[Slot] == 0)
+			{
+				++Unreachable;
+				const FSGDialogueRowData& Row = Dialogue.GetRow(Slot);
+				UE_LOG(LogSGNarrative, Display, TEXT("  unreachable option: %s/%s"), *Row.id.ToString(), *Row.option_key.ToString());
+			}
+		}
+		UE_LOG(LogSGNarrative, Display, TEXT("  unreachable options: %d / %d"), Unreachable, NumOptions);
+
+		// 3) Decisions that ran out of options.
+		for (int32 Node = 0; Node < Dialogue.NumNodes(); ++Node)
+		{
+			if (Stats.NodeDeadEnds[Node] > 0)
+			{
+				UE_LOG(LogSGNarrative, Display, TEXT("  dead end: %s (%lld runs)"), *Dialogue.GetNodeId(Node).ToString(), Stats.NodeDeadEnds[Node]);
+			}
+		}
+
+		// 4) Final rep_* / trust_* values.
+		for (int32 Idx = 0; Idx < OutcomeKeys.Num(); ++Idx)
+		{
+			TArray<TPair<int32, int64>> Values = Stats.Outcomes[Idx].Array();
+			if (Values.Num() == 0)
+			{
+				continue;
+			}
+			Values.Sort([](const TPair<int32, int64>& A, const TPair<int32, int64>& B) { return A.Key < B.Key; });
+
+			double Sum = 0.0;
+			for (const TPair<int32, int64>& Pair : Values)
+			{
+				Sum += (double)Pair.Key * Pair.Value;
+			}
+			UE_LOG(LogSGNarrative, Display, TEXT("  %s: min %d, max %d, mean %.3f"),
+				*OutcomeKeys[Idx].ToString(), Values[0].Key, Values.Last().Key, Sum / Stats.Runs);
+
+			for (const TPair<int32, int64>& Pair : Values)
+			{
+				UE_LOG(LogSGNarrative, Display, TEXT("    %d: %lld (%.2f%%)"), Pair.Key, Pair.Value, 100.0 * Pair.Value / Stats.Runs);
+			}
+		}
+	}
+}
+
+USGNarrativeSimulateCommandlet::USGNarrativeSimulateCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USGNarrativeSimulateCommandlet::Main(const FString& Params)
+{
+	int32 Runs = 1000000;
+	int32 Seed = 0;
+	int32 MaxSteps = 512;
+	int32 MaxPaths = 1000000;
+	FParse::Value(*Params, TEXT("Runs="), Runs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MaxSteps="), MaxSteps);
+	FParse::Value(*Params, TEXT("MaxPaths="), MaxPaths);
+	const bool bExhaustive = FParse::Param(*Params, TEXT("Exhaustive"));
+	const bool bDedupe = FParse::Param(*Params, TEXT("Dedupe"));
+
+	// 1) Compile the graph once; workers share it read-only (the predicate cache is game-thread only).
+	FSGCompiledDialogue Dialogue;
+	if (!BuildDialogue(Params, Dialogue) || Dialogue.NumNodes() == 0)
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeSimulate: no dialogue rows (pass -Db= or set DialogueDecisionTable)."));
+		return 1;
+	}
+
+	TArray<int32> Starts;
+	FindStartNodes(Params, Dialogue, Starts);
+	if (Starts.Num() == 0)
+	{
+		UE_LOG(LogSGNarrative, Error, TEXT("SGNarrativeSimulate: no start nodes."));
+		return 1;
+	}
+
+	// 2) Outcome keys: every registered rep_* / trust_* int (the build registered all granted keys).
+	TArray<FName> OutcomeKeys;
+	const FSGStateKeyRegistry& Registry = FSGStateKeyRegistry::Get();
+	for (int32 Slot = 0; Slot < Registry.NumInts(); ++Slot)
+	{
+		const FName Key = Registry.GetIntName(Slot);
+		const FString KeyStr = Key.ToString();
+		if (KeyStr.StartsWith(TEXT("rep_")) || KeyStr.StartsWith(TEXT("trust_")))
+		{
+			OutcomeKeys.Add(Key);
+		}
+	}
+
+	// 3) Run. Stats are per task context and merged afterwards; runs never share mutable state.
+	const FSimulator Simulator(Dialogue, OutcomeKeys, FMath::Max(MaxSteps, 1));
+	TArray<FSimContext> Contexts;
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (bExhaustive)
+	{
+		ParallelForWithTaskContext(Contexts, Starts.Num(), [&](FSimContext& Context, int32 Index)
+		{
+			Context.Stats.Init(Dialogue, OutcomeKeys.Num());
+			Simulator.RunExhaustive(Starts[Index], FMath::Max(MaxPaths, 1), bDedupe, Context);
+		});
+	}
+	else
+	{
+		Runs = FMath::Max(Runs, 1);
+		ParallelForWithTaskContext(Contexts, FMath::DivideAndRoundUp(Runs, RunsPerBatch), [&](FSimContext& Context, int32 Batch)
+		{
+			Context.Stats.Init(Dialogue, OutcomeKeys.Num());
+
+			const int32 End = FMath::Min((Batch + 1) * RunsPerBatch, Runs);
+			for (int32 Run = Batch * RunsPerBatch; Run < End; ++Run)
+			{
+				// Seeded by run index, not by thread, so the report only depends on -Seed.
+				FRandomStream Rng((int32)HashCombine(GetTypeHash(Seed), GetTypeHash(Run)));
+				Simulator.RunRandom(Starts[Run % Starts.Num()], Rng, Context);
+			}
+		});
+	}
+	const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_DOUBLE_SMALL_NUMBER);
+
+	FSimStats Total;
+	Total.Init(Dialogue, OutcomeKeys.Num());
+	for (const FSimContext& Context : Contexts)
+	{
+		Total.Merge(Context.Stats);
+	}
+
+	// 4) Report.
+	UE_LOG(LogSGNarrative, Display, TEXT("SGNarrativeSimulate: %lld %s runs from %d start nodes (seed %d) in %.3fs: %.0f runs/s, %.0f steps/s."),
+		Total.Runs, bExhaustive ? TEXT("exhaustive") : TEXT("random"), Starts.Num(), Seed, Seconds, Total.Runs / Seconds, Total.Steps / Seconds);
+	UE_LOG(LogSGNarrative, Display, TEXT("  ended %lld, dead ends %lld, step limit %lld, truncated starts %lld, merged branches %lld"),
+		Total.Ended, Total.DeadEnds, Total.StepLimits, Total.TruncatedStarts, Total.MergedBranches);
+
+	if (Total.Runs > 0)
+	{
+		Report(Dialogue, OutcomeKeys, Total);
+	}
+	return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGNarrativeCookCommandlet.generated.h"
+
+/**
+ * Cooks every narrative source (DataTables from USGNarrativeSettings plus the quest details and
+ * decision point JSON) into one binary database for FSGNarrativeDatabase.
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeCook [-Out=<path>]
+ *
+ * Without -Out the file goes to USGNarrativeSettings::NarrativeDatabaseFile.
+ */
+UCLASS()
+class USGNarrativeCookCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGNarrativeCookCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGNarrativeGenerateCommandlet.generated.h"
+
+/**
+ * Writes a synthetic narrative dataset at a multiple of the shipped content, for scale testing.
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeGenerate [-Scale=50] [-Seed=0] [-Out=<dir>]
+ *
+ * Every source the runtime reads (dialogue/decision, main quest lines, optional prompts, decision
+ * points, shotlist, quest details JSON) is resampled by whole groups: a quest's conversation graph,
+ * a beat, a decision point, a scene, a quest. Groups are drawn at random (seeded) until each output
+ * has Scale times the source rows, and each copy gets its own ids and local flags, so branching
+ * factors, condition/check density and grant shapes match real content while keys stay unique.
+ * rep_* / trust_* / xp grants and flags a group only reads are left shared, as in the real data.
+ *
+ * Output is DataTable CSVs (importable with the shipped row structs) plus a quest details JSON,
+ * written to -Out (default Saved/SGNarrativeSynthetic). Point USGNarrativeSettings at them, or cook
+ * them, to measure any feature against future-sized content.
+ */
+UCLASS()
+class USGNarrativeGenerateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGNarrativeGenerateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGNarrativeKeysCommandlet.generated.h"
+
+/**
+ * Generates SGKeys.h: a constexpr id for every story flag and int key the narrative data uses,
+ * plus the name tables FSGStateKeyRegistry reserves their slots from at startup.
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeKeys [-Out=<path>] [-Check]
+ *
+ * Keys come from the same places the registry learns them: the dialogue table's conditions,
+ * checks, set_flags and grants (through FSGCompiledDialogue's compiler), the SG.Flag.* gameplay
+ * tags and USGNarrativeSettings::StateKeysFile. Names are sorted, so the output only changes when
+ * the set of keys does. Native code then writes State.HasFlag(SGKeys::ga_briefed): no FName
+ * hashing, and a misspelled or removed key is a compile error.
+ *
+ * The file is only rewritten when its contents change. -Check writes nothing and returns 1 if
+ * the header is out of date (for CI after narrative data edits).
+ */
+UCLASS()
+class USGNarrativeKeysCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGNarrativeKeysCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGNarrativeSearchCommandlet.generated.h"
+
+/**
+ * Searches every narrative table from the command line, through the same FSGNarrativeTextIndex
+ * as USGNarrativeSearchSubsystem.
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeSearch -Query="words or text" [-Substring] [-Max=50]
+ *
+ * Word queries match lines containing every word; -Substring matches the text anywhere in a line.
+ * Logs index build time, query time and the hits.
+ */
+UCLASS()
+class USGNarrativeSearchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGNarrativeSearchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
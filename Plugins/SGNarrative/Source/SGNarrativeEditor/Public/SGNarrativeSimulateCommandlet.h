@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGNarrativeSimulateCommandlet.generated.h"
+
+/**
+ * Plays the dialogue/decision graph many times on all worker threads and reports what the
+ * content does: node coverage, options that never become available, dead ends, the spread of
+ * final rep_* / trust_* values and runs per second (so it doubles as a throughput benchmark).
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=SGNarrativeSimulate [-Runs=N] [-Seed=N] [-MaxSteps=N]
+ *     [-Start=Id1,Id2] [-Exhaustive] [-Dedupe] [-MaxPaths=N] [-Db=<path>]
+ *
+ * Each run starts from an empty FSGStoryState at a start node (default: every node no `next` points
+ * to, taken in turn) and follows USGDialogueSubsystem semantics through FSGCompiledDialogue: a node's
+ * primary row applies its effects, a decision picks one option whose conditions and checks pass,
+ * and `next` leads on. Random runs are seeded per run index, so a given -Seed always gives the same
+ * report whatever the thread count. -Exhaustive instead walks every option combination from each
+ * start node, up to -MaxPaths finished paths per start; add -Dedupe to stop walking a branch
+ * once it reaches a node with a story state already seen there, so reconverging branches are walked once.
+ *
+ * Rows come from -Db, else the project database, else USGNarrativeSettings::DialogueDecisionTable.
+ */
+UCLASS()
+class USGNarrativeSimulateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGNarrativeSimulateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,19 @@
+using UnrealBuildTool;
+
+public class SGNarrativeEditor : ModuleRules
+{
+	public SGNarrativeEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"SGNarrative"
+			}
+		);
+	}
+}